@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "arena.h"
+
+#if PICO_ON_DEVICE
+// not zeroed by the runtime; arena_alloc zeroes what it hands out
+static uint8_t __uninitialized_ram(arena_memory)[ARENA_SIZE] __attribute__((aligned(8)));
+#else
+static uint8_t arena_memory[ARENA_SIZE] __attribute__((aligned(8)));
+#endif
+
+static size_t arena_top;
+static size_t arena_subsystem_used[ARENA_SUBSYSTEMS];
+static bool arena_sealed;
+static uint arena_late;
+
+static const char *const arena_subsystem_names[ARENA_SUBSYSTEMS] = {
+        "audio",
+        "dsp",
+        "ui",
+};
+
+void *arena_alloc(arena_subsystem_t who, size_t size) {
+    assert(who < ARENA_SUBSYSTEMS);
+    if (arena_sealed) {
+        arena_late++;
+#if ARENA_TRAP_LATE
+        panic("arena: %u bytes for %s after init\n", (uint) size, arena_subsystem_names[who]);
+#endif
+    }
+    size = (size + 7u) & ~7u;
+    if (size > ARENA_SIZE - arena_top) {
+        arena_report();
+        panic("arena: out of memory, %u bytes for %s\n", (uint) size, arena_subsystem_names[who]);
+    }
+    void *p = arena_memory + arena_top;
+    arena_top += size;
+    arena_subsystem_used[who] += size;
+    memset(p, 0, size);
+    return p;
+}
+
+void arena_pool_init(arena_pool_t *pool, arena_subsystem_t who, size_t block_size, uint count) {
+    // room for the free list link
+    block_size = block_size < sizeof(void *) ? sizeof(void *) : block_size;
+    uint8_t *blocks = (uint8_t *) arena_alloc(who, block_size * count);
+    pool->free_list = NULL;
+    pool->block_size = block_size;
+    pool->count = count;
+    pool->available = 0;
+    for (uint i = count; i--;) {
+        arena_pool_give(pool, blocks + i * block_size);
+    }
+}
+
+void *arena_pool_take(arena_pool_t *pool) {
+    void *block = pool->free_list;
+    if (block) {
+        pool->free_list = *(void **) block;
+        pool->available--;
+    }
+    return block;
+}
+
+void arena_pool_give(arena_pool_t *pool, void *block) {
+    assert(block);
+    assert(pool->available < pool->count);
+    *(void **) block = pool->free_list;
+    pool->free_list = block;
+    pool->available++;
+}
+
+void arena_seal(void) {
+    arena_sealed = true;
+}
+
+size_t arena_used(arena_subsystem_t who) {
+    return arena_subsystem_used[who];
+}
+
+void arena_report(void) {
+    printf("arena: %u of %u bytes\n", (uint) arena_top, (uint) ARENA_SIZE);
+    for (uint i = 0; i < ARENA_SUBSYSTEMS; i++) {
+        printf("  %-6s %7u\n", arena_subsystem_names[i], (uint) arena_subsystem_used[i]);
+    }
+    if (arena_late) printf("  %u allocations after init\n", arena_late);
+}
@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico.h"
+
+/** \file arena.h
+ *  \defgroup grib_arena grib_arena
+ *  Static memory for everything allocated at startup
+ *
+ * One statically sized region (placed by the linker in uninitialized RAM on the device)
+ * replaces malloc/calloc for audio buffers and pools, DSP state and UI frames. The
+ * memory budget is then fixed at link time, and the region cannot fragment.
+ *
+ * - arena_alloc is a bump allocator for objects that live forever. Memory is zeroed and
+ *   8 byte aligned, and is accounted to a subsystem for the startup report.
+ * - arena_pool hands out fixed size blocks for objects that come and go at runtime
+ *   (e.g. a patch's delay lines). The blocks are carved from the arena when the pool is
+ *   created.
+ * - arena_seal marks the end of init. Later arena_alloc calls are counted, and they
+ *   panic if ARENA_TRAP_LATE is set. Pool take/give stays allowed.
+ *
+ * Allocation is meant for single-threaded startup and is not locked.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bytes reserved for the arena
+#ifndef ARENA_SIZE
+#define ARENA_SIZE (184u * 1024u)
+#endif
+
+// Panic on arena_alloc after arena_seal instead of only counting it
+#ifndef ARENA_TRAP_LATE
+#define ARENA_TRAP_LATE 0
+#endif
+
+typedef enum arena_subsystem {
+    ARENA_AUDIO = 0, ///< Audio buffers and pools
+    ARENA_DSP,       ///< Cell state, delay lines
+    ARENA_UI,        ///< Display frames
+    ARENA_SUBSYSTEMS
+} arena_subsystem_t;
+
+/** \brief Fixed size block pool carved from the arena
+ * \ingroup grib_arena
+ */
+typedef struct arena_pool {
+    void *free_list;
+    size_t block_size;
+    uint count;      ///< Blocks in the pool
+    uint available;  ///< Blocks not taken
+} arena_pool_t;
+
+/** \brief Allocate zeroed, 8 byte aligned memory for the lifetime of the program
+ * \ingroup grib_arena
+ *
+ * Panics when the arena is exhausted; the report then shows who used what.
+ */
+void *arena_alloc(arena_subsystem_t who, size_t size);
+
+#define ARENA_NEW(who, type) ((type *) arena_alloc(who, sizeof(type)))
+#define ARENA_NEW_ARRAY(who, type, count) ((type *) arena_alloc(who, (count) * sizeof(type)))
+
+/** \brief Carve count blocks of block_size bytes from the arena
+ * \ingroup grib_arena
+ */
+void arena_pool_init(arena_pool_t *pool, arena_subsystem_t who, size_t block_size, uint count);
+
+/** \brief Take a block (contents undefined), NULL if all blocks are taken
+ * \ingroup grib_arena
+ */
+void *arena_pool_take(arena_pool_t *pool);
+
+/** \brief Return a block taken from pool
+ * \ingroup grib_arena
+ */
+void arena_pool_give(arena_pool_t *pool, void *block);
+
+/** \brief End of init; arena_alloc from now on is a late allocation
+ * \ingroup grib_arena
+ */
+void arena_seal(void);
+
+/** \brief Bytes allocated for a subsystem
+ * \ingroup grib_arena
+ */
+size_t arena_used(arena_subsystem_t who);
+
+/** \brief Print bytes used per subsystem, the total against ARENA_SIZE and late allocations
+ * \ingroup grib_arena
+ */
+void arena_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_ARENA_H
@@ -9,6 +9,7 @@
 #include <cstring>
 #include "pico/audio.h"
 #include "pico/sample_conversion.h"
+#include "arena.h"
 
 // ======================
 // == DEBUGGING =========
@@ -141,24 +142,31 @@ static audio_connection_t connection_default = {
         .consumer_pool_give = consumer_pool_give_buffer_default,
 };
 
+// all buffers live in the arena (arena.h); pools are created once at startup
+mem_buffer_t *audio_new_mem_buffer(size_t size) {
+    mem_buffer_t *buffer = ARENA_NEW(ARENA_AUDIO, mem_buffer_t);
+    buffer->bytes = (uint8_t *) arena_alloc(ARENA_AUDIO, size);
+    buffer->size = size;
+    return buffer;
+}
+
 audio_buffer_t *audio_new_buffer(audio_buffer_format_t *format, int buffer_sample_count) {
-    audio_buffer_t *buffer = (audio_buffer_t *) calloc(1, sizeof(audio_buffer_t));
+    audio_buffer_t *buffer = ARENA_NEW(ARENA_AUDIO, audio_buffer_t);
     audio_init_buffer(buffer, format, buffer_sample_count);
     return buffer;
 }
 
 void audio_init_buffer(audio_buffer_t *audio_buffer, audio_buffer_format_t *format, int buffer_sample_count) {
     audio_buffer->format = format;
-    audio_buffer->buffer = pico_buffer_alloc(buffer_sample_count * format->sample_stride);
+    audio_buffer->buffer = audio_new_mem_buffer(buffer_sample_count * format->sample_stride);
     audio_buffer->max_sample_count = buffer_sample_count;
     audio_buffer->sample_count = 0;
 }
 
 audio_buffer_pool_t *
 audio_new_buffer_pool(audio_buffer_format_t *format, int buffer_count, int buffer_sample_count) {
-    audio_buffer_pool_t *ac = (audio_buffer_pool_t *) calloc(1, sizeof(audio_buffer_pool_t));
-    audio_buffer_t *audio_buffers = buffer_count ? (audio_buffer_t *) calloc(buffer_count,
-                                                                                       sizeof(audio_buffer_t)) : 0;
+    audio_buffer_pool_t *ac = ARENA_NEW(ARENA_AUDIO, audio_buffer_pool_t);
+    audio_buffer_t *audio_buffers = buffer_count ? ARENA_NEW_ARRAY(ARENA_AUDIO, audio_buffer_t, buffer_count) : 0;
     ac->format = format->format;
     for (int i = 0; i < buffer_count; i++) {
         audio_init_buffer(audio_buffers + i, format, buffer_sample_count);
@@ -174,15 +182,51 @@ audio_new_buffer_pool(audio_buffer_format_t *format, int buffer_count, int buffe
     return ac;
 }
 
+static audio_buffer_t *effect_producer_pool_take(audio_connection_t *connection, bool block) {
+    audio_connection_t *inner = ((audio_effect_t *) connection)->inner;
+    return inner->producer_pool_take(inner, block);
+}
+
+static void effect_producer_pool_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    audio_connection_t *inner = ((audio_effect_t *) connection)->inner;
+    inner->producer_pool_give(inner, buffer);
+}
+
+static audio_buffer_t *effect_consumer_pool_take(audio_connection_t *connection, bool block) {
+    audio_effect_t *effect = (audio_effect_t *) connection;
+    audio_buffer_t *buffer = effect->inner->consumer_pool_take(effect->inner, block);
+    if (buffer && buffer->sample_count) effect->process(effect, buffer);
+    return buffer;
+}
+
+static void effect_consumer_pool_give(audio_connection_t *connection, audio_buffer_t *buffer) {
+    audio_connection_t *inner = ((audio_effect_t *) connection)->inner;
+    inner->consumer_pool_give(inner, buffer);
+}
+
+void audio_insert_effect(audio_buffer_pool_t *pool, audio_effect_t *effect) {
+    audio_connection_t *inner = pool->connection;
+    assert(inner && inner->producer_pool && inner->consumer_pool);
+    assert(effect->process);
+    effect->inner = inner;
+    effect->core.producer_pool_take = effect_producer_pool_take;
+    effect->core.producer_pool_give = effect_producer_pool_give;
+    effect->core.consumer_pool_take = effect_consumer_pool_take;
+    effect->core.consumer_pool_give = effect_consumer_pool_give;
+    effect->core.producer_pool = inner->producer_pool;
+    effect->core.consumer_pool = inner->consumer_pool;
+    // the inner connection keeps its pool pointers; only the pools see the effect
+    inner->producer_pool->connection = &effect->core;
+    inner->consumer_pool->connection = &effect->core;
+}
+
 audio_buffer_t *audio_new_wrapping_buffer(audio_buffer_format_t *format, mem_buffer_t *buffer) {
-    audio_buffer_t *audio_buffer = (audio_buffer_t *) calloc(1, sizeof(audio_buffer_t));
-    if (audio_buffer) {
-        audio_buffer->format = format;
-        audio_buffer->buffer = buffer;
-        audio_buffer->max_sample_count = buffer->size / format->sample_stride;
-        audio_buffer->sample_count = 0;
-        audio_buffer->next = 0;
-    }
+    audio_buffer_t *audio_buffer = ARENA_NEW(ARENA_AUDIO, audio_buffer_t);
+    audio_buffer->format = format;
+    audio_buffer->buffer = buffer;
+    audio_buffer->max_sample_count = buffer->size / format->sample_stride;
+    audio_buffer->sample_count = 0;
+    audio_buffer->next = 0;
     return audio_buffer;
 
 }
@@ -261,4 +305,51 @@ void stereo_s16_to_stereo_s16_producer_give(audio_connection_t *connection, audi
 
 void stereo_s32_to_stereo_s32_producer_give(audio_connection_t *connection, audio_buffer_t *buffer) {
     return producer_pool_blocking_give<Stereo<FmtS32>, Stereo<FmtS32>>(connection, buffer);
-}
\ No newline at end of file
+}
+// ======================
+// == FLOAT CONVERSION ==
+
+#if PICO_NO_HARDWARE
+// on the device these are in audio_utils.S
+void audio_f32_to_s32(const float *input, int32_t *output, uint count) {
+    for (uint i = 0; i < count; i++) {
+        output[i] = audio_f32_to_q31_sample(input[i]);
+    }
+}
+
+void audio_f32_to_s32_stereo(const float *input, int32_t *output, uint frame_count) {
+    // convert a chunk, then duplicate it; both loops vectorize, the fused one does not
+    while (frame_count) {
+        int32_t chunk[64];
+        uint n = std::min(frame_count, 64u);
+        for (uint i = 0; i < n; i++) {
+            chunk[i] = audio_f32_to_q31_sample(input[i]);
+        }
+        for (uint i = 0; i < n; i++) {
+            output[i * 2 + 0] = chunk[i];
+            output[i * 2 + 1] = chunk[i];
+        }
+        input += n;
+        output += n * 2;
+        frame_count -= n;
+    }
+}
+#endif
+
+void audio_f32_to_s16(const float *input, int16_t *output, uint count) {
+    for (uint i = 0; i < count; i++) {
+        output[i] = audio_f32_to_s16_sample(input[i]);
+    }
+}
+
+void audio_f32_to_s16_dither(const float *input, int16_t *output, uint count, uint32_t *seed) {
+    uint32_t r = *seed;
+    for (uint i = 0; i < count; i++) {
+        // difference of two uniform values in [0, 1) LSB is triangular in (-1, 1) LSB
+        uint32_t a = r = r * 1664525u + 1013904223u;
+        uint32_t b = r = r * 1664525u + 1013904223u;
+        float tpdf = ((int32_t) (a >> 8) - (int32_t) (b >> 8)) * (1.0f / (16777216.0f * 32768.0f));
+        output[i] = audio_f32_to_s16_sample(input[i] + tpdf);
+    }
+    *seed = r;
+}
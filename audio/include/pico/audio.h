@@ -143,6 +143,11 @@ audio_buffer_pool_t *audio_new_consumer_pool(audio_buffer_format_t *format, int
  */
 audio_buffer_t *audio_new_wrapping_buffer(audio_buffer_format_t *format, mem_buffer_t *buffer);
 
+/*! \brief Allocate a zeroed mem_buffer_t of size bytes from the arena (in place of pico_buffer_alloc)
+ *  \ingroup pico_audio
+ */
+mem_buffer_t *audio_new_mem_buffer(size_t size);
+
 /*! \brief Allocate and initialise an new audio buffer
  *  \ingroup pico_audio
  *
@@ -207,6 +212,35 @@ void audio_upsample_words(int16_t *input, int16_t *output_aligned, uint output_w
  */
 void audio_upsample_double(int16_t *input, int16_t *output, uint output_count, uint32_t step);
 
+/*! \brief Convert float samples to S32 (Q31), saturating at full scale
+ *  \ingroup pico_audio
+ *
+ * [-1, 1) maps to the full S32 range; values outside, including infinities, saturate
+ */
+void audio_f32_to_s32(const float *input, int32_t *output, uint count);
+
+/*! \brief Convert mono float samples to interleaved S32 stereo, saturating
+ *  \ingroup pico_audio
+ *
+ * Writes 2 * frame_count samples, each input sample to both channels
+ */
+void audio_f32_to_s32_stereo(const float *input, int32_t *output, uint frame_count);
+
+/*! \brief Convert float samples to S16, saturating, rounded to nearest
+ *  \ingroup pico_audio
+ */
+void audio_f32_to_s16(const float *input, int16_t *output, uint count);
+
+/*! \brief Convert float samples to S16 with TPDF dither
+ *  \ingroup pico_audio
+ *
+ * Adds triangular noise of +-1 LSB before rounding, which decorrelates the
+ * quantization error from the signal at the cost of a slightly higher noise floor.
+ *
+ * \param seed Dither generator state, carried between calls (any value to start)
+ */
+void audio_f32_to_s16_dither(const float *input, int16_t *output, uint count, uint32_t *seed);
+
 /*! \brief \todo
  *  \ingroup pico_audio
  */
@@ -255,6 +289,35 @@ void producer_pool_give_buffer_default(audio_connection_t *connection, audio_buf
  */
 audio_buffer_t *producer_pool_take_buffer_default(audio_connection_t *connection, bool block);
 
+/*! \brief In-place processing stage (limiter, DC blocker, master EQ...) inside a connection
+ *  \ingroup pico_audio
+ *
+ * An effect wraps the connection it is inserted into: takes and gives are forwarded,
+ * and each buffer the consumer takes is passed to process first, in the consumer's
+ * format. Nothing is copied and no pool is added, so master bus processing is done once
+ * per buffer, on the core (and in the context, e.g. the DMA IRQ) that takes from the
+ * consumer pool. Effects run in the order they were inserted.
+ */
+typedef struct audio_effect audio_effect_t;
+
+struct audio_effect {
+    audio_connection_t core;
+    audio_connection_t *inner;
+    void (*process)(audio_effect_t *effect, audio_buffer_t *buffer);
+    void *user_data;
+};
+
+/*! \brief Insert an effect after the connection (and any effects) already serving a pool
+ *  \ingroup pico_audio
+ *
+ * Call after the connection is complete (e.g. audio_i2s_connect) and before the consumer
+ * starts taking buffers; effect must stay valid while the connection is in use.
+ *
+ * \param pool Producer or consumer pool of the connection
+ * \param effect Effect with process (and user_data) set; the rest is filled in
+ */
+void audio_insert_effect(audio_buffer_pool_t *pool, audio_effect_t *effect);
+
 enum audio_correction_mode {
     none,
     fixed_dither,
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _PICO_RESAMPLER_H
+#define _PICO_RESAMPLER_H
+
+#include "pico/audio.h"
+
+/** \file resampler.h
+ *  \defgroup pico_audio_resampler pico_audio_resampler
+ *  Streaming S16 mono sample rate conversion with a fixed point ratio
+ *
+ * Lets the DSP render at a lower internal rate and convert to the DAC rate (or
+ * the other way round). Input arrives in blocks of up to max_block samples; the
+ * fractional read position is carried between blocks, so any block size works and
+ * the output count per call varies by one around input_count * out_rate / in_rate.
+ *
+ * - AUDIO_RESAMPLER_SINC: polyphase windowed sinc (Blackman, AUDIO_RESAMPLER_TAPS taps,
+ *   AUDIO_RESAMPLER_PHASES phases, linear between phases), Q14 coefficients and 32 bit
+ *   accumulation. The cutoff follows the lower of the two rates, so it anti-aliases when
+ *   downsampling and removes images when upsampling.
+ * - AUDIO_RESAMPLER_LINEAR: linear interpolation. When upsampling on the device with a
+ *   step that is a multiple of 1/4096 and the block starts on a whole input sample
+ *   (e.g. 22050 -> 44100 Hz) it runs on audio_upsample (interpolator 0 of the calling
+ *   core), otherwise in C.
+ *
+ * Both qualities share one time base, with a delay of AUDIO_RESAMPLER_TAPS / 2 input
+ * samples. audio_resample_reference evaluates the same kernel in double precision,
+ * without tables, to check the fixed point version on the host.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef AUDIO_RESAMPLER_TAPS
+#define AUDIO_RESAMPLER_TAPS 16
+#endif
+
+#ifndef AUDIO_RESAMPLER_PHASES
+#define AUDIO_RESAMPLER_PHASES 64
+#endif
+
+typedef enum audio_resampler_quality {
+    AUDIO_RESAMPLER_LINEAR = 0,
+    AUDIO_RESAMPLER_SINC,
+} audio_resampler_quality_t;
+
+typedef struct audio_resampler {
+    audio_resampler_quality_t quality;
+    uint32_t step;     ///< Input samples per output sample, 16.16
+    uint32_t pos;      ///< Next output position in scratch, 16.16
+    float cutoff;      ///< Fraction of the input Nyquist frequency
+    uint max_block;
+    int16_t *scratch;  ///< AUDIO_RESAMPLER_TAPS samples of history, then the current block
+    int16_t *coeffs;   ///< (AUDIO_RESAMPLER_PHASES + 1) * AUDIO_RESAMPLER_TAPS, Q14; sinc only
+} audio_resampler_t;
+
+/*! \brief Set up a resampler; scratch and coefficient tables come from the arena
+ *  \ingroup pico_audio_resampler
+ *
+ * \param in_rate Input rate in Hz
+ * \param out_rate Output rate in Hz
+ * \param max_block Largest input_count passed to audio_resample (at most 4096 - AUDIO_RESAMPLER_TAPS for the asm path)
+ * \param quality AUDIO_RESAMPLER_LINEAR or AUDIO_RESAMPLER_SINC
+ */
+void audio_resampler_init(audio_resampler_t *r, uint32_t in_rate, uint32_t out_rate, uint max_block,
+                          audio_resampler_quality_t quality);
+
+/*! \brief Forget the history and restart the time base
+ *  \ingroup pico_audio_resampler
+ */
+void audio_resampler_reset(audio_resampler_t *r);
+
+/*! \brief Most output samples one call with input_count samples can produce
+ *  \ingroup pico_audio_resampler
+ */
+uint audio_resampler_max_output(const audio_resampler_t *r, uint input_count);
+
+/*! \brief Convert one block
+ *  \ingroup pico_audio_resampler
+ *
+ * \param input input_count samples, input_count <= max_block
+ * \param output Room for audio_resampler_max_output(r, input_count) samples
+ * \return Output samples written
+ */
+uint audio_resample(audio_resampler_t *r, const int16_t *input, uint input_count, int16_t *output);
+
+/*! \brief Double precision reference for AUDIO_RESAMPLER_SINC, for host checks
+ *  \ingroup pico_audio_resampler
+ *
+ * Resamples a whole signal in one go with r's step and cutoff, evaluating the kernel
+ * directly. The output lines up sample for sample with feeding the same signal through
+ * audio_resample from a fresh r.
+ *
+ * \return Output samples written (at most output_max)
+ */
+uint audio_resample_reference(const audio_resampler_t *r, const int16_t *input, uint input_count, float *output,
+                              uint output_max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_PICO_RESAMPLER_H
@@ -10,6 +10,7 @@
 #define SOFTWARE_SAMPLE_CONVERSION_H
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include "pico/audio.h"
 #include "pico/util/buffer.h"
@@ -40,6 +41,14 @@ typedef struct : public FmtDetails<uint32_t> {
 typedef struct : public FmtDetails<int32_t> {
 } FmtS32;
 
+// float, full scale is [-1, 1)
+typedef struct : public FmtDetails<float> {
+} FmtF32;
+
+// signed 1.31 fixed point; same bits as FmtS32, full scale is [-1, 1)
+typedef struct : public FmtDetails<int32_t> {
+} FmtQ31;
+
 // Multi channel is just N samples back to back
 template<typename Fmt, uint ChannelCount>
 struct MultiChannelFmt {
@@ -68,7 +77,92 @@ struct sample_converter<Fmt, Fmt> {
     }
 };
 
+// float -> Q31, saturating; NaN saturates too. Branch free, so that host compilers
+// vectorize loops over it; the device uses the assembler versions in audio_utils.S
+static inline int32_t audio_f32_to_q31_sample(float sample) {
+    sample *= 2147483648.0f;
+    int32_t lo = !(sample > -2147483648.0f);
+    int32_t hi = sample >= 2147483648.0f;
+    float in_range = (lo | hi) ? 0.0f : sample;
+    return (int32_t) in_range | (-hi & INT32_MAX) | (-lo & INT32_MIN);
+}
+
+// float -> S16, saturating, rounded to nearest (half up)
+static inline int16_t audio_f32_to_s16_sample(float sample) {
+    int32_t q = audio_f32_to_q31_sample(sample);
+    int32_t r = (q >> 16) + ((q >> 15) & 1);
+    return (int16_t) (r - (r == 32768));
+}
+
+// converters to S32 / Q31
+
+template<>
+struct sample_converter<FmtS32, FmtS16> {
+    static int32_t convert_sample(const int16_t &sample) {
+        return (int32_t) sample << 16u;
+    }
+};
+
+template<>
+struct sample_converter<FmtS32, FmtF32> {
+    static int32_t convert_sample(const float &sample) {
+        return audio_f32_to_q31_sample(sample);
+    }
+};
+
+template<>
+struct sample_converter<FmtQ31, FmtF32> {
+    static int32_t convert_sample(const float &sample) {
+        return audio_f32_to_q31_sample(sample);
+    }
+};
+
+template<>
+struct sample_converter<FmtS32, FmtQ31> {
+    static int32_t convert_sample(const int32_t &sample) {
+        return sample;
+    }
+};
+
+template<>
+struct sample_converter<FmtQ31, FmtS32> {
+    static int32_t convert_sample(const int32_t &sample) {
+        return sample;
+    }
+};
+
+// converters to F32
+
+template<>
+struct sample_converter<FmtF32, FmtS16> {
+    static float convert_sample(const int16_t &sample) {
+        return sample * (1.0f / 32768.0f);
+    }
+};
+
+template<>
+struct sample_converter<FmtF32, FmtS32> {
+    static float convert_sample(const int32_t &sample) {
+        return sample * (1.0f / 2147483648.0f);
+    }
+};
+
+template<>
+struct sample_converter<FmtF32, FmtQ31> {
+    static float convert_sample(const int32_t &sample) {
+        return sample * (1.0f / 2147483648.0f);
+    }
+};
+
 // converters to S16
+
+template<>
+struct sample_converter<FmtS16, FmtF32> {
+    static int16_t convert_sample(const float &sample) {
+        return audio_f32_to_s16_sample(sample);
+    }
+};
+
 template<>
 struct sample_converter<FmtS16, FmtU16> {
     static int16_t convert_sample(const uint16_t &sample) {
@@ -199,6 +293,24 @@ struct converting_copy<Stereo<ToFmt>, Mono<FromFmt>> {
     }
 };
 
+// float -> S32 blocks go through audio_f32_to_s32 / audio_f32_to_s32_stereo, which are
+// assembler on the device (no FPU, so the bits are shifted directly) and plain loops
+// the compiler vectorizes on the host
+
+template<uint NumChannels>
+struct converting_copy<MultiChannelFmt<FmtS32, NumChannels>, MultiChannelFmt<FmtF32, NumChannels>> {
+    static void copy(int32_t *dest, const float *src, uint sample_count) {
+        audio_f32_to_s32(src, dest, sample_count * NumChannels);
+    }
+};
+
+template<>
+struct converting_copy<Stereo<FmtS32>, Mono<FmtF32>> {
+    static void copy(int32_t *dest, const float *src, uint sample_count) {
+        audio_f32_to_s32_stereo(src, dest, sample_count);
+    }
+};
+
 // stereo->mono conversion
 template<typename ToFmt, typename FromFmt>
 struct converting_copy<Mono<ToFmt>, Stereo<FromFmt>> {
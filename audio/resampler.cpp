@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cmath>
+#include <cstring>
+#include "pico/resampler.h"
+#include "arena.h"
+
+#define TAPS AUDIO_RESAMPLER_TAPS
+#define HALF (AUDIO_RESAMPLER_TAPS / 2)
+#define PHASES AUDIO_RESAMPLER_PHASES
+#define PHASE_BITS __builtin_ctz(AUDIO_RESAMPLER_PHASES)
+#define FRAC_BITS (16 - PHASE_BITS)
+
+static_assert((AUDIO_RESAMPLER_PHASES & (AUDIO_RESAMPLER_PHASES - 1)) == 0, "phases must be a power of two");
+
+// windowed sinc at distance d input samples from the output position
+static double resampler_kernel(double d, double cutoff) {
+    if (std::fabs(d) >= HALF) return 0.0;
+    double w = 0.42 + 0.5 * std::cos(M_PI * d / HALF) + 0.08 * std::cos(2.0 * M_PI * d / HALF);
+    double x = cutoff * d;
+    double s = x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+    return cutoff * s * w;
+}
+
+// tap k reads input sample floor(t) - (HALF - 1) + k for an output at t = floor(t) + f
+static void resampler_phase(double f, double cutoff, double *h) {
+    double sum = 0.0;
+    for (int k = 0; k < TAPS; k++) {
+        h[k] = resampler_kernel(k - (HALF - 1) - f, cutoff);
+        sum += h[k];
+    }
+    // unity gain at DC for every phase
+    for (int k = 0; k < TAPS; k++) h[k] /= sum;
+}
+
+void audio_resampler_init(audio_resampler_t *r, uint32_t in_rate, uint32_t out_rate, uint max_block,
+                          audio_resampler_quality_t quality) {
+    r->quality = quality;
+    r->step = (uint32_t) (((uint64_t) in_rate << 16) / out_rate);
+    // a little below the lower Nyquist frequency, as the short kernel has a wide transition
+    r->cutoff = 0.9f * (out_rate < in_rate ? (float) out_rate / (float) in_rate : 1.0f);
+    r->max_block = max_block;
+    r->scratch = ARENA_NEW_ARRAY(ARENA_AUDIO, int16_t, TAPS + max_block);
+    r->coeffs = NULL;
+    if (quality == AUDIO_RESAMPLER_SINC) {
+        r->coeffs = ARENA_NEW_ARRAY(ARENA_AUDIO, int16_t, (PHASES + 1) * TAPS);
+        for (int p = 0; p <= PHASES; p++) {
+            double h[TAPS];
+            resampler_phase((double) p / PHASES, r->cutoff, h);
+            for (int k = 0; k < TAPS; k++) {
+                r->coeffs[p * TAPS + k] = (int16_t) std::lrint(h[k] * 16384.0);
+            }
+        }
+    }
+    audio_resampler_reset(r);
+}
+
+void audio_resampler_reset(audio_resampler_t *r) {
+    memset(r->scratch, 0, TAPS * sizeof(int16_t));
+    r->pos = (HALF - 1) << 16;
+}
+
+uint audio_resampler_max_output(const audio_resampler_t *r, uint input_count) {
+    return (uint) (((uint64_t) (input_count + 1) << 16) / r->step) + 1;
+}
+
+static inline int16_t resampler_clamp(int32_t v) {
+    return (int16_t) (v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+}
+
+static uint resample_sinc(audio_resampler_t *r, uint32_t limit, int16_t *output) {
+    uint n = 0;
+    uint32_t pos = r->pos;
+    while (pos < limit) {
+        const int16_t *x = r->scratch + (pos >> 16) - (HALF - 1);
+        uint32_t frac = pos & 0xffffu;
+        const int16_t *h0 = r->coeffs + (frac >> FRAC_BITS) * TAPS;
+        const int16_t *h1 = h0 + TAPS;
+        int32_t a0 = 0, a1 = 0;
+        for (int k = 0; k < TAPS; k++) {
+            a0 += x[k] * h0[k];
+            a1 += x[k] * h1[k];
+        }
+        // between the two phases; both sums are Q14 and well inside 31 bits
+        int32_t w = (int32_t) (frac & ((1u << FRAC_BITS) - 1));
+        int32_t a = a0 + (int32_t) (((int64_t) (a1 - a0) * w) >> FRAC_BITS);
+        output[n++] = resampler_clamp((a + (1 << 13)) >> 14);
+        pos += r->step;
+    }
+    r->pos = pos;
+    return n;
+}
+
+static uint resample_linear(audio_resampler_t *r, uint32_t limit, int16_t *output) {
+    uint n = 0;
+    uint32_t pos = r->pos;
+#if !PICO_NO_HARDWARE
+    // interpolator fast path: it restarts at a whole sample and steps in 1/4096ths
+    if (r->step < 0x10000u && !(r->step & 0xfu) && !(pos & 0xffffu) && pos < limit) {
+        n = (limit - pos + r->step - 1) / r->step;
+        audio_upsample(r->scratch + (pos >> 16), output, n, r->step >> 4);
+        r->pos = pos + n * r->step;
+        return n;
+    }
+#endif
+    while (pos < limit) {
+        const int16_t *x = r->scratch + (pos >> 16);
+        int32_t f = (int32_t) ((pos & 0xffffu) >> 2);
+        output[n++] = (int16_t) (x[0] + (((x[1] - x[0]) * f) >> 14));
+        pos += r->step;
+    }
+    r->pos = pos;
+    return n;
+}
+
+uint audio_resample(audio_resampler_t *r, const int16_t *input, uint input_count, int16_t *output) {
+    assert(input_count <= r->max_block);
+    memcpy(r->scratch + TAPS, input, input_count * sizeof(int16_t));
+    // every output needs HALF samples after its position
+    uint32_t limit = (uint32_t) (HALF + input_count) << 16;
+    uint n = r->quality == AUDIO_RESAMPLER_SINC ? resample_sinc(r, limit, output) : resample_linear(r, limit, output);
+    // keep the last TAPS samples as history and move the time base with them
+    memmove(r->scratch, r->scratch + input_count, TAPS * sizeof(int16_t));
+    r->pos -= input_count << 16;
+    return n;
+}
+
+uint audio_resample_reference(const audio_resampler_t *r, const int16_t *input, uint input_count, float *output,
+                              uint output_max) {
+    double step = r->step / 65536.0;
+    uint n = 0;
+    // same time base as audio_resample: output 0 sits HALF + 1 samples before input 0
+    for (double t = (HALF - 1) - (double) TAPS; n < output_max && t + HALF < input_count; t += step) {
+        double base = std::floor(t);
+        double h[TAPS];
+        resampler_phase(t - base, r->cutoff, h);
+        double acc = 0.0;
+        for (int k = 0; k < TAPS; k++) {
+            int i = (int) base - (HALF - 1) + k;
+            if (i >= 0 && i < (int) input_count) acc += input[i] * h[k];
+        }
+        output[n++] = (float) acc;
+    }
+    return n;
+}
@@ -14,12 +14,14 @@
 #include "hardware/gpio.h"
 #include "hardware/dma.h"
 #include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "hardware/clocks.h"
 #include "hardware/structs/dma.h"
 #include "hardware/regs/dreq.h"
 
 #include "audio_i2s.pio.h"
 #include "pico/audio_i2s.h"
+#include "trace.h"
 
 //#define CORE1_PROCESS_I2S_CALLBACK  // Multi-Core Processing Mode (Experimentally Single-Core seems better)
 //#define WATCH_DMA_TRANSFER_INTERVAL // Activate only for analysis because of watch overhead
@@ -47,8 +49,18 @@ struct {
     uint32_t freq;
     uint8_t pio_sm;
     uint8_t dma_channel;
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    uint8_t dma_channels[2];              // dma_channel and its partner, each chained to the other
+    audio_buffer_t *queued_buffer[2];     // buffer loaded into each channel (NULL for silence)
+#endif
 } shared_state;
 
+static audio_i2s_stats_t stats = { .min_headroom_us = UINT32_MAX };
+
+// stats and underrun are written by the DMA IRQ on core 0 and read from either core;
+// disabling interrupts only masks the calling core, the hardware spin lock covers both
+static spin_lock_t *audio_lock;
+
 audio_format_t pio_i2s_consumer_format;
 audio_buffer_format_t pio_i2s_consumer_buffer_format = {
         .format = &pio_i2s_consumer_format,
@@ -56,6 +68,15 @@ audio_buffer_format_t pio_i2s_consumer_buffer_format = {
 
 static audio_buffer_pool_t *audio_i2s_consumer;
 static audio_buffer_t silence_buffer;
+static audio_buffer_t underrun_buffer;    // fill built from the last real buffer before a gap
+
+// the decisions are in audio_i2s_underrun.c
+static audio_i2s_underrun_state_t underrun = {
+        .policy = AUDIO_I2S_UNDERRUN_SILENCE,
+        .fade = PICO_AUDIO_I2S_UNDERRUN_FADE_SAMPLES,
+        .fill = &underrun_buffer,
+        .silence = &silence_buffer,
+};
 
 static void __isr __time_critical_func(audio_i2s_dma_irq_handler)();
 
@@ -125,8 +146,7 @@ void i2s_callback_loop()
 //void audio_i2s_end(const audio_i2s_config_t *config) {
 void audio_i2s_end() {
     audio_buffer_t *ab = shared_state.playing_buffer;
-    queue_free_audio_buffer(audio_i2s_consumer, ab);
-    free(silence_buffer.buffer);
+    if (ab) queue_free_audio_buffer(audio_i2s_consumer, ab);
     shared_state.playing_buffer = NULL;
     uint8_t sm = shared_state.pio_sm;
     pio_sm_drain_tx_fifo(audio_pio, sm);
@@ -137,6 +157,16 @@ void audio_i2s_end() {
     dma_channel_unclaim(dma_channel);
     irq_remove_handler(DMA_IRQ_x, audio_i2s_dma_irq_handler);
     dma_channel_set_irqx_enabled(dma_channel, 0);
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    for (uint i = 0; i < 2; i++) {
+        if (shared_state.queued_buffer[i]) {
+            queue_free_audio_buffer(audio_i2s_consumer, shared_state.queued_buffer[i]);
+            shared_state.queued_buffer[i] = NULL;
+        }
+    }
+    dma_channel_unclaim(shared_state.dma_channels[1]);
+    dma_channel_set_irqx_enabled(shared_state.dma_channels[1], 0);
+#endif
 }
 
 const audio_format_t *audio_i2s_setup(const audio_format_t *i2s_input_audio_format, const audio_format_t *i2s_output_audio_format,
@@ -158,9 +188,17 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *i2s_input_audio_form
     uint res_bits = (_i2s_output_audio_format->pcm_format == AUDIO_PCM_FORMAT_S32) ? 32 : 16;
     audio_i2s_program_init(audio_pio, sm, loaded_offset, config->data_pin, config->clock_pin_base, res_bits);
 
-    silence_buffer.buffer = pico_buffer_alloc(PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH * 4);
+    if (!audio_lock) audio_lock = spin_lock_init(spin_lock_claim_unused(true));
+
+    // arena memory, kept for a later setup
+    if (!silence_buffer.buffer) {
+        silence_buffer.buffer = audio_new_mem_buffer(PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH * 8); // S32 stereo
+        underrun_buffer.buffer = audio_new_mem_buffer(PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH * 8);
+    }
     silence_buffer.sample_count = PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH;
     silence_buffer.format = &pio_i2s_consumer_buffer_format;
+    underrun_buffer.max_sample_count = PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH;
+    underrun_buffer.format = &pio_i2s_consumer_buffer_format;
 
     __mem_fence_release();
     uint8_t dma_channel = config->dma_channel;
@@ -216,6 +254,22 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *i2s_input_audio_form
 
     }
     channel_config_set_transfer_data_size(&dma_config, i2s_dma_configure_size);
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    uint8_t dma_channel_b = (uint8_t) dma_claim_unused_channel(true);
+    shared_state.dma_channels[0] = dma_channel;
+    shared_state.dma_channels[1] = dma_channel_b;
+    dma_channel_config dma_config_b = dma_config;
+    channel_config_set_chain_to(&dma_config_b, dma_channel);
+    dma_channel_configure(dma_channel_b,
+                          &dma_config_b,
+                          &audio_pio->txf[sm],  // dest
+                          NULL, // src
+                          0, // count
+                          false // trigger
+    );
+    channel_config_set_chain_to(&dma_config, dma_channel_b);
+    dma_channel_set_irqx_enabled(dma_channel_b, 1);
+#endif
     dma_channel_configure(dma_channel,
                           &dma_config,
                           &audio_pio->txf[sm],  // dest
@@ -230,7 +284,10 @@ const audio_format_t *audio_i2s_setup(const audio_format_t *i2s_input_audio_form
 }
 
 static void update_pio_frequency(uint32_t sample_freq, audio_pcm_format_t pcm_format, audio_channel_t channel_count) {
+    // called from the DMA IRQ on rate changes, so only print in debug builds
+#ifndef NDEBUG
     printf("setting PIO freq for target sampling freq = %d Hz\n", (int) sample_freq);
+#endif
     uint32_t system_clock_frequency = clock_get_hz(clk_sys);
     assert(system_clock_frequency < 0x40000000);
     //uint32_t divider = system_clock_frequency * 4 / sample_freq; // avoid arithmetic overflow
@@ -264,11 +321,20 @@ static void update_pio_frequency(uint32_t sample_freq, audio_pcm_format_t pcm_fo
     printf("System clock at %u Hz, I2S clock divider %d/256: PIO freq %7.4f Hz\n", (uint) system_clock_frequency, (uint) divider, pio_freq);
     pio_sm_set_clkdiv_int_frac(audio_pio, shared_state.pio_sm, divider >> 8u, divider & 0xffu); // This scheme includes clock Jitter
 #else
-    divider >>= 8u;
-    float pio_freq = (float) system_clock_frequency / divider; // no frac
-    float samp_freq = pio_freq / ((float) bits * 2.0 * 2.0);
-    printf("System clock at %u Hz, I2S clock divider %d: PIO freq %7.4f Hz: sampling freq %7.4f Hz\n", (uint) system_clock_frequency, (uint) divider, pio_freq, samp_freq);
-    pio_sm_set_clkdiv(audio_pio, shared_state.pio_sm, divider); // No Jitter. but clock freq accuracy depends on PIO source clock freq
+    if ((divider & 0xffu) * 200u < divider) { // integer divider is within 0.5% of the target rate
+        divider >>= 8u;
+#ifndef NDEBUG
+        float pio_freq = (float) system_clock_frequency / divider; // no frac
+        float samp_freq = pio_freq / ((float) bits * 2.0 * 2.0);
+        printf("System clock at %u Hz, I2S clock divider %d: PIO freq %7.4f Hz: sampling freq %7.4f Hz\n", (uint) system_clock_frequency, (uint) divider, pio_freq, samp_freq);
+#endif
+        pio_sm_set_clkdiv(audio_pio, shared_state.pio_sm, divider); // No Jitter. but clock freq accuracy depends on PIO source clock freq
+    } else { // e.g. 48 kHz and 96 kHz at clk_sys 96 MHz
+#ifndef NDEBUG
+        printf("System clock at %u Hz, I2S clock divider %d/256\n", (uint) system_clock_frequency, (uint) divider);
+#endif
+        pio_sm_set_clkdiv_int_frac(audio_pio, shared_state.pio_sm, divider >> 8u, divider & 0xffu); // This scheme includes clock Jitter
+    }
 #endif
 
     shared_state.freq = sample_freq;
@@ -520,7 +586,93 @@ bool audio_i2s_connect_s8(audio_buffer_pool_t *producer) {
     return true;
 }
 
-static inline void audio_start_dma_transfer() {
+// number of DMA_SIZE_32/16 transfers for a buffer
+static inline uint audio_dma_transfer_count(const audio_buffer_t *ab) {
+    if (ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S32 && ab->format->format->channel_count == AUDIO_CHANNEL_STEREO) {
+        return ab->sample_count*2; // DMA_SIZE_32 * 2 times;
+    }
+    return ab->sample_count;
+}
+
+// words still queued for the PIO when the IRQ runs, as time left before a gap
+static inline void audio_record_headroom(uint words) {
+    uint words_per_frame = (_i2s_output_audio_format->pcm_format == AUDIO_PCM_FORMAT_S32) ? 2 : 1;
+    uint32_t us = (uint32_t) ((uint64_t) words * 1000000u / (words_per_frame * shared_state.freq));
+    if (us < stats.min_headroom_us) stats.min_headroom_us = us;
+}
+
+void audio_i2s_get_stats(audio_i2s_stats_t *s) {
+    uint32_t save = spin_lock_blocking(audio_lock);
+    *s = stats;
+    spin_unlock(audio_lock, save);
+}
+
+// take the next real buffer, or NULL if the producer is late (or a miss was injected)
+static inline audio_buffer_t *audio_take_dma_buffer() {
+    if (audio_i2s_underrun_skip(&underrun)) return NULL;
+    audio_buffer_t *ab = take_audio_buffer(audio_i2s_consumer, false);
+    if (ab) audio_i2s_underrun_recover(&underrun, ab, time_us_32());
+    return ab;
+}
+
+// what to play instead; last is the real buffer playing (or just played) before the
+// gap, NULL if there is none
+static audio_buffer_t *audio_underrun_fill(const audio_buffer_t *last) {
+    if (!underrun.active) TRACE_INSTANT("underrun");
+    return audio_i2s_underrun_fill(&underrun, last, time_us_32(), &stats);
+}
+
+void audio_i2s_set_underrun_policy(audio_i2s_underrun_policy_t policy, uint fade_samples) {
+    uint32_t save = spin_lock_blocking(audio_lock);
+    underrun.policy = policy;
+    underrun.fade = fade_samples;
+    spin_unlock(audio_lock, save);
+}
+
+uint audio_i2s_get_underruns(audio_i2s_underrun_t *log, uint max) {
+    uint32_t save = spin_lock_blocking(audio_lock);
+    uint32_t logged = underrun.logged;
+    uint count = MIN(MIN(logged, PICO_AUDIO_I2S_UNDERRUN_LOG_LENGTH), max);
+    for (uint i = 0; i < count; i++) {
+        log[i] = underrun.log[(logged - count + i) % PICO_AUDIO_I2S_UNDERRUN_LOG_LENGTH];
+    }
+    spin_unlock(audio_lock, save);
+    return count;
+}
+
+void audio_i2s_inject_underruns(uint count) {
+    uint32_t save = spin_lock_blocking(audio_lock);
+    underrun.inject = count;
+    spin_unlock(audio_lock, save);
+}
+
+#if PICO_AUDIO_I2S_CHAINED_DMA
+// point each channel's chain trigger at its partner, or at itself to break the loop
+static void audio_chain_dma(bool chained) {
+    for (uint i = 0; i < 2; i++) {
+        uint to = shared_state.dma_channels[chained ? i ^ 1 : i];
+        hw_write_masked(&dma_hw->ch[shared_state.dma_channels[i]].al1_ctrl,
+                        to << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB, DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+    }
+}
+
+// load the next buffer into one channel of the pair; unless start is set, the
+// partner's chain trigger starts it as soon as the partner's buffer is done
+static inline void audio_queue_dma_transfer(uint i, bool start) {
+    audio_buffer_t *ab = audio_take_dma_buffer();
+    shared_state.queued_buffer[i] = ab;
+    if (!ab) {
+        // the partner is what plays right before the gap
+        ab = audio_underrun_fill(shared_state.queued_buffer[i ^ 1]);
+    }
+    assert(ab->sample_count);
+    dma_channel_set_read_addr(shared_state.dma_channels[i], ab->buffer->bytes, false);
+    dma_channel_set_trans_count(shared_state.dma_channels[i], audio_dma_transfer_count(ab), start);
+}
+#endif
+
+// last is the buffer that just finished, still owned so an underrun fill can be built from it
+static inline void audio_start_dma_transfer(const audio_buffer_t *last) {
     assert(!shared_state.playing_buffer);
 
     #ifdef WATCH_DMA_TRANSFER_INTERVAL
@@ -541,7 +693,7 @@ static inline void audio_start_dma_transfer() {
     }
     #endif // WATCH_PIO_SM_TX_FIFO_LEVEL
 
-    audio_buffer_t *ab = take_audio_buffer(audio_i2s_consumer, false);
+    audio_buffer_t *ab = audio_take_dma_buffer();
 
     shared_state.playing_buffer = ab;
     if (!ab) {
@@ -549,8 +701,7 @@ static inline void audio_start_dma_transfer() {
         DEBUG_PINS_XOR(audio_timing, 2);
         DEBUG_PINS_XOR(audio_timing, 1);
         //DEBUG_PINS_XOR(audio_timing, 2);
-        // just play some silence
-        ab = &silence_buffer;
+        ab = audio_underrun_fill(last);
     }
     assert(ab->sample_count);
     // todo better naming of format->format->format!!
@@ -562,38 +713,75 @@ static inline void audio_start_dma_transfer() {
         assert(ab->format->format->channel_count == AUDIO_CHANNEL_STEREO);
         //assert(ab->format->sample_stride == 4);
     }
-    if (ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S32 && ab->format->format->channel_count == AUDIO_CHANNEL_STEREO) {
-        dma_channel_transfer_from_buffer_now(shared_state.dma_channel, ab->buffer->bytes, ab->sample_count*2); // DMA_SIZE_32 * 2 times;
-    } else {
-        dma_channel_transfer_from_buffer_now(shared_state.dma_channel, ab->buffer->bytes, ab->sample_count);
-    }
+    dma_channel_transfer_from_buffer_now(shared_state.dma_channel, ab->buffer->bytes, audio_dma_transfer_count(ab));
+}
+
+static inline void audio_notify_callback() {
+#ifdef CORE1_PROCESS_I2S_CALLBACK
+    bool flg = multicore_fifo_push_timeout_us(EVENT_I2S_DMA_TRANSFER_STARTED, FIFO_TIMEOUT);
+    if (!flg) { printf("Core0 -> Core1 FIFO Full\n"); }
+#else
+    i2s_callback_func();
+#endif // CORE1_PROCESS_I2S_CALLBACK
 }
 
 // irq handler for DMA
 void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
 #if PICO_AUDIO_I2S_NOOP
     assert(false);
+#else
+#if PICO_AUDIO_I2S_CHAINED_DMA
+    for (uint i = 0; i < 2; i++) {
+        uint dma_channel = shared_state.dma_channels[i];
+        if (!(dma_intsx & (1u << dma_channel))) continue;
+        dma_intsx = 1u << dma_channel;
+        DEBUG_PINS_SET(audio_timing, 4);
+        TRACE_BEGIN("dma_irq");
+        uint32_t save = spin_lock_blocking(audio_lock);
+        stats.buffers++;
+        // the partner was started by the chain; we have until it drains to reload this one
+        audio_record_headroom(dma_hw->ch[shared_state.dma_channels[i ^ 1]].transfer_count);
+        bool late = dma_channel_is_busy(dma_channel);
+        if (late) {
+            // the partner drained and chained back into this channel before it was
+            // reloaded, so it is reading on past the end of its old buffer; never rewrite
+            // a running transfer: stop it, and restart it on the next buffer below
+            stats.late++;
+            dma_channel_abort(dma_channel);
+            // the abort can raise the channel's completion interrupt (RP2040-E13)
+            dma_intsx = 1u << dma_channel;
+        }
+        if (shared_state.queued_buffer[i]) {
+            give_audio_buffer(audio_i2s_consumer, shared_state.queued_buffer[i]);
+            shared_state.queued_buffer[i] = NULL;
+        }
+        audio_queue_dma_transfer(i, late);
+        spin_unlock(audio_lock, save);
+        DEBUG_PINS_CLR(audio_timing, 4);
+        TRACE_END("dma_irq");
+        audio_notify_callback();
+    }
 #else
     uint dma_channel = shared_state.dma_channel;
     if (dma_intsx & (1u << dma_channel)) {
         dma_intsx = 1u << dma_channel;
         DEBUG_PINS_SET(audio_timing, 4);
+        TRACE_BEGIN("dma_irq");
+        uint32_t save = spin_lock_blocking(audio_lock);
+        stats.buffers++;
+        // only the PIO FIFO is left to play until the restart below
+        audio_record_headroom(pio_sm_get_tx_fifo_level(audio_pio, shared_state.pio_sm));
+        audio_buffer_t *finished = shared_state.playing_buffer;
+        shared_state.playing_buffer = NULL;
+        audio_start_dma_transfer(finished);
+        spin_unlock(audio_lock, save);
         // free the buffer we just finished
-        if (shared_state.playing_buffer) {
-            give_audio_buffer(audio_i2s_consumer, shared_state.playing_buffer);
-#ifndef NDEBUG
-            shared_state.playing_buffer = NULL;
-#endif
-        }
-        audio_start_dma_transfer();
+        if (finished) give_audio_buffer(audio_i2s_consumer, finished);
         DEBUG_PINS_CLR(audio_timing, 4);
-#ifdef CORE1_PROCESS_I2S_CALLBACK
-        bool flg = multicore_fifo_push_timeout_us(EVENT_I2S_DMA_TRANSFER_STARTED, FIFO_TIMEOUT);
-        if (!flg) { printf("Core0 -> Core1 FIFO Full\n"); }
-        #else
-        i2s_callback_func();
-#endif // CORE1_PROCESS_I2S_CALLBACK
+        TRACE_END("dma_irq");
+        audio_notify_callback();
     }
+#endif // PICO_AUDIO_I2S_CHAINED_DMA
 #endif
 }
 
@@ -608,14 +796,37 @@ void audio_i2s_set_enabled(bool enabled) {
             printf("Disabling PIO I2S audio (on core %d)\n", get_core_num());
         }
 #endif
+#if PICO_AUDIO_I2S_CHAINED_DMA
+        if (enabled) { // Clear pending before enabled
+            dma_intsx = (1u << shared_state.dma_channels[0]) | (1u << shared_state.dma_channels[1]);
+        }
+        irq_set_enabled(DMA_IRQ_x, enabled);
+        if (enabled) {
+            // prime both channels, then start the first; the chain runs from here
+            audio_chain_dma(true);
+            uint32_t save = spin_lock_blocking(audio_lock);
+            audio_queue_dma_transfer(0, false);
+            audio_queue_dma_transfer(1, false);
+            spin_unlock(audio_lock, save);
+            dma_channel_start(shared_state.dma_channels[0]);
+        } else {
+            // unchain first so aborting one channel cannot trigger the other
+            audio_chain_dma(false);
+            dma_channel_abort(shared_state.dma_channels[0]);
+            dma_channel_abort(shared_state.dma_channels[1]);
+        }
+#else
         if (enabled) { // Clear pending before enabled
             uint dma_channel = shared_state.dma_channel;
             dma_intsx = 1u << dma_channel;
         }
         irq_set_enabled(DMA_IRQ_x, enabled);
         if (enabled) {
-            audio_start_dma_transfer();
+            uint32_t save = spin_lock_blocking(audio_lock);
+            audio_start_dma_transfer(NULL);
+            spin_unlock(audio_lock, save);
         }
+#endif // PICO_AUDIO_I2S_CHAINED_DMA
 #ifdef CORE1_PROCESS_I2S_CALLBACK
         bool flg;
         uint32_t msg;
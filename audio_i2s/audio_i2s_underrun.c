@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+// Underrun handling and fills of the I2S driver, apart from the hardware in audio_i2s.c
+// so the host test (test/underrun_test.c) runs the same code
+
+#include "pico/audio_i2s.h"
+
+static inline int32_t audio_sample_get(const audio_buffer_t *ab, uint i) {
+    if (ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S32) return ((const int32_t *) ab->buffer->bytes)[i];
+    return ((const int16_t *) ab->buffer->bytes)[i];
+}
+
+static inline void audio_sample_set(audio_buffer_t *ab, uint i, int32_t v) {
+    if (ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S32) ((int32_t *) ab->buffer->bytes)[i] = v;
+    else ((int16_t *) ab->buffer->bytes)[i] = (int16_t) v;
+}
+
+// a * w + b * (1 - w), w in Q15
+static inline int32_t audio_sample_mix(int32_t a, int32_t b, int32_t w) {
+    return (int32_t) (((int64_t) a * w + (int64_t) b * (32768 - w)) >> 15);
+}
+
+// The fill starts on last's final frame, running backwards (the mirror image), so there
+// is no step at the splice:
+//   REPEAT: crossfade from the mirror image into last's tail played forwards; the fill
+//           then ends on last's final frame again, which the late buffer continues from
+//   FADE:   the mirror image faded to zero, then silence
+void __time_critical_func(audio_i2s_underrun_build)(audio_buffer_t *fill, const audio_buffer_t *last,
+                                                    audio_i2s_underrun_policy_t policy, uint fade) {
+    uint ch = last->format->format->channel_count;
+    uint n = MIN(last->sample_count, fill->max_sample_count);
+    uint off = last->sample_count - n;
+    uint end = last->sample_count - 1;
+    fade = MIN(fade, n / 2);
+    fill->format = last->format;
+    for (uint k = 0; k < n; k++) {
+        int32_t w = k < fade ? (int32_t) (k * 32768u / fade) : 32768;
+        for (uint c = 0; c < ch; c++) {
+            int32_t mirror = audio_sample_get(last, (end - k) * ch + c);
+            int32_t v;
+            if (policy == AUDIO_I2S_UNDERRUN_REPEAT) {
+                v = audio_sample_mix(audio_sample_get(last, (off + k) * ch + c), mirror, w);
+            } else {
+                v = audio_sample_mix(mirror, 0, 32768 - w);
+            }
+            audio_sample_set(fill, k * ch + c, v);
+        }
+    }
+    fill->sample_count = n;
+}
+
+void __time_critical_func(audio_i2s_underrun_fade_in)(audio_buffer_t *ab, uint fade) {
+    uint ch = ab->format->format->channel_count;
+    fade = MIN(fade, ab->sample_count / 2);
+    for (uint k = 0; k < fade; k++) {
+        int32_t w = (int32_t) (k * 32768u / fade);
+        for (uint c = 0; c < ch; c++) {
+            audio_sample_set(ab, k * ch + c, audio_sample_mix(audio_sample_get(ab, k * ch + c), 0, w));
+        }
+    }
+}
+
+bool __time_critical_func(audio_i2s_underrun_skip)(audio_i2s_underrun_state_t *u) {
+    if (!u->inject) return false;
+    u->inject--;
+    return true;
+}
+
+void __time_critical_func(audio_i2s_underrun_recover)(audio_i2s_underrun_state_t *u, audio_buffer_t *ab,
+                                                      uint32_t now_us) {
+    if (!u->active) return;
+    // first real buffer after a gap
+    u->active = false;
+    u->current.duration_us = now_us - u->current.start_us;
+    u->log[u->logged++ % PICO_AUDIO_I2S_UNDERRUN_LOG_LENGTH] = u->current;
+    if (u->policy == AUDIO_I2S_UNDERRUN_FADE || (u->policy == AUDIO_I2S_UNDERRUN_REPEAT && !u->filled)) {
+        audio_i2s_underrun_fade_in(ab, u->fade);
+    }
+}
+
+audio_buffer_t *__time_critical_func(audio_i2s_underrun_fill)(audio_i2s_underrun_state_t *u,
+                                                              const audio_buffer_t *last, uint32_t now_us,
+                                                              audio_i2s_stats_t *stats) {
+    stats->silence++;
+    if (!u->active) {
+        u->active = true;
+        u->current.start_us = now_us;
+        u->current.buffers = 0;
+        stats->underruns++;
+        u->filled = false;
+        if (last && u->policy != AUDIO_I2S_UNDERRUN_SILENCE) {
+            audio_i2s_underrun_build(u->fill, last, u->policy, u->fade);
+            u->filled = true;
+        }
+    } else if (u->policy == AUDIO_I2S_UNDERRUN_FADE) {
+        // faded out already
+        u->filled = false;
+    }
+    u->current.buffers++;
+    return u->filled ? u->fill : u->silence;
+}
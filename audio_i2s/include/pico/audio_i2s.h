@@ -91,6 +91,22 @@ extern "C" {
 #endif
 #endif
 
+// Queue the next buffer on a second DMA channel chained to the first, so the IRQ only
+// has to refill within one buffer period instead of before the PIO FIFO drains
+#ifndef PICO_AUDIO_I2S_CHAINED_DMA
+#define PICO_AUDIO_I2S_CHAINED_DMA 0
+#endif
+
+// Number of underruns kept by audio_i2s_get_underruns (power of two)
+#ifndef PICO_AUDIO_I2S_UNDERRUN_LOG_LENGTH
+#define PICO_AUDIO_I2S_UNDERRUN_LOG_LENGTH 16u
+#endif
+
+// Default fade length in frames for the crossfade / fade underrun policies
+#ifndef PICO_AUDIO_I2S_UNDERRUN_FADE_SAMPLES
+#define PICO_AUDIO_I2S_UNDERRUN_FADE_SAMPLES 64u
+#endif
+
 #ifndef PICO_AUDIO_I2S_DATA_PIN
 //#warning PICO_AUDIO_I2S_DATA_PIN should be defined when using AUDIO_I2S
 #define PICO_AUDIO_I2S_DATA_PIN 18
@@ -181,6 +197,143 @@ bool audio_i2s_connect_extra(audio_buffer_pool_t *producer, bool buffer_on_give,
  */
 void audio_i2s_set_enabled(bool enabled);
 
+/** \brief DMA statistics
+ * \ingroup pico_audio_i2s
+ */
+typedef struct audio_i2s_stats {
+    uint32_t buffers;         ///< DMA transfers completed
+    uint32_t silence;         ///< Transfers that played silence or an underrun fill
+    uint32_t underruns;       ///< Gaps in the producer's output, however many transfers each lasted
+    uint32_t late;            ///< Chained mode: refills that came after the channel had restarted; it is stopped and restarted on the next buffer
+    uint32_t min_headroom_us; ///< Least output time left queued when the DMA IRQ ran
+} audio_i2s_stats_t;
+
+/** \brief Copy the DMA statistics
+ * \ingroup pico_audio_i2s
+ *
+ * Headroom is the PIO FIFO level in single channel mode and the rest of the playing
+ * buffer in chained mode, i.e. how much later the IRQ could have run without a gap.
+ *
+ * \param stats Receives the statistics
+ */
+void audio_i2s_get_stats(audio_i2s_stats_t *stats);
+
+/** \brief What to play when no buffer is ready for the DMA
+ * \ingroup pico_audio_i2s
+ */
+typedef enum audio_i2s_underrun_policy {
+    AUDIO_I2S_UNDERRUN_SILENCE = 0, ///< Play the silence buffer (hard cut in and out)
+    AUDIO_I2S_UNDERRUN_REPEAT,      ///< Replay the last buffer, crossfaded from its mirror image at the splice
+    AUDIO_I2S_UNDERRUN_FADE,        ///< Fade the last buffer out to silence, fade the first real buffer back in
+} audio_i2s_underrun_policy_t;
+
+/** \brief One underrun, from the first substituted transfer to the next real buffer
+ * \ingroup pico_audio_i2s
+ */
+typedef struct audio_i2s_underrun {
+    uint32_t start_us;        ///< time_us_32() when the first buffer was missing
+    uint32_t duration_us;     ///< Until a real buffer was queued again
+    uint32_t buffers;         ///< Transfers substituted
+} audio_i2s_underrun_t;
+
+/** \brief Select the underrun policy
+ * \ingroup pico_audio_i2s
+ *
+ * \param policy One of audio_i2s_underrun_policy_t
+ * \param fade_samples Crossfade / fade length in frames, clamped to half a buffer
+ */
+void audio_i2s_set_underrun_policy(audio_i2s_underrun_policy_t policy, uint fade_samples);
+
+/** \brief Copy the most recent underruns, oldest first
+ * \ingroup pico_audio_i2s
+ *
+ * An underrun still in progress is not included until it has recovered.
+ *
+ * \param log Receives up to max entries
+ * \param max Size of log
+ * \return Number of entries copied (at most PICO_AUDIO_I2S_UNDERRUN_LOG_LENGTH)
+ */
+uint audio_i2s_get_underruns(audio_i2s_underrun_t *log, uint max);
+
+/** \brief Make the next DMA refills behave as if the producer had missed its deadline
+ * \ingroup pico_audio_i2s
+ *
+ * The producer's buffers stay queued and play late, exactly like a slow render, so the
+ * underrun policy and the log can be exercised on purpose.
+ *
+ * \param count Number of refills to miss
+ */
+void audio_i2s_inject_underruns(uint count);
+
+/** \brief Underrun state of the DMA IRQ
+ * \ingroup pico_audio_i2s
+ *
+ * The driver keeps one and fills it in through the functions below, which hold every
+ * decision about gaps; a plain struct, so the host test runs the same code.
+ */
+typedef struct audio_i2s_underrun_state {
+    audio_i2s_underrun_policy_t policy;
+    uint fade;                            ///< Frames
+    uint inject;                          ///< Refills still to miss on purpose
+    bool active;                          ///< A gap is in progress
+    bool filled;                          ///< fill holds the fill for this gap
+    audio_buffer_t *fill;                 ///< Built from the last real buffer before a gap
+    audio_buffer_t *silence;
+    audio_i2s_underrun_t current;
+    audio_i2s_underrun_t log[PICO_AUDIO_I2S_UNDERRUN_LOG_LENGTH];
+    uint32_t logged;                      ///< Underruns ever logged
+} audio_i2s_underrun_state_t;
+
+/** \brief Whether this refill is to be missed on purpose (audio_i2s_inject_underruns)
+ * \ingroup pico_audio_i2s
+ */
+bool audio_i2s_underrun_skip(audio_i2s_underrun_state_t *u);
+
+/** \brief A real buffer was taken for the DMA; ends the gap in progress, if any
+ * \ingroup pico_audio_i2s
+ *
+ * The gap is logged and, if the policy asks for it, ab faded in.
+ *
+ * \param now_us time_us_32()
+ */
+void audio_i2s_underrun_recover(audio_i2s_underrun_state_t *u, audio_buffer_t *ab, uint32_t now_us);
+
+/** \brief What to play when no real buffer is ready
+ * \ingroup pico_audio_i2s
+ *
+ * The first missing buffer of a gap counts an underrun and builds the fill from last;
+ * every one counts in stats->silence.
+ *
+ * \param last The real buffer playing (or just played) before the gap, NULL if none
+ * \param now_us time_us_32()
+ * \return u->fill or u->silence
+ */
+audio_buffer_t *audio_i2s_underrun_fill(audio_i2s_underrun_state_t *u, const audio_buffer_t *last,
+                                        uint32_t now_us, audio_i2s_stats_t *stats);
+
+/** \brief Build the fill that plays after last when the next buffer is missing
+ * \ingroup pico_audio_i2s
+ *
+ * Used by the DMA IRQ; a plain function of the samples, so the host test runs it too.
+ * REPEAT replays last's tail, FADE fades it out; the fill starts on last's final frame
+ * either way.
+ *
+ * \param fill Receives min(last's length, its max_sample_count) frames in last's format
+ * \param last The buffer played right before the gap
+ * \param policy AUDIO_I2S_UNDERRUN_REPEAT or AUDIO_I2S_UNDERRUN_FADE
+ * \param fade Crossfade / fade length in frames, clamped to half the fill
+ */
+void audio_i2s_underrun_build(audio_buffer_t *fill, const audio_buffer_t *last,
+                              audio_i2s_underrun_policy_t policy, uint fade);
+
+/** \brief Fade in the first real buffer after a gap
+ * \ingroup pico_audio_i2s
+ *
+ * \param ab The buffer, faded in place
+ * \param fade Fade length in frames, clamped to half the buffer
+ */
+void audio_i2s_underrun_fade_in(audio_buffer_t *ab, uint fade);
+
 #ifdef __cplusplus
 }
 #endif
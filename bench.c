@@ -0,0 +1,560 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Bench: cycles spent in every cell/ kernel
+////////////////////////////////////////////////////////////////////////////////////
+// Separate firmware (grib_bench) linking grib_dsp and nothing else of the synth.
+// Every kernel runs on a block of noise for each of BENCH_BLOCKS, repeated until
+// BENCH_SAMPLES samples went through; the best of BENCH_RUNS passes is kept so USB
+// and timer interrupts do not count.
+//
+// The resample kernels convert S16 blocks with audio_resample (audio/resampler.cpp),
+// timed per input sample like the rest: 2x up from 22050 Hz in both qualities (linear
+// runs on the interpolator on the device), and sinc down from 48000 to 44100 Hz.
+//
+// The cold numbers are one block right after an XIP cache flush, timed with SysTick:
+// the cost when the render follows display or USB code that evicted the kernel.
+// grib_bench_xip is the same firmware with CELL_IN_RAM=0, so comparing the two
+// captures shows what running the CELL_HOT kernels from SRAM gains.
+//
+// Output is one JSON document on stdio between BENCH-BEGIN and BENCH-END:
+//
+//   { "bench": "grib", "clk_sys": 125000000, "sample_rate": 44100, "cell_in_ram": 1,
+//     "results": [
+//     { "kernel": "ltfskf_process", "block": 64, "ns_per_sample": 210.4,
+//       "samples_per_s": 4752851, "cold_ns_per_sample": 480.2, "xip_misses": 21 }, ... ] }
+//
+// The guard counters of the stress kernels (cell/guard.h) follow BENCH-END.
+// tools/bench_compare.py checks a capture against a baseline taken with it (--update).
+// Builds for the host as well (PICO_PLATFORM=host) for quick relative numbers; there
+// it exits after one run. The calibrate kernel is plain C outside cell/, so the bench
+// test (test/CMakeLists.txt) compares every kernel relative to it against
+// tools/bench_baseline_host.json, which holds on hosts of other speeds.
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "arena.h"
+#include "xip.h"
+#include "pico/resampler.h"
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+#endif
+#include "cell/utility.h"
+#include "cell/oscillator.h"
+#include "cell/delay.h"
+#include "cell/chaos.h"
+#include "cell/envelope.h"
+#include "cell/sequencer.h"
+#include "cell/pattern.h"
+#include "cell/noise.h"
+#include "cell/guard.h"
+////////////////////////////////////////////////////////////////////////////////////
+#define SAMPLE_RATE   44100
+#define BENCH_SAMPLES 48000     // Samples per pass and block size
+#define BENCH_RUNS    5         // Passes, fastest one is reported
+#define BENCH_MAX     256       // Largest block
+#define BENCH_WAIT_MS 3000      // Time to attach a terminal
+
+static const unsigned bench_blocks[] = { 16, 64, 256 };
+
+static float in [BENCH_MAX];
+static float out[BENCH_MAX];
+static int16_t in16 [BENCH_MAX];
+static int16_t out16[2 * BENCH_MAX + 2];
+static volatile float sink;     // Keeps the results alive
+
+////////////////////////////////////////////////////////////////////////////////////
+// Kernel state ////////////////////////////////////////////////////////////////////
+static dcblock   s_dcb;
+static dssmf     s_dssmf;
+static ltosvf    s_svf;
+static ltoskf    s_ltoskf;
+static ltfskf    s_ltfskf;
+static psf       s_psf;
+static snh       s_snh;
+static ef        s_ef;
+static limiter   s_lim;
+static oscillator s_osc;
+static delay     s_delay;
+static roessler  s_roessler;
+static hopf      s_hopf;
+static helmholz  s_helmholz;
+static sprott    s_sprott;
+static linz      s_linz;
+static envelope  s_env;
+static adsr      s_adsr;
+static sequencer s_seq;
+static noise     s_noise;
+static pattern   s_pattern;
+static pattern_player s_player;
+static scheduler s_sched;
+static dcblock   s_tail_dcb[2];      // Bare, guarded
+static ltfskf    s_tail_fskf[2];
+static delay     s_tail_delay[2];
+static roessler  s_runaway[2];
+static audio_resampler_t s_up_sinc, s_up_linear, s_down_sinc;
+
+static void bench_setup(void)
+{
+    dcblock_clr(&s_dcb);
+    init_dssmf(&s_dssmf);
+    svflto_clr(&s_svf);
+    svflto_init(&s_svf, 1000.0f, 0.7f);
+    ltoskf_clr(&s_ltoskf);
+    ltoskf_init(&s_ltoskf, 1000.0f, 0.7f);
+    ltfskf_clr(&s_ltfskf);
+    ltfskf_init(&s_ltfskf, 1000.0f, 0.7f);
+    psf_init(&s_psf, 10.0f, SAMPLE_RATE);
+    snh_init(&s_snh);
+    ef_init(&s_ef, 0.5f, 3.0f);
+    limiter_init(&s_lim, 0.5f, 3.0f, 0.5f);
+
+    oscillator_init(&s_osc);
+    s_osc.pwm = 0.25f;
+    set_delta(&s_osc, 440.0f);
+
+    delay_init(&s_delay, ARENA_NEW_ARRAY(ARENA_DSP, float, DELAY_LENGTH));
+    s_delay.time = 0.25f;
+
+    roessler_init(&s_roessler);
+    hopf_init(&s_hopf);
+    helmholz_init(&s_helmholz);
+    sprott_init(&s_sprott);
+    linz_init(&s_linz);
+
+    s_env.t[0] = 2000; s_env.a[0] = 1.0f;
+    s_env.t[1] = 8000; s_env.a[1] = 0.0f;
+    init_envelope(&s_env);
+    adsr_init(&s_adsr);
+    adsr_set(&s_adsr, 2.0f, 1.0f, 5.0f, 0.5f, 5.0f);
+    init_sequence(&s_seq, 5512);
+    noise_init(&s_noise, 1);
+    audio_resampler_init(&s_up_sinc,   22050, 44100, BENCH_MAX, AUDIO_RESAMPLER_SINC);
+    audio_resampler_init(&s_up_linear, 22050, 44100, BENCH_MAX, AUDIO_RESAMPLER_LINEAR);
+    audio_resampler_init(&s_down_sinc, 48000, 44100, BENCH_MAX, AUDIO_RESAMPLER_SINC);
+
+    // Dense worst case: every track triggers every step, half of them ratcheted
+    pattern_clr(&s_pattern);
+    s_pattern.swing = 64;
+    for (unsigned t = 0; t < PATTERN_TRACKS; t++)
+        for (unsigned i = 0; i < PATTERN_STEPS; i++)
+            pattern_set(&s_pattern.track[t], i, true, false, i & 2 ? 7 : PATTERN_ALWAYS, i & 1 ? 2 : 1, i);
+    sched_init(&s_sched);
+    pattern_player_init(&s_player, &s_pattern, 1, 256);
+    pattern_player_start(&s_player, 0, 0);
+
+    // Full scale state, silent input: tails that run into the subnormal range and,
+    // rounding to nearest, stay at its bottom for good
+    for (int g = 0; g < 2; g++)
+    {
+        s_tail_dcb[g].eax = 0.0f;
+        s_tail_dcb[g].ebx = 1.0f;
+        ltfskf_init(&s_tail_fskf[g], 50.0f, 0.7f);
+        s_tail_fskf[g].ic1eq = s_tail_fskf[g].ic2eq = 1.0f;
+        // No room for more lines in the arena: both share the line of delay_process,
+        // holding its noise by the time they run, the guarded one after the bare one
+        s_tail_delay[g]          = s_delay;
+        s_tail_delay[g].time     = 0.001f;
+        s_tail_delay[g].feedback = 0.9f;
+        s_tail_delay[g].amount   = 0.0f;
+        // 30 times the default step, past where Euler stays bounded: off to Inf
+        // within a hundred samples
+        roessler_init(&s_runaway[g]);
+        s_runaway[g].t = 0.3f;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Kernels: one block of n samples from in to out //////////////////////////////////
+// A biquad with fixed coefficients, written out here: the yardstick of the run
+static void k_calibrate(unsigned n)
+{
+    static float z1, z2;
+    for (unsigned i = 0; i < n; i++)
+    {
+        float y = 0.2f * in[i] + z1;
+        z1 = 0.4f * in[i] + 1.1f * y + z2;
+        z2 = 0.2f * in[i] - 0.5f * y;
+        out[i] = y;
+    }
+}
+
+#define FILTER(name, call)                                              \
+static void k_##name(unsigned n)                                        \
+{                                                                       \
+    for (unsigned i = 0; i < n; i++) out[i] = call;                     \
+}
+
+#define OSC(name)                                                       \
+static void k_##name(unsigned n)                                        \
+{                                                                       \
+    for (unsigned i = 0; i < n; i++) { name(&s_osc); out[i] = s_osc.out; } \
+}
+
+#define STEP(name, state, field)                                        \
+static void k_##name(unsigned n)                                        \
+{                                                                       \
+    for (unsigned i = 0; i < n; i++) { name(state); out[i] = (state)->field; } \
+}
+
+FILTER(dcblock_process, dcblock_process(&s_dcb, in[i]))
+FILTER(process_dssmf,   process_dssmf(&s_dssmf, in[i]))
+FILTER(svflto_process,  svflto_process(&s_svf, in[i]))
+FILTER(ltoskf_process,  ltoskf_process(&s_ltoskf, in[i]))
+FILTER(ltfskf_process,  ltfskf_process(&s_ltfskf, in[i]))
+FILTER(psf_process,     psf_process(&s_psf, in[i]))
+FILTER(allpass,         allpass(in[i], 0.5f))
+FILTER(snh_process,     snh_process(&s_snh, in[i], 32))
+FILTER(crossfade,       crossfade(in[i], out[i], 0.3f))
+FILTER(saturate,        saturate(in[i], 0.5f, 0.5f, 0.5f))
+FILTER(ef_process,      (ef_process(&s_ef, in[i]), s_ef.envelope))
+FILTER(limit,           limit(&s_lim, in[i]))
+FILTER(delay_process,   delay_process(&s_delay, in[i]))
+
+OSC(oSine)
+OSC(oRamp)
+OSC(oSawtooth)
+OSC(oSquare)
+OSC(oTomisawa)
+OSC(oTriangle)
+
+// Table generators write a whole table per call, here one block
+static void k_oSineWT(unsigned n)
+{
+    s_osc.data  = out;
+    s_osc.width = n;
+    oSineWT(&s_osc);
+}
+
+static void k_oParabolWT(unsigned n)
+{
+    s_osc.data  = out;
+    s_osc.width = n;
+    oParabolWT(&s_osc);
+}
+
+STEP(roessler_process, &s_roessler, x)
+STEP(hopf_process,     &s_hopf, x)
+STEP(helmholz_process, &s_helmholz, x)
+STEP(sprott_process,   &s_sprott, x)
+STEP(linz_process,     &s_linz, x)
+STEP(fTsucs,           &__tsucs, x)
+STEP(fIkeda,           &__ikeda, x)
+STEP(fDuffing,         &__duffing, x)
+STEP(fGingerbreadman,  &__gingerbreadman, x)
+STEP(fVanderpol,       &__vanderpol, x)
+
+FILTER(process_envelope, process_envelope(&s_env))
+
+// Gate on from idle, off in sustain, so the blocks run through every segment
+static void adsr_cycle(void)
+{
+    if (s_adsr.stage == ADSR_IDLE)    adsr_gate(&s_adsr, true);
+    if (s_adsr.stage == ADSR_SUSTAIN) adsr_gate(&s_adsr, false);
+}
+
+static void k_adsr_process(unsigned n)
+{
+    adsr_cycle();
+    for (unsigned i = 0; i < n; i++) out[i] = adsr_process(&s_adsr);
+}
+
+static void k_adsr_render(unsigned n)
+{
+    adsr_cycle();
+    adsr_render(&s_adsr, out, n);
+}
+
+static void k_adsr_render_control(unsigned n)
+{
+    adsr_cycle();
+    adsr_render_control(&s_adsr, out, n);
+}
+STEP(process_sequence, &s_seq, current)
+
+// libc rand() as the baseline for the noise kernels
+static void k_rand(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = rand() * (2.0f / RAND_MAX) - 1.0f;
+}
+
+static void k_noise_white(unsigned n)
+{
+    noise_white_render(&s_noise, out, n);
+}
+
+static void k_noise_pink(unsigned n)
+{
+    noise_pink_render(&s_noise, out, n);
+}
+
+static void k_noise_blue(unsigned n)
+{
+    noise_blue_render(&s_noise, out, n);
+}
+
+static void k_resample_up_sinc(unsigned n)
+{
+    audio_resample(&s_up_sinc, in16, n, out16);
+}
+
+static void k_resample_up_linear(unsigned n)
+{
+    audio_resample(&s_up_linear, in16, n, out16);
+}
+
+static void k_resample_down_sinc(unsigned n)
+{
+    audio_resample(&s_down_sinc, in16, n, out16);
+}
+
+// Posting plus popping every event, as voice_render_events does around the render
+static void k_pattern_schedule(unsigned n)
+{
+    sched_event e;
+    pattern_schedule(&s_player, &s_sched, n);
+    while (n)
+    {
+        while (sched_pop(&s_sched, &e)) out[0] += e.value;
+        unsigned m = sched_span(&s_sched, n);
+        sched_advance(&s_sched, m);
+        n -= m;
+    }
+}
+
+// Stress: the tails above bare and with their guard after every block
+// (cell/guard.h). The host bench does not call dsp_flush_denormals, so the bare
+// tails show what subnormals cost there; on the RP2040 the pairs differ only by the
+// guard itself.
+static void k_tail_dcblock(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = dcblock_process(&s_tail_dcb[0], 0.0f);
+}
+
+static void k_tail_dcblock_guard(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = dcblock_process(&s_tail_dcb[1], 0.0f);
+    guard_dcblock(&s_tail_dcb[1]);
+}
+
+static void k_tail_ltfskf(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = ltfskf_process(&s_tail_fskf[0], 0.0f);
+}
+
+static void k_tail_ltfskf_guard(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = ltfskf_process(&s_tail_fskf[1], 0.0f);
+    guard_ltfskf(&s_tail_fskf[1]);
+}
+
+static void k_tail_delay(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = delay_process(&s_tail_delay[0], 0.0f);
+}
+
+static void k_tail_delay_guard(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = delay_process(&s_tail_delay[1], 0.0f);
+    guard_delay(&s_tail_delay[1], n);
+}
+
+static void k_runaway_roessler(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) { roessler_process(&s_runaway[0]); out[i] = s_runaway[0].x; }
+}
+
+static void k_runaway_roessler_guard(unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) { roessler_process(&s_runaway[1]); out[i] = s_runaway[1].x; }
+    guard_roessler(&s_runaway[1]);
+}
+
+typedef struct
+{
+    const char* name;
+    void (*run)(unsigned n);
+
+} bench_kernel;
+
+#define KERNEL(name) { #name, k_##name }
+
+static const bench_kernel kernels[] =
+{
+    KERNEL(calibrate),
+    KERNEL(dcblock_process),
+    KERNEL(process_dssmf),
+    KERNEL(svflto_process),
+    KERNEL(ltoskf_process),
+    KERNEL(ltfskf_process),
+    KERNEL(psf_process),
+    KERNEL(allpass),
+    KERNEL(snh_process),
+    KERNEL(crossfade),
+    KERNEL(saturate),
+    KERNEL(ef_process),
+    KERNEL(limit),
+    KERNEL(oSine),
+    KERNEL(oSineWT),
+    KERNEL(oParabolWT),
+    KERNEL(oRamp),
+    KERNEL(oSawtooth),
+    KERNEL(oSquare),
+    KERNEL(oTomisawa),
+    KERNEL(oTriangle),
+    KERNEL(delay_process),
+    KERNEL(roessler_process),
+    KERNEL(hopf_process),
+    KERNEL(helmholz_process),
+    KERNEL(sprott_process),
+    KERNEL(linz_process),
+    KERNEL(fTsucs),
+    KERNEL(fIkeda),
+    KERNEL(fDuffing),
+    KERNEL(fGingerbreadman),
+    KERNEL(fVanderpol),
+    KERNEL(process_envelope),
+    KERNEL(adsr_process),
+    KERNEL(adsr_render),
+    KERNEL(adsr_render_control),
+    KERNEL(process_sequence),
+    KERNEL(pattern_schedule),
+    KERNEL(resample_up_sinc),
+    KERNEL(resample_up_linear),
+    KERNEL(resample_down_sinc),
+    KERNEL(rand),
+    KERNEL(noise_white),
+    KERNEL(noise_pink),
+    KERNEL(noise_blue),
+    KERNEL(tail_dcblock),
+    KERNEL(tail_dcblock_guard),
+    KERNEL(tail_ltfskf),
+    KERNEL(tail_ltfskf_guard),
+    KERNEL(tail_delay),
+    KERNEL(tail_delay_guard),
+    KERNEL(runaway_roessler),
+    KERNEL(runaway_roessler_guard),
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+// Ticks for single blocks: SysTick at clk_sys counting down on the device, us on the host
+#if PICO_ON_DEVICE
+static void bench_ticks_init(void)
+{
+    systick_hw->rvr = 0xFFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 5;    // Enable, processor clock
+}
+
+static inline uint32_t bench_ticks(void)
+{
+    return 0xFFFFFF - systick_hw->cvr;
+}
+
+#define BENCH_TICKS_MASK 0xFFFFFFu
+#define BENCH_TICK_HZ    ((double)clock_get_hz(clk_sys))
+#else
+static void bench_ticks_init(void) {}
+
+static inline uint32_t bench_ticks(void)
+{
+    return time_us_32();
+}
+
+#define BENCH_TICKS_MASK 0xFFFFFFFFu
+#define BENCH_TICK_HZ    1e6
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+// Fastest pass in microseconds
+static uint64_t bench_run(const bench_kernel* k, unsigned n)
+{
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < BENCH_RUNS; r++)
+    {
+        uint64_t t = time_us_64();
+        for (unsigned done = 0; done < BENCH_SAMPLES; done += n) k->run(n);
+        t = time_us_64() - t;
+        if (t < best) best = t;
+        sink = out[n - 1];
+    }
+    return best;
+}
+
+// Fastest single block after an XIP flush, in ticks, and the misses it took
+static uint32_t bench_cold(const bench_kernel* k, unsigned n, uint32_t* misses)
+{
+    uint32_t best = UINT32_MAX;
+    for (int r = 0; r < BENCH_RUNS; r++)
+    {
+        xip_cache_flush();
+        xip_counters_clear();
+        uint32_t t = bench_ticks();
+        k->run(n);
+        t = (bench_ticks() - t) & BENCH_TICKS_MASK;
+        xip_counters xip = xip_counters_read();
+        if (t < best) { best = t; *misses = xip.misses; }
+        sink = out[n - 1];
+    }
+    return best;
+}
+
+int main()
+{
+    stdio_init_all();
+#if PICO_ON_DEVICE
+    sleep_ms(BENCH_WAIT_MS);
+#endif
+
+    // Noise in +-1
+    uint32_t seed = 22222;
+    for (int i = 0; i < BENCH_MAX; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        in[i] = (int32_t)seed * (1.0f / 2147483648.0f);
+        in16[i] = (int16_t)(seed >> 16);
+    }
+    bench_setup();
+    bench_ticks_init();
+    arena_seal();
+
+    printf("BENCH-BEGIN\n");
+    printf("{ \"bench\": \"grib\", \"clk_sys\": %lu, \"sample_rate\": %d, \"cell_in_ram\": %d, \"results\": [\n",
+           (unsigned long)clock_get_hz(clk_sys), SAMPLE_RATE, CELL_IN_RAM);
+    const int nkernels = sizeof kernels / sizeof kernels[0];
+    const int nblocks  = sizeof bench_blocks / sizeof bench_blocks[0];
+    for (int k = 0; k < nkernels; k++)
+    {
+        for (int b = 0; b < nblocks; b++)
+        {
+            unsigned n = bench_blocks[b];
+            unsigned samples = (BENCH_SAMPLES + n - 1) / n * n;
+            uint64_t us = bench_run(&kernels[k], n);
+            if (us == 0) us = 1;
+            double ns = us * 1000.0 / samples;
+            uint32_t misses = 0;
+            double cold = bench_cold(&kernels[k], n, &misses) * 1e9 / BENCH_TICK_HZ / n;
+            printf("  { \"kernel\": \"%s\", \"block\": %u, \"ns_per_sample\": %.2f, \"samples_per_s\": %.0f, "
+                   "\"cold_ns_per_sample\": %.2f, \"xip_misses\": %lu }%s\n",
+                   kernels[k].name, n, ns, 1e9 / ns, cold, (unsigned long)misses,
+                   (k == nkernels - 1 && b == nblocks - 1) ? "" : ",");
+        }
+    }
+    printf("] }\n");
+    printf("BENCH-END\n");
+    // How often the stress kernels' guards fired
+    for (int i = 0; i < GUARD_CELLS; i++)
+        printf("guard %-8s flushed %lu reset %lu\n", guard_names[i],
+               (unsigned long)dsp_guard.flushed[i], (unsigned long)dsp_guard.reset[i]);
+
+#if PICO_ON_DEVICE
+    while (true)
+    {
+        tight_loop_contents();
+    }
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Chain
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Compile-time fused DSP chains (C++17).
+//
+//   cell::chain<cell::source<oSquare>, cell::gain, cell::ltfskf_stage,
+//               cell::limiter_stage, cell::dcblock_stage, cell::gain> ch(...);
+//   ch.render(out, n);
+//
+// Every stage copies the state of the C object it wraps into the chain's local
+// frame before the block and writes it back afterwards, so the per-sample loop
+// works on locals only and all stages inline into one loop. The wrapped objects
+// keep their C API (oscillator_init, ltfskf_init, limit, ...) untouched.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifdef __cplusplus
+#include <stdint.h>
+#include <tuple>
+#include "utility.h"
+#include "oscillator.h"
+
+namespace cell {
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Source: oscillator waveform, input is ignored ///////////////////////////////////////
+template<void (*Form)(oscillator*)>
+struct source
+{
+    oscillator* o;
+    oscillator  s;
+
+    explicit source(oscillator* o) : o(o) {}
+    void  load()       { s = *o; }
+    void  store()      { *o = s; }
+    float tick(float)  { Form(&s); return s.out; }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Stage: any cell of the form float process(T*, float) ////////////////////////////////
+template<typename T, float (*Process)(T*, float)>
+struct stage
+{
+    T* o;
+    T  s;
+
+    explicit stage(T* o) : o(o) {}
+    void  load()          { s = *o; }
+    void  store()         { *o = s; }
+    float tick(float in)  { return Process(&s, in); }
+};
+
+using ltfskf_stage  = stage<ltfskf,  ltfskf_process>;
+using ltoskf_stage  = stage<ltoskf,  ltoskf_process>;
+using limiter_stage = stage<limiter, limit>;
+using dcblock_stage = stage<dcblock, dcblock_process>;
+using psf_stage     = stage<psf,     psf_process>;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Gain: stateless multiply ////////////////////////////////////////////////////////////
+struct gain
+{
+    float g;
+
+    explicit gain(float g) : g(g) {}
+    void  load()          {}
+    void  store()         {}
+    float tick(float in)  { return in * g; }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Chain ///////////////////////////////////////////////////////////////////////////////
+template<typename... Stages>
+struct chain
+{
+    std::tuple<Stages...> stages;
+
+    explicit chain(Stages... s) : stages(s...) {}
+
+    // sink(i, sample) is called once per rendered sample
+    template<typename Sink>
+    void render(unsigned n, Sink sink)
+    {
+        std::tuple<Stages...> st = stages;
+        std::apply([](auto&... s) { (s.load(), ...); }, st);
+        for (unsigned i = 0; i < n; i++)
+        {
+            float x = 0.0f;
+            std::apply([&x](auto&... s) { ((x = s.tick(x)), ...); }, st);
+            sink(i, x);
+        }
+        std::apply([](auto&... s) { (s.store(), ...); }, st);
+    }
+
+    void render(float* out, unsigned n)
+    {
+        render(n, [out](unsigned i, float x) { out[i] = x; });
+    }
+
+    // Q15 output, scaled by 32767 like the wave_table in grib.c
+    void render(int16_t* out, unsigned n)
+    {
+        render(n, [out](unsigned i, float x) { out[i] = (int16_t)(32767.0f * x); });
+    }
+};
+
+template<typename... Stages>
+chain<Stages...> make_chain(Stages... s)
+{
+    return chain<Stages...>(s...);
+}
+
+} // namespace cell
+
+#endif // __cplusplus
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+#include "chaos.h"
+
+void roessler_init(roessler* o)
+{
+    o->x = 1.0f;
+	o->y = 1.0f;
+	o->z = 1.0f;
+	o->a = 0.2f;
+	o->b = 0.2f;
+	o->c = 5.7f;
+	o->t = 0.01f;
+}
+
+void hopf_init(hopf* o)
+{
+    o->x = 0.01f;
+	o->y = 0.01f;
+	o->p = 0.11f;
+    o->t = 0.01f;
+}
+
+void helmholz_init(helmholz* o)
+{
+    o->x = 0.1f;
+	o->y = 0.1f;
+    o->z = 0.1f;
+
+	o->gamma = 5.11f;
+	o->delta = 0.55f;
+    o->t     = 0.01f;
+}
+
+void sprott_init(sprott *o)
+{
+    o->x = 0.1f;
+    o->y = 0.1f;
+    o->z = 0.1f;
+    o->t = 0.1f;
+}
+
+void linz_init(linz* o)
+{
+    o->x = 0.1f;
+	o->y = 0.1f;
+    o->z = 0.1f;
+    o->a = 0.5f;
+    o->t = 0.1f;
+}
+
+tsucs __tsucs = 
+{
+    .x = 1.0f,
+    .y = 1.0f,
+    .z = 1.0f,
+    .a = 40.00f,
+	.b = 0.500f,
+    .c = 20.00f,
+    .d = 0.833f,
+    .e = 0.650f,
+    .t = 0.001f
+};
+
+ikeda __ikeda =
+{
+    .u = 0.918,
+	.x = 0.8,
+	.y = 0.7
+};
+
+duffing __duffing =
+{
+    .x = 0.1f,
+    .y = 0.1f,
+    .a = 2.75f,
+    .b = 0.2f
+};
+
+gingerbreadman __gingerbreadman = 
+{
+    .x = 1.0f,
+    .y = 1.0f
+};
+
+vanderpol __vanderpol =
+{
+    .x = 0.1f,
+	.y = 0.1f,
+	.f = 1.2f,
+    .t = 0.1f,
+	.m = 1.0f
+};
@@ -4,6 +4,11 @@
 ////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include <math.h>
+#include "context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Roessler ////////////////////////////////////////////////////////////////////////////
@@ -19,18 +24,9 @@ typedef struct
     
 } roessler;
 
-void roessler_init(roessler* o)
-{
-    o->x = 1.0f;
-	o->y = 1.0f;
-	o->z = 1.0f;
-	o->a = 0.2f;
-	o->b = 0.2f;
-	o->c = 5.7f;
-	o->t = 0.01f;
-}
+void roessler_init(roessler* o);
 
-void roessler_process(roessler* o)
+static inline void CELL_HOT(roessler_process)(roessler* o)
 {
     o->x += (-o->y - o->z) * o->t;
     o->y += (o->x + o->a * o->y) * o->t;
@@ -48,15 +44,9 @@ typedef struct
 
 } hopf;
 
-void hopf_init(hopf* o)
-{
-    o->x = 0.01f;
-	o->y = 0.01f;
-	o->p = 0.11f;
-    o->t = 0.01f;
-}
+void hopf_init(hopf* o);
 
-void hopf_process(hopf* o)
+static inline void CELL_HOT(hopf_process)(hopf* o)
 {
     o->x += o->t * ( -o->y + o->x * (o->p - (o->x*o->x + o->y*o->y)));
     o->y += o->t * (  o->x + o->y * (o->p - (o->x*o->x + o->y*o->y)));
@@ -76,18 +66,9 @@ typedef struct
    
 } helmholz;
 
-void helmholz_init(helmholz* o)
-{
-    o->x = 0.1f;
-	o->y = 0.1f;
-    o->z = 0.1f;
+void helmholz_init(helmholz* o);
 
-	o->gamma = 5.11f;
-	o->delta = 0.55f;
-    o->t     = 0.01f;
-}
-
-void helmholz_process(helmholz* o)
+static inline void CELL_HOT(helmholz_process)(helmholz* o)
 {
     o->x += o->t * o->y;
     o->y += o->t * o->gamma * o->z;
@@ -106,15 +87,9 @@ typedef struct
 
 } sprott;
 
-void sprott_init(sprott *o)
-{
-    o->x = 0.1f;
-    o->y = 0.1f;
-    o->z = 0.1f;
-    o->t = 0.1f;
-}
+void sprott_init(sprott *o);
 
-void sprott_process(sprott *o)
+static inline void sprott_process(sprott *o)
 {   
     o->x += o->t * o->y;
     o->y += o->t * (o->y * o->z - o->x);
@@ -133,16 +108,9 @@ typedef struct
 
 } linz;
 
-void linz_init(linz* o)
-{
-    o->x = 0.1f;
-	o->y = 0.1f;
-    o->z = 0.1f;
-    o->a = 0.5f;
-    o->t = 0.1f;
-}
+void linz_init(linz* o);
 
-void linz_process(linz* o)
+static inline void linz_process(linz* o)
 {
     o->x += o->t * (o->y + o->z);
     o->y += o->t * (o->y * o->a - o->x);
@@ -294,20 +262,9 @@ typedef struct
 
 } tsucs;
 
-tsucs __tsucs = 
-{
-    .x = 1.0f,
-    .y = 1.0f,
-    .z = 1.0f,
-    .a = 40.00f,
-	.b = 0.500f,
-    .c = 20.00f,
-    .d = 0.833f,
-    .e = 0.650f,
-    .t = 0.001f
-};
-
-void fTsucs(tsucs *o)
+extern tsucs __tsucs;
+
+static inline void fTsucs(tsucs *o)
 {
     o->x += o->t * (o->a*(o->y-o->x) + o->b*o->x*o->z);
     o->y += o->t * (o->c*o->y - o->x*o->z);
@@ -392,18 +349,13 @@ typedef struct
 	float t;
 } ikeda;
 
-ikeda __ikeda =
-{
-    .u = 0.918,
-	.x = 0.8,
-	.y = 0.7
-};
+extern ikeda __ikeda;
 
-void fIkeda(ikeda* o)
+static inline void fIkeda(ikeda* o)
 { 
     o->t  = 0.4f - 6.0f / (1.0f + o->x * o->x + o->y * o->y);
-    o->x  = 1.0f + o->u * (o->x * cos(o->t) - o->y * sin(o->t));
-    o->y  = o->u * (o->x * sin(o->t) + o->y * cos(o->t));
+    o->x  = 1.0f + o->u * (o->x * cosf(o->t) - o->y * sinf(o->t));
+    o->y  = o->u * (o->x * sinf(o->t) + o->y * cosf(o->t));
 }
 // ////////////////////////////////////////////////////////////////////////////////////////
 // // Duffing /////////////////////////////////////////////////////////////////////////////
@@ -416,15 +368,9 @@ typedef struct
 
 } duffing;
 
-duffing __duffing =
-{
-    .x = 0.1f,
-    .y = 0.1f,
-    .a = 2.75f,
-    .b = 0.2f
-};
+extern duffing __duffing;
 
-void fDuffing(duffing* o)
+static inline void fDuffing(duffing* o)
 {
 	o->x = o->y;
 	o->y = (-o->b*o->x + o->a*o->y - o->y*o->y*o->y);
@@ -462,15 +408,11 @@ typedef struct
 
 } gingerbreadman;
 
-gingerbreadman __gingerbreadman = 
-{
-    .x = 1.0f,
-    .y = 1.0f
-};
+extern gingerbreadman __gingerbreadman;
 
-void fGingerbreadman(gingerbreadman* o)
+static inline void fGingerbreadman(gingerbreadman* o)
 {
-	o->x = 1.0f - o->y + abs(o->x);
+	o->x = 1.0f - o->y + fabsf(o->x);
 	o->y = o->x;
 }
 
@@ -486,16 +428,9 @@ typedef struct
 
 } vanderpol;
 
-vanderpol __vanderpol =
-{
-    .x = 0.1f,
-	.y = 0.1f,
-	.f = 1.2f,
-    .t = 0.1f,
-	.m = 1.0f
-};
-
-void fVanderpol(vanderpol* o)
+extern vanderpol __vanderpol;
+
+static inline void fVanderpol(vanderpol* o)
 {
     o->x += o->t * o->y;
     o->y += o->t * (o->m * (o->f - o->x * o->x) * o->y - o->x);
@@ -593,4 +528,8 @@ void fVanderpol(vanderpol* o)
 
 
 // ////////////////////////////////////////////////////////////////////////////////////////
-// ////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+// ////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+}
+#endif
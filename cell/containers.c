@@ -0,0 +1,23 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Containers
+// V.0.1.2 2022-06-20 (C) Unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+#include "containers.h"
+
+void wavering_init(wavering* o)
+{
+    o->i = 0;
+    o->o = 0;
+}
+
+void frame_clr(frame* o, ftype value)
+{
+    for(unsigned i = 0; i < (o->height * o->width); ++i) o->data[i] = value;
+}
+
+void frame_init(frame* o, unsigned x, unsigned y)
+{
+    o->width  = x;
+    o->height = y;
+    o->data   = ARENA_NEW_ARRAY(ARENA_UI, ftype, x * y);
+}
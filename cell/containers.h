@@ -3,10 +3,15 @@
 // V.0.1.2 2022-06-20 (C) Unmanned
 ////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
+#include "arena.h"
 #ifndef WAVERING_LENGTH
 #define WAVERING_LENGTH 128
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // Wavering ////////////////////////////////////////////////////////////////////////////
 typedef struct
@@ -17,20 +22,16 @@ typedef struct
 
 } wavering;
 
-void wavering_init(wavering* o)
-{
-    o->i = 0;
-    o->o = 0;
-}
+void wavering_init(wavering* o);
 
-void wavering_set(wavering* o, int value)
+static inline void wavering_set(wavering* o, int value)
 {
     o->i++;
     if (o->i >= WAVERING_LENGTH) o->i = 0;
     o->data[o->i] = value;
 }
 
-long wavering_get(wavering* o)
+static inline long wavering_get(wavering* o)
 {
     o->o++;
     if (o->o >= WAVERING_LENGTH) o->o = 0;
@@ -51,29 +52,23 @@ typedef struct
 
 } frame;
 
-void frame_pset(frame* o, unsigned x, unsigned y, ftype value)
+static inline void frame_pset(frame* o, unsigned x, unsigned y, ftype value)
 {
     // if(((x >= 0) && (x < o->width)) && ((y >= 0) && (y < o->height)))
     o->data[x + y * o->width] = value;
 }
 
-ftype frame_get(frame* o, unsigned x, unsigned y)
+static inline ftype frame_get(frame* o, unsigned x, unsigned y)
 {
     // if(((x >= 0) && (x < o->width)) && ((y >= 0) && (y < o->height))) return o->data[x + y * o->width];
     return o->data[0];
 }
 
-void frame_clr(frame* o, ftype value)
-{
-    for(unsigned i = 0; i < (o->height * o->width); ++i) o->data[i] = value;
-}
+void frame_clr(frame* o, ftype value);
 
-void frame_init(frame* o, unsigned x, unsigned y)
-{
-    o->data = (ftype*)calloc(o->width*o->height , sizeof(ftype));
-}
+// Once at startup; the pixels live in the arena for good
+void frame_init(frame* o, unsigned x, unsigned y);
 
-void frame_flush(frame* o)
-{
-    free(o->data);
+#ifdef __cplusplus
 }
+#endif
@@ -0,0 +1,9 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Context
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+#include "context.h"
+
+dsp_context dsp_ctx = DSP_CONTEXT_DEFAULT;
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Context
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Runtime sample rate shared by all cells. Coefficients that are expensive to derive
+// (pow/exp per object) are cached for every supported rate at init time and selected
+// by dsp_ctx.rate, so dsp_set_rate is a handful of stores and never stalls the audio.
+// Filters and oscillators recompute from dsp_ctx.inv_rate on their next init/set.
+//
+// CPU budget per sample at clk_sys = 96 MHz:
+//
+//   44.1 kHz  2176 cycles
+//   48 kHz    2000 cycles
+//   96 kHz    1000 cycles
+//
+// A chain costing C cycles/sample loads the core by C / budget, so the same patch
+// needs 9% more CPU at 48 kHz and 2.18x the CPU at 96 kHz compared to 44.1 kHz.
+// The measured load for the running rate is dsp_ctx.load (render time / real time),
+// updated by grib.c after every voice_render.
+//
+// cell/ builds as the grib_dsp library (cell/CMakeLists.txt). Per-sample kernels are
+// static inline in the headers so they inline into the caller's loop; init, clear and
+// coefficient code and shared state (dsp_ctx, form[], ...) are defined once in the .c
+// files, so any number of C and C++ translation units can include the headers.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include "pico.h"
+
+#ifndef SAMPLE_RATE
+#define SAMPLE_RATE 44100
+#endif
+
+// Per-sample kernels marked CELL_HOT are copied to SRAM at boot, so the render does not
+// depend on what else is in the XIP cache. 0 runs them from flash for comparison.
+#ifndef CELL_IN_RAM
+#define CELL_IN_RAM 1
+#endif
+
+#if CELL_IN_RAM
+#define CELL_HOT(f) __not_in_flash_func(f)
+#else
+#define CELL_HOT(f) f
+#endif
+
+typedef enum
+{
+    RATE_44K1 = 0,
+    RATE_48K,
+    RATE_96K,
+    NRATES
+
+} dsp_rate;
+
+static const float dsp_rates[NRATES] = { 44100.0f, 48000.0f, 96000.0f };
+
+typedef struct
+{
+    dsp_rate rate;         // Index into per-rate caches
+    float    sample_rate;  // Hz
+    float    inv_rate;     // 1 / sample_rate
+    float    load;         // Render time / real time of the last block
+
+} dsp_context;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern dsp_context dsp_ctx;  // Defined once, in context.c
+
+#ifdef __cplusplus
+}
+#endif
+
+// Nearest supported rate to Hz
+#define DSP_RATE_OF(hz) ((hz) < 46050 ? RATE_44K1 : (hz) < 72000 ? RATE_48K : RATE_96K)
+
+#define DSP_CONTEXT_DEFAULT { DSP_RATE_OF(SAMPLE_RATE), SAMPLE_RATE, 1.0f / SAMPLE_RATE, 0.0f }
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+static inline void dsp_set_rate(dsp_rate r)
+{
+    dsp_ctx.sample_rate = dsp_rates[r];
+    dsp_ctx.inv_rate    = 1.0f / dsp_rates[r];
+    dsp_ctx.rate        = r;
+}
@@ -0,0 +1,18 @@
+#include <string.h>
+#include "delay.h"
+
+void delay_init(delay* o, float* data)
+{
+    o->tmax = DELAY_LENGTH/1;
+    o->data = (float*)memset(data, 0, DELAY_LENGTH * sizeof(float));
+    o->sample   = 0;
+    o->feedback = 0.5f;
+    o->amount   = 0.5f;
+}
+
+float* delay_clr(delay* o)
+{
+    float* data = o->data;
+    o->data = 0;
+    return data;
+}
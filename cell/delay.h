@@ -1,8 +1,13 @@
 #pragma once
 #include <math.h>
+#include <string.h>
 #include "utility.h"
 #define DELAY_LENGTH 32768
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct
 {
     float* data;
@@ -14,21 +19,13 @@ typedef struct
 
 } delay;
 
-void delay_init(delay* o)
-{
-    o->tmax = DELAY_LENGTH/1;
-    o->data = (float*)calloc(DELAY_LENGTH, sizeof(float));
-    o->sample   = 0;
-    o->feedback = 0.5f;
-    o->amount   = 0.5f;
-}
+// data: DELAY_LENGTH floats owned by the caller (an arena pool block), cleared here
+void delay_init(delay* o, float* data);
 
-void delay_clr(delay* o) 
-{
-    free(o->data);
-}
+// Returns the line for the caller to hand back to its pool
+float* delay_clr(delay* o);
 
-float delay_process(delay* o, float input)
+static inline float CELL_HOT(delay_process)(delay* o, float input)
 {
     if (o->sample >= DELAY_LENGTH) o->sample = 0;
     int f = o->sample - roundf(o->time * o->tmax);
@@ -36,4 +33,8 @@ float delay_process(delay* o, float input)
     float out = o->data[o->sample] = input + (o->data[f] * o->feedback);
     o->sample++;
     return crossfade(out, input, o->amount);
-}
\ No newline at end of file
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,186 @@
+#include <math.h>
+#include <string.h>
+#include "envelope.h"
+
+void init_envelope(envelope* o)
+{
+    o->stage = 0;
+    o->depated = 0;
+    o->feed = 0.0f;
+    float ai = 0.0f;
+    for(int i = 0; i < NSTAGES; i++)
+    {
+        o->f[i] = (o->a[i] - ai)/o->t[i];
+        ai = o->a[i];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// ADSR / AHDSR ////////////////////////////////////////////////////////////////////////
+static void adsr_segment_set(adsr_segment* s, float ms, float ratio, float target)
+{
+    float t = ms * 0.001f * dsp_ctx.sample_rate;
+    s->coef   = t < 1.0f ? 0.0f : expf(-logf((1.0f + ratio) / ratio) / t);
+    s->base   = target * (1.0f - s->coef);
+    s->coef_k = powf(s->coef, ADSR_CONTROL);
+    s->base_k = target * (1.0f - s->coef_k);
+}
+
+void adsr_init(adsr* o)
+{
+    memset(o, 0, sizeof(adsr));
+    o->ratio_attack = ADSR_RATIO_ATTACK;
+    o->ratio_decay  = ADSR_RATIO_DECAY;
+    adsr_set(o, 5.0f, 0.0f, 100.0f, 0.7f, 200.0f);
+}
+
+void adsr_set(adsr* o, float attack, float hold, float decay, float sustain, float release)
+{
+    o->attack  = attack;
+    o->hold    = hold;
+    o->decay   = decay;
+    o->sustain = sustain;
+    o->release = release;
+    o->rate    = -1;
+}
+
+void adsr_update(adsr* o)
+{
+    adsr_segment_set(&o->a, o->attack,  o->ratio_attack, 1.0f + o->ratio_attack);
+    adsr_segment_set(&o->d, o->decay,   o->ratio_decay,  o->sustain - o->ratio_decay);
+    adsr_segment_set(&o->r, o->release, o->ratio_decay,  -o->ratio_decay);
+    o->hold_samples = (int)(o->hold * 0.001f * dsp_ctx.sample_rate);
+    o->rate = dsp_ctx.rate;
+}
+
+void adsr_gate(adsr* o, bool on)
+{
+    if (o->rate != (int8_t)dsp_ctx.rate) adsr_update(o);
+    if (on && !o->gate) o->stage = ADSR_ATTACK;
+    if (!on && o->stage != ADSR_IDLE) o->stage = ADSR_RELEASE;
+    o->gate = on;
+}
+
+void adsr_trigger(adsr* o)
+{
+    if (o->rate != (int8_t)dsp_ctx.rate) adsr_update(o);
+    o->stage = ADSR_ATTACK;
+    o->gate  = true;
+}
+
+// Runs a curve until it reaches end (rising in the attack, falling otherwise) or n
+// samples were written; returns the count
+static unsigned CELL_HOT(adsr_curve)(adsr* o, const adsr_segment* s, float end, float* out, unsigned n)
+{
+    float y = o->out;
+    unsigned i = 0;
+    if (o->stage == ADSR_ATTACK)
+    {
+        while (i < n)
+        {
+            y = s->base + y * s->coef;
+            if (y >= end) { adsr_next(o); out[i++] = o->out; return i; }
+            out[i++] = y;
+        }
+    }
+    else
+    {
+        while (i < n)
+        {
+            y = s->base + y * s->coef;
+            if (y <= end) { adsr_next(o); out[i++] = o->out; return i; }
+            out[i++] = y;
+        }
+    }
+    o->out = y;
+    return i;
+}
+
+void CELL_HOT(adsr_render)(adsr* o, float* out, unsigned n)
+{
+    if (o->rate != (int8_t)dsp_ctx.rate) adsr_update(o);
+    unsigned i = 0;
+    while (i < n)
+    {
+        switch (o->stage)
+        {
+            case ADSR_ATTACK:  i += adsr_curve(o, &o->a, 1.0f, out + i, n - i); break;
+            case ADSR_DECAY:   i += adsr_curve(o, &o->d, o->sustain, out + i, n - i); break;
+            case ADSR_RELEASE: i += adsr_curve(o, &o->r, 0.0f, out + i, n - i); break;
+            case ADSR_HOLD:
+            {
+                unsigned m = (unsigned)o->count < n - i ? (unsigned)o->count : n - i;
+                for (unsigned k = 0; k < m; k++) out[i + k] = 1.0f;
+                i += m;
+                o->count -= m;
+                if (o->count <= 0) adsr_next(o);
+                break;
+            }
+            case ADSR_SUSTAIN:
+                o->out = o->sustain;
+                for (; i < n; i++) out[i] = o->out;
+                break;
+            default:
+                for (; i < n; i++) out[i] = o->out;
+                break;
+        }
+    }
+}
+
+void CELL_HOT(adsr_apply)(adsr* o, float* buf, unsigned n)
+{
+    float env[64];
+    while (n)
+    {
+        unsigned m = n < 64 ? n : 64;
+        adsr_render(o, env, m);
+        for (unsigned i = 0; i < m; i++) buf[i] *= env[i];
+        buf += m;
+        n   -= m;
+    }
+}
+
+// Level ADSR_CONTROL samples on
+static float CELL_HOT(adsr_control_point)(adsr* o)
+{
+    switch (o->stage)
+    {
+        case ADSR_ATTACK:
+            o->out = o->a.base_k + o->out * o->a.coef_k;
+            if (o->out >= 1.0f) adsr_next(o);
+            break;
+        case ADSR_HOLD:
+            o->count -= ADSR_CONTROL;
+            if (o->count <= 0) adsr_next(o);
+            break;
+        case ADSR_DECAY:
+            o->out = o->d.base_k + o->out * o->d.coef_k;
+            if (o->out <= o->sustain) adsr_next(o);
+            break;
+        case ADSR_SUSTAIN:
+            o->out = o->sustain;
+            break;
+        case ADSR_RELEASE:
+            o->out = o->r.base_k + o->out * o->r.coef_k;
+            if (o->out <= 0.0f) adsr_next(o);
+            break;
+        default: break;
+    }
+    return o->out;
+}
+
+void CELL_HOT(adsr_render_control)(adsr* o, float* out, unsigned n)
+{
+    if (o->rate != (int8_t)dsp_ctx.rate) adsr_update(o);
+    for (unsigned i = 0; i < n; i++)
+    {
+        if (o->tick == 0)
+        {
+            o->step = (adsr_control_point(o) - o->lerp) * (1.0f / ADSR_CONTROL);
+            o->tick = ADSR_CONTROL;
+        }
+        o->lerp += o->step;
+        o->tick--;
+        out[i] = o->lerp;
+    }
+}
@@ -1,6 +1,14 @@
 
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "context.h"
 #define NSTAGES 2
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct 
 {
     int   t[NSTAGES]; // Timings
@@ -12,20 +20,9 @@ typedef struct
 
 } envelope;
 
-void init_envelope(envelope* o)
-{
-    o->stage = 0;
-    o->depated = 0;
-    o->feed = 0.0f;
-    int ai = 0;
-    for(int i = 0; i < NSTAGES; i++)
-    {
-        o->f[i] = (o->a[i] - ai)/o->t[i];
-        ai = o->a[i];
-    }
-}
+void init_envelope(envelope* o);
 
-float process_envelope(envelope* o)
+static inline float process_envelope(envelope* o)
 {
     if(o->depated >= o->t[o->stage]) 
     {
@@ -36,4 +33,138 @@ float process_envelope(envelope* o)
     o->feed += o->f[o->stage];
     o->depated++;
     return o->feed;
-}
\ No newline at end of file
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// ADSR / AHDSR ////////////////////////////////////////////////////////////////////////
+// Every segment is a one pole curve heading for a target past its end level,
+//   y = base + y * coef
+// so a sample costs one multiply-add and a compare. The overshoot (ratio) sets the
+// curvature: small is exponential, large approaches a line. Attack ends at 1 after
+// attack ms from 0, decay at sustain, release at 0. Hold keeps 1 for hold ms between
+// attack and decay; 0 makes it a plain ADSR.
+//
+// adsr_gate(o, true) starts the attack from the current level, so a note during the
+// release does not click; a gate that is already on is left alone, adsr_trigger
+// restarts the attack anyway. adsr_gate(o, false) releases from wherever it is.
+//
+// adsr_render is sample accurate. adsr_render_control is for modulation: it moves the
+// segments every ADSR_CONTROL samples, so gates and stage changes land on that grid,
+// and interpolates linearly in between. Use one of the two per envelope.
+//
+// Coefficients follow dsp_ctx.rate, refreshed by adsr_gate and the render calls.
+
+#ifndef ADSR_CONTROL
+#define ADSR_CONTROL 16
+#endif
+
+#define ADSR_RATIO_ATTACK 0.3f
+#define ADSR_RATIO_DECAY  0.0001f
+
+typedef enum
+{
+    ADSR_IDLE = 0,
+    ADSR_ATTACK,
+    ADSR_HOLD,
+    ADSR_DECAY,
+    ADSR_SUSTAIN,
+    ADSR_RELEASE
+
+} adsr_stage;
+
+typedef struct
+{
+    float coef;    // Per sample
+    float base;
+    float coef_k;  // Per ADSR_CONTROL samples
+    float base_k;
+
+} adsr_segment;
+
+typedef struct
+{
+    float attack;        // ms
+    float hold;          // ms
+    float decay;         // ms
+    float sustain;       // Level 0 < 1
+    float release;       // ms
+    float ratio_attack;  // Overshoot of the attack target
+    float ratio_decay;   // Undershoot of the decay and release targets
+
+    adsr_segment a, d, r;
+    int     hold_samples;
+    int8_t  rate;        // dsp_rate the segments were computed for, -1 stale
+
+    float   out;         // Current level
+    uint8_t stage;       // adsr_stage
+    bool    gate;
+    int     count;       // Samples left in hold
+    float   lerp;        // Control mode: interpolated output
+    float   step;        // Control mode: increment per sample
+    unsigned tick;       // Control mode: samples left to the next control point
+
+} adsr;
+
+void adsr_init(adsr* o);
+void adsr_set(adsr* o, float attack, float hold, float decay, float sustain, float release);
+void adsr_update(adsr* o);
+void adsr_gate(adsr* o, bool on);
+void adsr_trigger(adsr* o);
+
+// Block render, sample accurate
+void adsr_render(adsr* o, float* out, unsigned n);
+
+// Multiply buf by the envelope
+void adsr_apply(adsr* o, float* buf, unsigned n);
+
+// Block render at control rate with per-sample interpolation
+void adsr_render_control(adsr* o, float* out, unsigned n);
+
+static inline void adsr_next(adsr* o)
+{
+    switch (o->stage)
+    {
+        case ADSR_ATTACK:
+            o->out = 1.0f;
+            o->count = o->hold_samples;
+            o->stage = o->count > 0 ? ADSR_HOLD : ADSR_DECAY;
+            break;
+        case ADSR_HOLD:    o->stage = ADSR_DECAY; break;
+        case ADSR_DECAY:   o->out = o->sustain; o->stage = ADSR_SUSTAIN; break;
+        case ADSR_RELEASE: o->out = 0.0f; o->stage = ADSR_IDLE; break;
+        default: break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// One sample //////////////////////////////////////////////////////////////////////////
+static inline float CELL_HOT(adsr_process)(adsr* o)
+{
+    switch (o->stage)
+    {
+        case ADSR_ATTACK:
+            o->out = o->a.base + o->out * o->a.coef;
+            if (o->out >= 1.0f) adsr_next(o);
+            break;
+        case ADSR_HOLD:
+            if (--o->count <= 0) adsr_next(o);
+            break;
+        case ADSR_DECAY:
+            o->out = o->d.base + o->out * o->d.coef;
+            if (o->out <= o->sustain) adsr_next(o);
+            break;
+        case ADSR_SUSTAIN:
+            o->out = o->sustain;
+            break;
+        case ADSR_RELEASE:
+            o->out = o->r.base + o->out * o->r.coef;
+            if (o->out <= 0.0f) adsr_next(o);
+            break;
+        default: break;
+    }
+    return o->out;
+}
+
+#ifdef __cplusplus
+}
+#endif
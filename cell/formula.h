@@ -1,6 +1,7 @@
+#pragma once
 /////////////////////////////////////////////////////////////////////////////////////////
 // Collatz //////////////////////////////////////////////////////////////////////////////
-unsigned C3N1(unsigned seed)
+static inline unsigned C3N1(unsigned seed)
 {
     return (seed & 1)? 3 * seed + 1 : seed / 2;;
 }
\ No newline at end of file
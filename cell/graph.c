@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Graph
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// The per-sample kernels are inlined from their headers into graph_run, so this file
+// decides the code the patch engine runs (see GRIB_DSP_HOT_OPTIONS in CMakeLists.txt).
+////////////////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+#include <string.h>
+#include "graph.h"
+#include "guard.h"
+
+void graph_init(graph* g)
+{
+    memset(g, 0, sizeof(graph));
+    arena_pool_init(&g->delays, ARENA_DSP, DELAY_LENGTH * sizeof(float), GRAPH_MAX_DELAYS);
+}
+
+void graph_clr(graph* g)
+{
+    for (int i = 0; i < g->count; i++)
+    {
+        if (g->node[i].d.kind == PATCH_DELAY) arena_pool_give(&g->delays, delay_clr(&g->node[i].s.dl));
+    }
+    g->count = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+int graph_load(graph* g, const patch* p)
+{
+    uint8_t order[PATCH_MAX_NODES];
+    int8_t  buf[PATCH_MAX_NODES];
+    uint8_t indeg[PATCH_MAX_NODES];
+    uint8_t pos[PATCH_MAX_NODES];
+    uint8_t last[PATCH_MAX_NODES];
+    int n = p->count;
+    int delays = 0;
+
+    if (n == 0 || n > PATCH_MAX_NODES) return GRAPH_EINVAL;
+    if (p->output < 0 || p->output >= n) return GRAPH_EINVAL;
+
+    for (int i = 0; i < n; i++)
+    {
+        const patch_node* d = &p->node[i];
+        if (d->kind >= PATCH_KINDS) return GRAPH_EINVAL;
+        if (d->kind == PATCH_DELAY) delays++;
+        indeg[i] = 0;
+        for (int k = 0; k < PATCH_MAX_INPUTS; k++)
+        {
+            int src = d->in[k];
+            if (k >= graph_inputs(d->kind)) continue;
+            if (src < 0 || src >= n || src == i) return GRAPH_EINVAL;
+            indeg[i]++;
+        }
+        for (int k = 0; k < PATCH_MAX_PARAMS; k++)
+        {
+            int c = d->bind[k];
+            if (c != PATCH_NONE && (c < 0 || c >= PATCH_CTLS)) return GRAPH_EINVAL;
+            if (!isfinite(d->param[k])) return GRAPH_EINVAL;
+        }
+        // A preset from flash may carry anything; a bound time is clamped in graph_update
+        if (d->kind == PATCH_DELAY && d->bind[0] == PATCH_NONE && !(d->param[0] >= 0.0f && d->param[0] <= 1.0f))
+            return GRAPH_EINVAL;
+    }
+    if (delays > GRAPH_MAX_DELAYS) return GRAPH_EDELAYS;
+
+    // Kahn: repeatedly take a node whose inputs have all been scheduled
+    int head = 0, tail = 0;
+    for (int i = 0; i < n; i++) if (indeg[i] == 0) order[tail++] = i;
+    while (head < tail)
+    {
+        int v = order[head++];
+        for (int i = 0; i < n; i++)
+        {
+            for (int k = 0; k < graph_inputs(p->node[i].kind); k++)
+            {
+                if (p->node[i].in[k] == v && --indeg[i] == 0) order[tail++] = i;
+            }
+        }
+    }
+    if (tail != n) return GRAPH_ECYCLE;
+
+    // Lifetime of each output: position of its last reader
+    for (int i = 0; i < n; i++) pos[order[i]] = i;
+    for (int i = 0; i < n; i++) last[i] = pos[i];
+    for (int i = 0; i < n; i++)
+    {
+        for (int k = 0; k < graph_inputs(p->node[i].kind); k++)
+        {
+            int src = p->node[i].in[k];
+            if (pos[i] > last[src]) last[src] = pos[i];
+        }
+    }
+    last[p->output] = n;
+
+    // Release inputs at their last use before taking a buffer for the output
+    uint32_t used = 0;
+    int peak = 0;
+    for (int t = 0; t < n; t++)
+    {
+        int v = order[t];
+        for (int k = 0; k < graph_inputs(p->node[v].kind); k++)
+        {
+            int src = p->node[v].in[k];
+            if (last[src] == t) used &= ~(1u << buf[src]);
+        }
+        int b = 0;
+        while (b < GRAPH_MAX_BUFFERS && (used & (1u << b))) b++;
+        if (b == GRAPH_MAX_BUFFERS) return GRAPH_EBUFFERS;
+        buf[v] = b;
+        used |= 1u << b;
+        if (b + 1 > peak) peak = b + 1;
+        if (last[v] == t) used &= ~(1u << b); // Nobody reads it
+    }
+
+    graph_clr(g);
+    for (int i = 0; i < n; i++)
+    {
+        graph_node* o = &g->node[i];
+        o->d = p->node[i];
+        o->buf = buf[i];
+        o->cache[0] = o->cache[1] = -1.0f;
+        o->rate = -1;
+        memset(&o->s, 0, sizeof(o->s));
+        switch (o->d.kind)
+        {
+            case PATCH_OSC:      oscillator_init(&o->s.osc); o->s.osc.eax = PI; break;
+            case PATCH_LTFSKF:   ltfskf_clr(&o->s.fskf); break;
+            case PATCH_LTOSKF:   ltoskf_clr(&o->s.oskf); break;
+            case PATCH_SVFLTO:   svflto_clr(&o->s.svf);  break;
+            case PATCH_DELAY:    delay_init(&o->s.dl, (float*)arena_pool_take(&g->delays)); break;
+            case PATCH_LIMITER:  limiter_init(&o->s.lim, 0.5f, 3.0f, o->d.param[0]); break;
+            case PATCH_DCB:      dcblock_clr(&o->s.dc);  break;
+            case PATCH_ROESSLER: roessler_init(&o->s.rs); break;
+            case PATCH_HOPF:     hopf_init(&o->s.hp);    break;
+            case PATCH_HELMHOLZ: helmholz_init(&o->s.hh); break;
+            default: break;
+        }
+    }
+    memcpy(g->order, order, n);
+    g->count = n;
+    g->output = p->output;
+    g->nbuffers = peak;
+    return GRAPH_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+// Delay time param, possibly bound to a knob: outside 0 .. 1 the read index leaves the
+// line, so clamped, NaN to 0
+static inline float graph_unit(float q)
+{
+    if (!(q > 0.0f)) return 0.0f;
+    return q < 1.0f ? q : 1.0f;
+}
+
+void graph_update(graph_node* o, const float* ctl)
+{
+    float* q = o->d.param;
+    for (int k = 0; k < PATCH_MAX_PARAMS; k++)
+    {
+        if (o->d.bind[k] != PATCH_NONE) q[k] = ctl[o->d.bind[k]];
+    }
+    switch (o->d.kind)
+    {
+        case PATCH_OSC:
+            set_delta(&o->s.osc, q[0]);
+            o->s.osc.pwm = (q[1] - 0.5f) * TAO;
+            o->s.osc.amplitude = q[3];
+            break;
+        case PATCH_LTFSKF:
+        case PATCH_LTOSKF:
+        case PATCH_SVFLTO:
+            if (q[0] == o->cache[0] && q[1] == o->cache[1] && o->rate == (int8_t)dsp_ctx.rate) break;
+            o->cache[0] = q[0];
+            o->cache[1] = q[1];
+            o->rate = dsp_ctx.rate;
+            if (o->d.kind == PATCH_LTFSKF) ltfskf_init(&o->s.fskf, q[0], q[1]);
+            if (o->d.kind == PATCH_LTOSKF) ltoskf_init(&o->s.oskf, q[0], q[1]);
+            if (o->d.kind == PATCH_SVFLTO) svflto_init(&o->s.svf,  q[0], q[1]);
+            break;
+        case PATCH_DELAY:
+            o->s.dl.time     = graph_unit(q[0]);
+            o->s.dl.feedback = q[1];
+            o->s.dl.amount   = q[2];
+            break;
+        case PATCH_LIMITER:  o->s.lim.threshold = q[0]; break;
+        case PATCH_ROESSLER: o->s.rs.t = q[0]; break;
+        case PATCH_HOPF:     o->s.hp.t = q[0]; break;
+        case PATCH_HELMHOLZ: o->s.hh.t = q[0]; break;
+        default: break;
+    }
+}
+
+// Per block: feedback state of o flushed or, if it blew up, reset (cell/guard.h)
+static bool graph_guard(graph_node* o, unsigned n)
+{
+    switch (o->d.kind)
+    {
+        case PATCH_LTFSKF:   return guard_ltfskf(&o->s.fskf);
+        case PATCH_LTOSKF:   return guard_ltoskf(&o->s.oskf);
+        case PATCH_SVFLTO:   return guard_svflto(&o->s.svf);
+        case PATCH_DELAY:    return guard_delay(&o->s.dl, n);
+        case PATCH_LIMITER:  return guard_limiter(&o->s.lim);
+        case PATCH_DCB:      return guard_dcblock(&o->s.dc);
+        case PATCH_ROESSLER: return guard_roessler(&o->s.rs);
+        case PATCH_HOPF:     return guard_hopf(&o->s.hp);
+        case PATCH_HELMHOLZ: return guard_helmholz(&o->s.hh);
+        default:             return false;
+    }
+}
+
+// Form index param, possibly bound to a knob: clamped while still a float, NaN to 0
+static inline unsigned graph_form(float q)
+{
+    if (!(q > 0.0f)) return 0;
+    if (q >= (float)(OSC_FORMS - 1)) return OSC_FORMS - 1;
+    return (unsigned)q;
+}
+
+void CELL_HOT(graph_run)(graph* g, graph_node* o, unsigned n)
+{
+    float* y = g->buffer[o->buf];
+    const float* a = y;
+    const float* b = y;
+    if (graph_inputs(o->d.kind) > 0) a = g->buffer[g->node[o->d.in[0]].buf];
+    if (graph_inputs(o->d.kind) > 1) b = g->buffer[g->node[o->d.in[1]].buf];
+    const float* q = o->d.param;
+    unsigned i;
+
+    switch (o->d.kind)
+    {
+        case PATCH_OSC:
+        {
+            void (*f)(oscillator*) = form[graph_form(q[2])];
+            for (i = 0; i < n; i++) { f(&o->s.osc); y[i] = o->s.osc.out; }
+            break;
+        }
+        case PATCH_LTFSKF:   for (i = 0; i < n; i++) y[i] = ltfskf_process(&o->s.fskf, a[i]); break;
+        case PATCH_LTOSKF:   for (i = 0; i < n; i++) y[i] = ltoskf_process(&o->s.oskf, a[i]); break;
+        case PATCH_SVFLTO:   for (i = 0; i < n; i++) y[i] = svflto_process(&o->s.svf, a[i]); break;
+        case PATCH_DELAY:    for (i = 0; i < n; i++) y[i] = delay_process(&o->s.dl, a[i]); break;
+        case PATCH_LIMITER:  for (i = 0; i < n; i++) y[i] = limit(&o->s.lim, a[i]); break;
+        case PATCH_DCB:      for (i = 0; i < n; i++) y[i] = dcblock_process(&o->s.dc, a[i]); break;
+        case PATCH_GAIN:     for (i = 0; i < n; i++) y[i] = a[i] * q[0]; break;
+        case PATCH_MIX:      for (i = 0; i < n; i++) y[i] = crossfade(a[i], b[i], q[0]); break;
+        case PATCH_ROESSLER: for (i = 0; i < n; i++) { roessler_process(&o->s.rs); y[i] = o->s.rs.x * q[1]; } break;
+        case PATCH_HOPF:     for (i = 0; i < n; i++) { hopf_process(&o->s.hp); y[i] = o->s.hp.x * q[1]; } break;
+        case PATCH_HELMHOLZ: for (i = 0; i < n; i++) { helmholz_process(&o->s.hh); y[i] = o->s.hh.x * q[1]; } break;
+        default: break;
+    }
+    // A reset cell rendered NaN or a runaway: keep it from the nodes downstream
+    if (graph_guard(o, n)) memset(y, 0, n * sizeof(float));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+void CELL_HOT(graph_process)(graph* g, const float* ctl, float* out, unsigned n)
+{
+    for (int t = 0; t < g->count; t++) graph_update(&g->node[g->order[t]], ctl);
+
+    while (n)
+    {
+        unsigned m = n < GRAPH_BLOCK ? n : GRAPH_BLOCK;
+        for (int t = 0; t < g->count; t++) graph_run(g, &g->node[g->order[t]], m);
+        memcpy(out, g->buffer[g->node[g->output].buf], m * sizeof(float));
+        out += m;
+        n   -= m;
+    }
+}
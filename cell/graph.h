@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Graph
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Runs a patch (patch.h) in blocks of GRAPH_BLOCK samples. graph_load sorts the nodes
+// topologically and assigns each node output one of GRAPH_MAX_BUFFERS scratch buffers,
+// handing a buffer back as soon as its last reader has run. All kernels work sample
+// by sample, so a node may write into the buffer it reads from.
+//
+// Memory is static: sizeof(graph) is about 3.2 KB with the defaults below, plus an
+// arena pool (arena.h) of GRAPH_MAX_DELAYS delay lines of DELAY_LENGTH floats (128 KB
+// each) reserved by graph_init; loading and clearing patches only takes and gives.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "patch.h"
+#include "utility.h"
+#include "oscillator.h"
+#include "delay.h"
+#include "chaos.h"
+#include "arena.h"
+
+#ifndef GRAPH_BLOCK
+#define GRAPH_BLOCK 64
+#endif
+
+#ifndef GRAPH_MAX_BUFFERS
+#define GRAPH_MAX_BUFFERS 6
+#endif
+
+#ifndef GRAPH_MAX_DELAYS
+#define GRAPH_MAX_DELAYS 1
+#endif
+
+#define GRAPH_OK        0
+#define GRAPH_EINVAL   -1  // Bad kind, index, parameter or missing input
+#define GRAPH_ECYCLE   -2  // Feedback loop between nodes
+#define GRAPH_EBUFFERS -3  // More live signals than GRAPH_MAX_BUFFERS
+#define GRAPH_EDELAYS  -4  // More than GRAPH_MAX_DELAYS delay nodes
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    patch_node d;
+    float      cache[2];  // Parameters the coefficients were computed for
+    int8_t     rate;      // dsp_rate they were computed at
+    int8_t     buf;       // Scratch buffer holding the output
+
+    union
+    {
+        oscillator osc;
+        ltfskf     fskf;
+        ltoskf     oskf;
+        ltosvf     svf;
+        delay      dl;
+        limiter    lim;
+        dcblock    dc;
+        roessler   rs;
+        hopf       hp;
+        helmholz   hh;
+    } s;
+
+} graph_node;
+
+typedef struct
+{
+    graph_node node[PATCH_MAX_NODES];
+    uint8_t    order[PATCH_MAX_NODES];
+    uint8_t    count;
+    int8_t     output;
+    uint8_t    nbuffers;  // Peak scratch buffers in use
+    arena_pool_t delays;  // GRAPH_MAX_DELAYS lines of DELAY_LENGTH floats
+    float      buffer[GRAPH_MAX_BUFFERS][GRAPH_BLOCK];
+
+} graph;
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+static inline int graph_inputs(uint8_t kind)
+{
+    switch (kind)
+    {
+        case PATCH_OSC:
+        case PATCH_ROESSLER:
+        case PATCH_HOPF:
+        case PATCH_HELMHOLZ: return 0;
+        case PATCH_MIX:      return 2;
+        default:             return 1;
+    }
+}
+
+void graph_init(graph* g);
+
+// Hands the delay lines back to the pool
+void graph_clr(graph* g);
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Validate, sort and assign buffers; the running graph is untouched on failure ////////
+int graph_load(graph* g, const patch* p);
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Pull bound controls and refresh coefficients once per block /////////////////////////
+void graph_update(graph_node* o, const float* ctl);
+
+// n <= GRAPH_BLOCK
+void graph_run(graph* g, graph_node* o, unsigned n);
+
+////////////////////////////////////////////////////////////////////////////////////////
+// ctl: PATCH_CTLS control values; n may exceed GRAPH_BLOCK ////////////////////////////
+void graph_process(graph* g, const float* ctl, float* out, unsigned n);
+
+#ifdef __cplusplus
+}
+#endif
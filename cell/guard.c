@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Guard
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "guard.h"
+
+guard_stats dsp_guard;
+
+void guard_clear(void)
+{
+    memset(&dsp_guard, 0, sizeof(dsp_guard));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// n state variables: true if one is not finite or beyond limit, else tiny ones zeroed
+static bool CELL_HOT(guard_state)(guard_cell c, float** v, unsigned n, float limit)
+{
+    bool flushed = false;
+    for (unsigned i = 0; i < n; i++)
+    {
+        if (!guard_finite(*v[i]) || fabsf(*v[i]) > limit)
+        {
+            dsp_guard.reset[c]++;
+            return true;
+        }
+        if (guard_tiny(*v[i]))
+        {
+            *v[i] = 0.0f;
+            flushed = true;
+        }
+    }
+    if (flushed) dsp_guard.flushed[c]++;
+    return false;
+}
+
+bool CELL_HOT(guard_ltfskf)(ltfskf* o)
+{
+    float* v[] = { &o->ic1eq, &o->ic2eq };
+    if (!guard_state(GUARD_FILTER, v, 2, INFINITY)) return false;
+    ltfskf_clr(o);
+    return true;
+}
+
+bool CELL_HOT(guard_ltoskf)(ltoskf* o)
+{
+    float* v[] = { &o->ic1eq, &o->ic2eq };
+    if (!guard_state(GUARD_FILTER, v, 2, INFINITY)) return false;
+    ltoskf_clr(o);
+    return true;
+}
+
+bool CELL_HOT(guard_svflto)(ltosvf* o)
+{
+    float* v[] = { &o->ic1eq, &o->ic2eq };
+    if (!guard_state(GUARD_FILTER, v, 2, INFINITY)) return false;
+    svflto_clr(o);
+    return true;
+}
+
+bool CELL_HOT(guard_dcblock)(dcblock* o)
+{
+    float* v[] = { &o->eax, &o->ebx };
+    if (!guard_state(GUARD_DCBLOCK, v, 2, INFINITY)) return false;
+    dcblock_clr(o);
+    return true;
+}
+
+bool CELL_HOT(guard_limiter)(limiter* o)
+{
+    float* v[] = { &o->e.envelope };
+    if (!guard_state(GUARD_LIMITER, v, 1, INFINITY)) return false;
+    o->e.envelope = 0.0f;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+bool CELL_HOT(guard_delay)(delay* o, unsigned n)
+{
+    if (n > DELAY_LENGTH) n = DELAY_LENGTH;
+    bool flushed = false;
+    int s = o->sample;
+    for (unsigned i = 0; i < n; i++)
+    {
+        if (--s < 0) s += DELAY_LENGTH;
+        float x = o->data[s];
+        if (!guard_finite(x))
+        {
+            memset(o->data, 0, DELAY_LENGTH * sizeof(float));
+            dsp_guard.reset[GUARD_DELAY]++;
+            return true;
+        }
+        if (guard_tiny(x))
+        {
+            o->data[s] = 0.0f;
+            flushed = true;
+        }
+    }
+    if (flushed) dsp_guard.flushed[GUARD_DELAY]++;
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+bool CELL_HOT(guard_roessler)(roessler* o)
+{
+    float* v[] = { &o->x, &o->y, &o->z };
+    if (!guard_state(GUARD_CHAOS, v, 3, GUARD_CHAOS_LIMIT)) return false;
+    float t = o->t;
+    roessler_init(o);
+    o->t = t;
+    return true;
+}
+
+bool CELL_HOT(guard_hopf)(hopf* o)
+{
+    float* v[] = { &o->x, &o->y };
+    if (!guard_state(GUARD_CHAOS, v, 2, GUARD_CHAOS_LIMIT)) return false;
+    float t = o->t;
+    hopf_init(o);
+    o->t = t;
+    return true;
+}
+
+bool CELL_HOT(guard_helmholz)(helmholz* o)
+{
+    float* v[] = { &o->x, &o->y, &o->z };
+    if (!guard_state(GUARD_CHAOS, v, 3, GUARD_CHAOS_LIMIT)) return false;
+    float t = o->t;
+    helmholz_init(o);
+    o->t = t;
+    return true;
+}
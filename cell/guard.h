@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Guard
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Denormal and NaN protection for the feedback state of the cells.
+//
+// Decaying feedback (filter integrators, the DC blocker, the limiter's envelope, the
+// delay line) ends in subnormal floats. The RP2040 float library flushes them to zero
+// anyway, but x86 and Arm hosts take microcode assists on every operation that touches
+// one: a host render of a tail into silence runs 10 to 100 times slower. An attractor
+// stepped past its stable step size runs off to Inf and then NaN, and a NaN that
+// reaches any feedback state stays there for good.
+//
+// - dsp_flush_denormals turns on flush-to-zero for the calling thread on the host
+//   (FTZ/DAZ on x86, FZ on AArch64 and the Cortex-M33 FPU); a no-op on the RP2040.
+// - The guard_<cell> functions run once per block on a cell's state (CELL_HOT, like
+//   the block kernels), mostly integer tests on the float bits. A value that is not
+//   finite (or, for the attractors, beyond +-GUARD_CHAOS_LIMIT) resets the cell and
+//   the function returns true: the block the cell just rendered is garbage too and the
+//   caller should silence it. A value below 2^-64 (GUARD_TINY_BITS) is zeroed while it
+//   is still normal, long before it could go subnormal within the next block.
+// - guard_delay checks the samples the block wrote into the line; the line is too long
+//   to scan and everything in it was checked when it was written.
+//
+// dsp_guard counts, per class of cell, the blocks in which each of the two fired.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "utility.h"
+#include "delay.h"
+#include "chaos.h"
+#if !PICO_ON_DEVICE && (defined(__SSE__) || defined(_M_X64))
+#include <xmmintrin.h>
+#endif
+
+#define GUARD_TINY_BITS   ((127u - 64u) << 23)   // 2^-64, about -385 dBFS
+#define GUARD_CHAOS_LIMIT 1e4f                   // Attractors in use stay within +-30
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    GUARD_FILTER = 0,  // ltfskf, ltoskf, svflto
+    GUARD_DCBLOCK,
+    GUARD_LIMITER,
+    GUARD_DELAY,
+    GUARD_CHAOS,       // roessler, hopf, helmholz
+    GUARD_CELLS
+
+} guard_cell;
+
+static const char* const guard_names[GUARD_CELLS] = { "filter", "dcblock", "limiter", "delay", "chaos" };
+
+typedef struct
+{
+    uint32_t flushed[GUARD_CELLS];  // Blocks with tiny state zeroed
+    uint32_t reset[GUARD_CELLS];    // Blocks with NaN / Inf / runaway state, cell reset
+
+} guard_stats;
+
+extern guard_stats dsp_guard;  // Defined once, in guard.c
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Float bits //////////////////////////////////////////////////////////////////////////
+static inline uint32_t guard_bits(float x)
+{
+    uint32_t u;
+    memcpy(&u, &x, sizeof u);
+    return u;
+}
+
+static inline bool guard_finite(float x)
+{
+    return (guard_bits(x) & 0x7F800000u) != 0x7F800000u;
+}
+
+// Nonzero and below GUARD_TINY, subnormals included
+static inline bool guard_tiny(float x)
+{
+    uint32_t m = guard_bits(x) & 0x7FFFFFFFu;
+    return m != 0 && m < GUARD_TINY_BITS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Per block, after the cell rendered it ///////////////////////////////////////////////
+bool guard_ltfskf(ltfskf* o);
+bool guard_ltoskf(ltoskf* o);
+bool guard_svflto(ltosvf* o);
+bool guard_dcblock(dcblock* o);
+bool guard_limiter(limiter* o);
+
+// n: samples delay_process wrote since the last call, at most DELAY_LENGTH; a NaN
+// clears the whole line
+bool guard_delay(delay* o, unsigned n);
+
+// Reset to the init state, keeping the step size t
+bool guard_roessler(roessler* o);
+bool guard_hopf(hopf* o);
+bool guard_helmholz(helmholz* o);
+
+void guard_clear(void);
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Flush-to-zero for the calling thread ////////////////////////////////////////////////
+static inline void dsp_flush_denormals(void)
+{
+#if PICO_ON_DEVICE && !defined(__ARM_FP)
+    // RP2040: no FPU, the SDK float functions flush subnormals already
+#elif defined(__SSE__) || defined(_M_X64)
+    _mm_setcsr(_mm_getcsr() | 0x8040);  // FTZ | DAZ
+#elif defined(__aarch64__)
+    uint64_t fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr | (1u << 24)));
+#elif defined(__ARM_FP)
+    uint32_t fpscr;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    __asm__ volatile("vmsr fpscr, %0" : : "r"(fpscr | (1u << 24)));
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
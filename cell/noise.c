@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Noise
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "noise.h"
+
+void noise_init(noise* o, uint32_t seed)
+{
+    memset(o, 0, sizeof(noise));
+    prng_seed(&o->rng, seed);
+    // Start with every row drawn, so the spectrum is pink from the first sample
+    for (unsigned k = 0; k < NOISE_PINK_ROWS; k++)
+    {
+        o->row[k] = noise_term(o);
+        o->sum   += o->row[k];
+    }
+    o->last = o->sum;
+}
+
+void CELL_HOT(noise_white_render)(noise* o, float* out, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = noise_white(o);
+}
+
+void CELL_HOT(noise_pink_render)(noise* o, float* out, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = noise_pink(o);
+}
+
+void CELL_HOT(noise_blue_render)(noise* o, float* out, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) out[i] = noise_blue(o);
+}
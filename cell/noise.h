@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Noise
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// White, pink and blue noise at audio rate from one prng (random.h) per instance.
+//
+// white  uniform, -1 < 1
+// pink   -3 dB/oct, Voss-McCartney: NOISE_PINK_ROWS random rows, row k redrawn every
+//        2^(k+1) samples, summed with a fresh white term. Integer only, one row per
+//        sample, so the cost does not grow with the number of rows. Falls 3.0 to 3.6 dB
+//        per octave down to sample_rate / 2^(NOISE_PINK_ROWS + 1) (11 Hz at 44.1 kHz).
+// blue   +3 dB/oct, the first difference of the pink sum
+//
+// Outputs peak at +-1; the RMS is about 0.58 (white), 0.17 (pink) and 0.29 (blue).
+// The same seed renders the same noise.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include "context.h"
+#include "random.h"
+
+#define NOISE_PINK_ROWS  11
+#define NOISE_PINK_BITS  26   // Bits per term; NOISE_PINK_ROWS + 1 terms stay below 2^30
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    prng     rng;
+    uint32_t count;                   // Sample counter, its trailing zeros pick the row
+    int32_t  row[NOISE_PINK_ROWS];
+    int32_t  sum;                     // Sum of row[]
+    int32_t  last;                    // Previous pink output, for blue
+
+} noise;
+
+void noise_init(noise* o, uint32_t seed);
+
+static inline float noise_white(noise* o)
+{
+    return prng_bipolar(&o->rng);
+}
+
+static inline int32_t noise_term(noise* o)
+{
+    return (int32_t)prng_next(&o->rng) >> (32 - NOISE_PINK_BITS);
+}
+
+// Pink sum before scaling
+static inline int32_t noise_pink_raw(noise* o)
+{
+    uint32_t c = ++o->count;
+    if (c)
+    {
+        unsigned k = __builtin_ctz(c);
+        if (k < NOISE_PINK_ROWS)
+        {
+            int32_t v = noise_term(o);
+            o->sum += v - o->row[k];
+            o->row[k] = v;
+        }
+    }
+    return o->sum + noise_term(o);
+}
+
+static inline float noise_pink(noise* o)
+{
+    return noise_pink_raw(o) * (1.0f / ((NOISE_PINK_ROWS + 1) << (NOISE_PINK_BITS - 1)));
+}
+
+static inline float noise_blue(noise* o)
+{
+    int32_t p = noise_pink_raw(o);
+    int32_t d = p - o->last;
+    o->last = p;
+    // One row and the white term change per sample, so |d| < 2^(NOISE_PINK_BITS + 1)
+    return d * (1.0f / (1 << (NOISE_PINK_BITS + 1)));
+}
+
+void noise_white_render(noise* o, float* out, unsigned n);
+void noise_pink_render(noise* o, float* out, unsigned n);
+void noise_blue_render(noise* o, float* out, unsigned n);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Oscillator
+// V.0.3.7 2022-06-15
+////////////////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+#include "oscillator.h"
+
+void (*form[OSC_FORMS])(oscillator*) =
+{
+    oSine,          // 0
+    oRamp,          // 1
+    oSawtooth,      // 2
+    oSquare,        // 3
+    oTomisawa,      // 4
+    oTriangle       // 5
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+void oscillator_init(oscillator* o)
+{ 
+    o->nharm = 8;
+    o->phase = 0;
+    o->amplitude = 1.0f;
+    o->fm   = 0.0f;
+    o->am   = 0.0f;
+    o->pwm  = 0.0f;
+    o->warp = 0.0f;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////
+void set_delta(oscillator* o, const float Hz)
+{ 
+    o->frequency = Hz;
+    o->delta = o->frequency * TAO * dsp_ctx.inv_rate; 
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Wavetables //////////////////////////////////////////////////////////////////////////
+void oSineWT(oscillator* o)
+{
+    float delta = o->delta;
+    float x = o->amplitude * cosf(o->phase);
+    float y = o->amplitude * sinf(o->phase);
+    float cs = cosf(delta);
+    float sn = sinf(delta);
+
+    for(int i = 1; i < o->width; ++i)
+    {
+        delta = x;
+        x = cs*x - sn*y;     // x = samples of a*cos(2*pi*f*t + p)
+        y = sn*delta + cs*y; // y = samples of a*sin(2*pi*f*t + p)
+        o->data[i] = y;
+    }
+}
+
+void oParabolWT(oscillator* o)
+{
+    float amp = o->amplitude;
+    int m = dsp_ctx.sample_rate/(2.0 * o->frequency);
+    int a = -m;
+    int b = 0;
+
+    amp *= 4.0 / (float)(m*m);
+    for(int i = 0; i < o->width; i++)
+    {
+        if( i%m == 0 ) 
+        { 
+            a+=m; 
+            b+=m; 
+            amp=-amp; 
+        }
+        o->data[i] = amp * (i-a) * (i-b);
+    }
+}
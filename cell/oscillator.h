@@ -9,14 +9,16 @@
 #define WAVE_TABLE_LENGTH 2048
 #endif
 
-#ifndef SAMPLE_RATE 
-#define SAMPLE_RATE 44100
-#endif
+#include "context.h"
 ////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////
 #define TAO 6.283185307179586476925f
 #define PI  3.141592653589793238462f
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 typedef struct
 {
@@ -39,49 +41,23 @@ typedef struct
 
 ////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////
-void oscillator_init(oscillator* o)
-{ 
-    o->nharm = 8;
-    o->phase = 0;
-    o->amplitude = 1.0f;
-    o->fm   = 0.0f;
-    o->am   = 0.0f;
-    o->pwm  = 0.0f;
-    o->warp = 0.0f;
-}
+void oscillator_init(oscillator* o);
 
 ////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////
-void set_delta(oscillator* o, const float Hz)
-{ 
-    o->frequency = Hz;
-    o->delta = o->frequency * TAO / SAMPLE_RATE; 
-}
+void set_delta(oscillator* o, const float Hz);
 
 
 /////////////////////////////////////////////////
 // 1D ///////////////////////////////////////////
-void oSine(oscillator*);
-void oRamp(oscillator*);
-void oSawtooth(oscillator*);
-void oSquare(oscillator*);
-void oTomisawa(oscillator*);
-void oTriangle(oscillator*);
-
-
-void (*form[])(oscillator*) = 
-{    
-    oSine,          // 0
-    oRamp,          // 1
-    oSawtooth,      // 2
-    oSquare,        // 3
-    oTomisawa,      // 4
-    oTriangle       // 5
-};
+#define OSC_FORMS 6
+
+// oSine, oRamp, oSawtooth, oSquare, oTomisawa, oTriangle; defined in oscillator.c
+extern void (*form[OSC_FORMS])(oscillator*);
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Waveforms: VCO //////////////////////////////////////////////////////////////////////
-void oSine(oscillator* o)
+static inline void CELL_HOT(oSine)(oscillator* o)
 {       
     o->out = sinf(o->phase) * o->amplitude;
     o->phase += o->delta + o->fm;
@@ -89,59 +65,27 @@ void oSine(oscillator* o)
 }
 
 
-void oSineWT(oscillator* o)
-{
-    float delta = o->delta;
-    float x = o->amplitude * cosf(o->phase);
-    float y = o->amplitude * sinf(o->phase);
-    float cs = cosf(delta);
-    float sn = sinf(delta);
-
-    for(int i = 1; i < o->width; ++i)
-    {
-        delta = x;
-        x = cs*x - sn*y;     // x = samples of a*cos(2*pi*f*t + p)
-        y = sn*delta + cs*y; // y = samples of a*sin(2*pi*f*t + p)
-        o->data[i] = y;
-    }
-}
+// Fill o->data (o->width samples)
+void oSineWT(oscillator* o);
 
-void oParabolWT(oscillator* o)
-{
-    float amp = o->amplitude;
-    int m = SAMPLE_RATE/(2.0 * o->frequency);
-    int a = -m;
-    int b = 0;
-
-    amp *= 4.0 / (float)(m*m);
-    for(int i = 0; i < o->width; i++)
-    {
-        if( i%m == 0 ) 
-        { 
-            a+=m; 
-            b+=m; 
-            amp=-amp; 
-        }
-        o->data[i] = amp * (i-a) * (i-b);
-    }
-}
+void oParabolWT(oscillator* o);
 
 
-void oRamp(oscillator* o) 
+static inline void CELL_HOT(oRamp)(oscillator* o)
 {
     o->out = o->phase/PI * o->amplitude;
     o->phase += o->delta + o->fm;
     if(o->phase >= PI) o->phase -= TAO;
 }
 
-void oSawtooth(oscillator* o) 
+static inline void CELL_HOT(oSawtooth)(oscillator* o)
 {
     o->out = - o->phase/PI * o->amplitude;
     o->phase += o->delta + o->fm;
     if(o->phase >= PI) o->phase -= TAO;
 }
 
-void oSquare(oscillator* o)
+static inline void CELL_HOT(oSquare)(oscillator* o)
 {
     float saw  =  o->phase/PI;
     float ramp =   -o->eax/PI;
@@ -156,7 +100,7 @@ void oSquare(oscillator* o)
 }
 
 
-void oTomisawa(oscillator* o)
+static inline void CELL_HOT(oTomisawa)(oscillator* o)
 {
     o->ecx = 1.0f;                  
     o->ecx *= 1.0f * (1 - 0.0001f * o->frequency); 
@@ -165,15 +109,15 @@ void oTomisawa(oscillator* o)
     o->phase += o->delta + o->fm;                
     if(o->phase >= PI) o->phase -= TAO;             
 
-    float oa = cos(o->phase + o->ecx * o->eax); 
+    float oa = cosf(o->phase + o->ecx * o->eax); 
     o->eax = 0.5f*(oa + o->eax);        
 
-    float ob = cos(o->phase + o->ecx * o->ebx + (o->pwm * 1.9f + 0.05f) * PI); 
+    float ob = cosf(o->phase + o->ecx * o->ebx + (o->pwm * 1.9f + 0.05f) * PI); 
     o->ebx = 0.5f * (ob + o->ebx);            
     o->out = (oa - ob) * o->amplitude;
 }
 
-void oTriangle(oscillator* o)
+static inline void CELL_HOT(oTriangle)(oscillator* o)
 {
     float rise = o->pwm * TAO;
     float fall = TAO - rise;
@@ -181,11 +125,14 @@ void oTriangle(oscillator* o)
     float fall_delta = (fall != 0.0f) ? (2.0f * o->amplitude / fall) : 0.0f;
 
     if (o->phase > TAO) o->phase -= TAO;
-    if (o->phase < rise) o->out = - o->amplitude + sqrt(o->phase) * rise_delta;
-    else o->out = o->amplitude - (sqrt(o->phase) - rise) * fall_delta;
+    if (o->phase < rise) o->out = - o->amplitude + sqrtf(o->phase) * rise_delta;
+    else o->out = o->amplitude - (sqrtf(o->phase) - rise) * fall_delta;
     o->phase += o->delta + o->fm;
 }
 
+#ifdef __cplusplus
+}
+#endif
 
 // void oGinger(oscillator* o)     // Add warp ????
 // {
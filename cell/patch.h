@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Patch
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Plain data description of a signal graph (see graph.h). Types only, so it can be
+// included anywhere and a patch can be stored or received as a flat struct.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+
+#define PATCH_MAX_NODES  16
+#define PATCH_MAX_INPUTS 2
+#define PATCH_MAX_PARAMS 4
+#define PATCH_NONE       (-1)
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Node kinds and their parameters /////////////////////////////////////////////////////
+typedef enum
+{
+    PATCH_OSC = 0,   // param: Hz, pw 0 < 1, form index, amplitude
+    PATCH_LTFSKF,    // in0;      param: cutoff Hz, Q
+    PATCH_LTOSKF,    // in0;      param: cutoff Hz, Q
+    PATCH_SVFLTO,    // in0;      param: cutoff Hz, Q (low pass output)
+    PATCH_DELAY,     // in0;      param: time 0 .. 1, feedback, amount
+    PATCH_LIMITER,   // in0;      param: threshold
+    PATCH_DCB,       // in0
+    PATCH_GAIN,      // in0;      param: gain
+    PATCH_MIX,       // in0, in1; param: crossfade (1 = in0)
+    PATCH_ROESSLER,  // param: step, output scale
+    PATCH_HOPF,      // param: step, output scale
+    PATCH_HELMHOLZ,  // param: step, output scale
+    PATCH_KINDS
+
+} patch_kind;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Control inputs a parameter can be bound to //////////////////////////////////////////
+typedef enum
+{
+    PATCH_CTL_FREQ = 0,
+    PATCH_CTL_PW,
+    PATCH_CTL_CUTOFF,
+    PATCH_CTL_Q,
+    PATCH_CTL_AMP,
+    PATCH_CTLS
+
+} patch_ctl;
+
+typedef struct
+{
+    uint8_t kind;                     // patch_kind
+    int8_t  in[PATCH_MAX_INPUTS];     // Source node index or PATCH_NONE
+    int8_t  bind[PATCH_MAX_PARAMS];   // patch_ctl driving the parameter or PATCH_NONE
+    float   param[PATCH_MAX_PARAMS];  // Initial parameter values
+
+} patch_node;
+
+typedef struct
+{
+    uint8_t    count;                 // Nodes in use
+    int8_t     output;                // Node feeding the output
+    patch_node node[PATCH_MAX_NODES];
+
+} patch;
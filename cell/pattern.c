@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Pattern
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "pattern.h"
+
+void pattern_clr(pattern* p)
+{
+    memset(p, 0, sizeof(pattern));
+    for (unsigned t = 0; t < PATTERN_TRACKS; t++)
+        memset(p->track[t].prob, 0xFF, sizeof(p->track[t].prob));
+    p->length = PATTERN_STEPS;
+    p->next   = PATTERN_LOOP;
+    p->repeat = 1;
+}
+
+void pattern_set(pattern_track* t, unsigned step, bool gate, bool tie, unsigned prob, unsigned ratchet, int note)
+{
+    if (step >= PATTERN_STEPS) return;
+    uint16_t bit = 1u << step;
+    t->gate = gate ? t->gate | bit : t->gate & ~bit;
+    t->tie  = tie  ? t->tie  | bit : t->tie  & ~bit;
+
+    if (prob > PATTERN_ALWAYS) prob = PATTERN_ALWAYS;
+    unsigned ps = (step & 1) * 4;
+    t->prob[step >> 1] = (t->prob[step >> 1] & ~(0xF << ps)) | (prob << ps);
+
+    ratchet = ratchet < 1 ? 0 : ratchet > 4 ? 3 : ratchet - 1;
+    unsigned rs = (step & 3) * 2;
+    t->ratchet[step >> 2] = (t->ratchet[step >> 2] & ~(3 << rs)) | (ratchet << rs);
+
+    t->note[step] = note < -128 ? -128 : note > 127 ? 127 : note;
+}
+
+void pattern_player_init(pattern_player* o, const pattern* bank, unsigned count, int step_length)
+{
+    memset(o, 0, sizeof(pattern_player));
+    o->bank        = bank;
+    o->count       = count;
+    o->step_length = step_length;
+    prng_seed(&o->rng, 0);
+}
+
+void pattern_player_start(pattern_player* o, unsigned index, uint32_t time)
+{
+    if (index >= o->count) return;
+    o->current   = index;
+    o->step      = 0;
+    o->plays     = 0;
+    o->next_time = time;
+    o->running   = true;
+}
+
+void pattern_player_stop(pattern_player* o)
+{
+    o->running = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Post one step of every track starting at time ///////////////////////////////////////
+static void pattern_post(pattern_player* o, scheduler* s, const pattern* p, uint32_t time, int length)
+{
+    unsigned step = o->step;
+    for (unsigned i = 0; i < PATTERN_TRACKS; i++)
+    {
+        const pattern_track* t = &p->track[i];
+        uint8_t bit = 1u << i;
+        if (o->mute & bit) continue;
+
+        unsigned prob = pattern_prob(t, step);
+        if (pattern_gate(t, step) && (prob == PATTERN_ALWAYS || (prng_next(&o->rng) >> 28) <= prob))
+        {
+            unsigned r = pattern_ratchet(t, step);
+            int sub = length / r;
+            sched_post(s, time, SCHED_NOTE, i, t->note[step]);
+            for (unsigned k = 0; k < r; k++)
+            {
+                sched_post(s, time + k * sub, SCHED_GATE, i, 1.0f);
+                if (r > 1) sched_post(s, time + k * sub + sub / 2, SCHED_GATE, i, 0.0f);
+            }
+            o->held = r > 1 ? o->held & ~bit : o->held | bit;
+        }
+        else if (!pattern_tie(t, step) && (o->held & bit))
+        {
+            sched_post(s, time, SCHED_GATE, i, 0.0f);
+            o->held &= ~bit;
+        }
+    }
+}
+
+void pattern_schedule(pattern_player* o, scheduler* s, unsigned n)
+{
+    if (!o->running || o->count == 0) return;
+    int length = o->step_length > 0 ? o->step_length : 1;
+    uint32_t end = s->now + n;
+    while ((int32_t)(o->next_time - end) < 0)
+    {
+        const pattern* p = &o->bank[o->current];
+        uint32_t swing = (o->step & 1) ? (uint32_t)length * p->swing / 512 : 0;
+        pattern_post(o, s, p, o->next_time + swing, length);
+        o->next_time += length;
+
+        unsigned steps = p->length < 1 ? 1 : p->length > PATTERN_STEPS ? PATTERN_STEPS : p->length;
+        if (++o->step < steps) continue;
+        o->step = 0;
+        if (++o->plays < (p->repeat ? p->repeat : 1)) continue;
+        o->plays = 0;
+        if (p->next < o->count) o->current = p->next;
+    }
+}
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Pattern
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Multi-track step patterns and a player that turns them into scheduler events.
+//
+// A pattern is PATTERN_TRACKS tracks of PATTERN_STEPS steps, bit-packed to 132 bytes,
+// so a bank of 30 fits in 4 KB of SRAM or sits in flash as const data. Per step and
+// track:
+//
+//   gate     1 bit   trigger a note
+//   tie      1 bit   no gate: hold the previous note instead of releasing it
+//   prob     4 bits  chance of the trigger, (prob + 1) / 16; 15 always plays
+//   ratchet  2 bits  1 to 4 triggers spread over the step, each released halfway
+//   note     8 bits  semitones, signed
+//
+// Per pattern: length in steps, swing (odd steps start swing / 512 of a step late),
+// and chaining: after repeat plays the player continues with pattern next.
+//
+// The player runs on the scheduler's sample clock (scheduler.h), not on the control
+// loop: pattern_schedule posts every step that starts in the next n samples, one
+// SCHED_GATE / SCHED_NOTE pair per track and trigger with target = track, at the
+// sample the step (or ratchet) starts on. A step costs O(PATTERN_TRACKS).
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "scheduler.h"
+#include "random.h"
+
+#define PATTERN_STEPS   16
+#define PATTERN_TRACKS  4
+#define PATTERN_LOOP    0xFF   // next: repeat the pattern itself
+#define PATTERN_ALWAYS  15     // prob: every time
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint16_t gate;                        // Bit s: step s triggers
+    uint16_t tie;                         // Bit s: step s holds the previous note
+    uint8_t  prob[PATTERN_STEPS / 2];     // 4 bits per step
+    uint8_t  ratchet[PATTERN_STEPS / 4];  // 2 bits per step, triggers - 1
+    int8_t   note[PATTERN_STEPS];         // Semitones
+
+} pattern_track;
+
+typedef struct
+{
+    pattern_track track[PATTERN_TRACKS];
+    uint8_t length;  // Steps played, 1 to PATTERN_STEPS
+    uint8_t swing;   // Delay of odd steps in 1/512 step
+    uint8_t next;    // Pattern after this one, index into the bank or PATTERN_LOOP
+    uint8_t repeat;  // Plays before moving to next
+
+} pattern;
+
+typedef struct
+{
+    const pattern* bank;
+    uint8_t  count;        // Patterns in bank
+    uint8_t  current;      // Pattern playing
+    uint8_t  step;         // Next step to post
+    uint8_t  plays;        // Completed plays of current
+    uint8_t  mute;         // Bit t: track t posts nothing
+    uint8_t  held;         // Bit t: track t has a note on
+    int      step_length;  // Samples per step, may change at any time
+    uint32_t next_time;    // Sample clock of the next step on the straight grid
+    prng     rng;          // Probability draws, reseed for a different take
+    bool     running;
+
+} pattern_player;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Packed fields ///////////////////////////////////////////////////////////////////////
+static inline bool pattern_gate(const pattern_track* t, unsigned s)
+{
+    return (t->gate >> s) & 1;
+}
+
+static inline bool pattern_tie(const pattern_track* t, unsigned s)
+{
+    return (t->tie >> s) & 1;
+}
+
+static inline unsigned pattern_prob(const pattern_track* t, unsigned s)
+{
+    return (t->prob[s >> 1] >> ((s & 1) * 4)) & 0xF;
+}
+
+static inline unsigned pattern_ratchet(const pattern_track* t, unsigned s)
+{
+    return ((t->ratchet[s >> 2] >> ((s & 3) * 2)) & 3) + 1;
+}
+
+// Rests everywhere, prob always, one trigger per step, 16 steps, no swing, loops
+void pattern_clr(pattern* p);
+
+void pattern_set(pattern_track* t, unsigned step, bool gate, bool tie, unsigned prob, unsigned ratchet, int note);
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Player //////////////////////////////////////////////////////////////////////////////
+void pattern_player_init(pattern_player* o, const pattern* bank, unsigned count, int step_length);
+
+// Play bank[index] from its first step, starting at sample time
+void pattern_player_start(pattern_player* o, unsigned index, uint32_t time);
+
+void pattern_player_stop(pattern_player* o);
+
+// Post the steps starting in the next n samples of s
+void pattern_schedule(pattern_player* o, scheduler* s, unsigned n);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Random
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// xorshift32 (Marsaglia): one word of state, three shifts and three xors a number, no
+// multiply, so it costs the same on the M0+ as a table lookup. PCG would need a
+// 64-bit multiply per number, several calls into libgcc on this core. Period 2^32 - 1;
+// the low bits are the weakest, so floats and ranges are taken from the high bits.
+//
+// Every user owns its prng and seeds it, so a render is reproducible from its seeds
+// and cores never share state. Unlike rand() there is no lock and no global.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t s;
+
+} prng;
+
+// Any seed works, 0 included; nearby seeds give unrelated sequences
+static inline void prng_seed(prng* r, uint32_t seed)
+{
+    // murmur3 finalizer, a bijection, so only one seed maps to the forbidden state 0
+    seed ^= seed >> 16; seed *= 0x85EBCA6Bu;
+    seed ^= seed >> 13; seed *= 0xC2B2AE35u;
+    seed ^= seed >> 16;
+    r->s = seed ? seed : 0x9E3779B9u;
+}
+
+static inline uint32_t prng_next(prng* r)
+{
+    uint32_t x = r->s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    r->s = x;
+    return x;
+}
+
+// 0 <= x < n, n <= 2^16 (top bits times n, no division)
+static inline unsigned prng_range(prng* r, unsigned n)
+{
+    return ((prng_next(r) >> 16) * n) >> 16;
+}
+
+// 0 <= x < 1; the mantissa is filled directly, one float subtract and no conversion
+static inline float prng_float(prng* r)
+{
+    union { uint32_t i; float f; } u = { 0x3F800000u | (prng_next(r) >> 9) };
+    return u.f - 1.0f;
+}
+
+// -1 <= x < 1
+static inline float prng_bipolar(prng* r)
+{
+    union { uint32_t i; float f; } u = { 0x40000000u | (prng_next(r) >> 9) };
+    return u.f - 3.0f;
+}
+
+#ifdef __cplusplus
+}
+#endif
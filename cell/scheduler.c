@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Scheduler
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "scheduler.h"
+
+void sched_init(scheduler* s)
+{
+    memset(s, 0, sizeof(scheduler));
+}
+
+void sched_clr(scheduler* s)
+{
+    s->count = 0;
+}
+
+bool sched_post(scheduler* s, uint32_t time, uint8_t type, uint8_t target, float value)
+{
+    if (s->count == SCHED_LENGTH)
+    {
+        s->dropped++;
+        return false;
+    }
+    if ((int32_t)(time - s->now) < 0)
+    {
+        s->late++;
+        time = s->now;
+    }
+    // Behind every event due later, ahead of those due at the same time or earlier
+    unsigned i = s->count;
+    while (i > 0 && (int32_t)(s->ev[i - 1].time - time) <= 0) i--;
+    memmove(&s->ev[i + 1], &s->ev[i], (s->count - i) * sizeof(sched_event));
+    s->ev[i].time   = time;
+    s->ev[i].type   = type;
+    s->ev[i].target = target;
+    s->ev[i].value  = value;
+    s->count++;
+    return true;
+}
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Scheduler
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Timestamped events on the sample clock. The clock counts rendered samples, so an
+// event lands on the sample it was posted for however late the control loop runs.
+// grib.c paces the render to the audio buffers and plays every rendered sample once,
+// so there the clock keeps the rate of the DAC, a fixed few blocks ahead of it.
+// A render splits its block at the event times:
+//
+//   while (n)
+//   {
+//       while (sched_pop(&s, &e)) apply(&e);   // Everything due at s.now
+//       unsigned m = sched_span(&s, n);        // Samples up to the next event
+//       render(out, m);
+//       sched_advance(&s, m);
+//       out += m;
+//       n   -= m;
+//   }
+//
+// Events are kept sorted, latest first, so popping is a decrement; posting moves at
+// most SCHED_LENGTH events. Events with the same time pop in the order they were
+// posted. Times wrap after 2^32 samples (27 hours at 44.1 kHz) and are compared as
+// differences, so only the next 2^31 samples can be addressed.
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SCHED_LENGTH
+#define SCHED_LENGTH 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    SCHED_GATE = 0,  // value: 0 off, 1 on
+    SCHED_NOTE,      // value: semitones from the played frequency
+    SCHED_PARAM      // target: patch_ctl (patch.h), value: new control value
+
+} sched_type;
+
+typedef struct
+{
+    uint32_t time;    // Sample clock
+    uint8_t  type;    // sched_type
+    uint8_t  target;
+    float    value;
+
+} sched_event;
+
+typedef struct
+{
+    sched_event ev[SCHED_LENGTH];  // Sorted by time, latest first
+    unsigned    count;
+    uint32_t    now;               // Samples rendered so far, each played once in grib.c
+    uint32_t    dropped;           // Posts refused, queue full
+    uint32_t    late;              // Events posted for a time already rendered
+
+} scheduler;
+
+void sched_init(scheduler* s);
+
+// Queue an event; one for a time already rendered is applied at the next block start
+// and counted in late. Returns false if the queue is full.
+bool sched_post(scheduler* s, uint32_t time, uint8_t type, uint8_t target, float value);
+
+// Drop all pending events, the clock keeps running
+void sched_clr(scheduler* s);
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Next event due at s->now ////////////////////////////////////////////////////////////
+static inline bool sched_pop(scheduler* s, sched_event* e)
+{
+    if (s->count == 0 || (int32_t)(s->ev[s->count - 1].time - s->now) > 0) return false;
+    *e = s->ev[--s->count];
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Samples before the next event, at most n ////////////////////////////////////////////
+static inline unsigned sched_span(const scheduler* s, unsigned n)
+{
+    if (s->count == 0) return n;
+    int32_t d = (int32_t)(s->ev[s->count - 1].time - s->now);
+    return d > 0 && (unsigned)d < n ? (unsigned)d : n;
+}
+
+static inline void sched_advance(scheduler* s, unsigned n)
+{
+    s->now += n;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+#include "sequencer.h"
+
+void init_sequence(sequencer* o, int l)
+{
+    o->departed = 0;
+    o->current  = 0;
+    o->length   = l;
+}
+
+void genRand(sequencer* o, prng* r)
+{
+    for(int i = 0; i < STEPS; i++)
+    {
+        o->gate[i] = prng_next(r) >> 31;
+    }
+}
+
+static void sequence_post(sequencer* o, scheduler* s, uint32_t time)
+{
+    if (o->gate[o->current] != 2) sched_post(s, time, SCHED_GATE, 0, o->gate[o->current]);
+    sched_post(s, time, SCHED_NOTE, 0, o->note[o->current]);
+}
+
+void sequence_schedule(sequencer* o, scheduler* s, unsigned n)
+{
+    int length = o->length > 0 ? o->length : 1;
+    // departed is 0 only before the first step was posted
+    if (o->departed == 0) sequence_post(o, s, s->now);
+    int t = length - o->departed;      // Offset of the next step, < 0 if length shrank
+    if (t < 0) t = 0;
+    while ((unsigned)t < n)
+    {
+        o->current++;
+        if (o->current == STEPS) o->current = 0;
+        sequence_post(o, s, s->now + t);
+        t += length;
+    }
+    o->departed = length - (t - (int)n);
+}
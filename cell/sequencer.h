@@ -1,6 +1,12 @@
 #pragma once
 #define STEPS 16
 #include <math.h>
+#include "scheduler.h"
+#include "random.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 typedef struct
 {
@@ -13,14 +19,9 @@ typedef struct
 
 } sequencer;
 
-void init_sequence(sequencer* o, int l)
-{
-    o->departed = 0;
-    o->current  = 0;
-    o->length   = l;
-}
+void init_sequence(sequencer* o, int l);
 
-void process_sequence(sequencer* o)
+static inline void process_sequence(sequencer* o)
 {
     o->departed++;
     if(o->departed == o->length) 
@@ -31,21 +32,25 @@ void process_sequence(sequencer* o)
     }
 }
 
-int get_gate(sequencer* o)
+static inline int get_gate(sequencer* o)
 {
     return o->gate[o->current];
 }
 
-int get_note(sequencer* o)
+static inline int get_note(sequencer* o)
 {
     return o->note[o->current];
 }
 
 
-void genRand(sequencer* o)
-{
-    for(int i = 0; i < STEPS; i++)
-    {
-        o->gate[i] = rand()&1;
-    }
-}
\ No newline at end of file
+// Random gates, on or off, drawn from r
+void genRand(sequencer* o, prng* r);
+
+// Post the gate and note of every step starting in the next n samples of s, at the
+// sample the step starts on, and move the sequencer to the end of those n samples.
+// Takes the place of n process_sequence calls; hold steps (gate 2) post no gate.
+void sequence_schedule(sequencer* o, scheduler* s, unsigned n);
+
+#ifdef __cplusplus
+}
+#endif
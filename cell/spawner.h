@@ -1,4 +1,5 @@
 #pragma once
+#include <stdbool.h>
 #include "oscillator.h"
 #include "sequencer.h"
 #include "utility.h"
@@ -20,12 +21,12 @@ typedef struct
 
 } spawner;
 
-void spawner_init(spawner* o)
+static inline void spawner_init(spawner* o)
 {
     oscillator_init(&o->osc);
 }
 
-void spawn(spawner* o)
+static inline void spawn(spawner* o)
 {
     form[o->waveform[0]](&o->osc);
     o->feed = o->osc.out * o->cvs[0];
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Tables
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// constexpr generators for tables.h. libm is not constexpr, so exp is evaluated
+// here in double by range reduction and a Taylor series; the definitions are
+// constexpr, so a generator that cannot be evaluated at compile time fails the build.
+////////////////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+#include "tables.h"
+
+namespace {
+
+constexpr double LN2_D = 0.69314718055994530942;
+
+constexpr double cx_round(double x)
+{
+    return x < 0.0 ? -(double)(long long)(-x + 0.5) : (double)(long long)(x + 0.5);
+}
+
+constexpr double cx_exp(double x)
+{
+    double k = cx_round(x / LN2_D);
+    double r = x - k * LN2_D;
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 20; n++)
+    {
+        term *= r / n;
+        sum  += term;
+    }
+    for (; k > 0; k--) sum *= 2.0;
+    for (; k < 0; k++) sum *= 0.5;
+    return sum;
+}
+
+constexpr double cx_tanh(double x)
+{
+    return 1.0 - 2.0 / (cx_exp(2.0 * x) + 1.0);
+}
+
+template<typename T, unsigned N, typename F>
+constexpr T generate(F f)
+{
+    T t{};
+    for (unsigned i = 0; i < N; i++) t.v[i] = (float)f(i);
+    return t;
+}
+
+} // namespace
+
+#if TABLE_EXP2_IN_RAM
+#define TABLE_EXP2_PLACE __not_in_flash("tables")
+#else
+#define TABLE_EXP2_PLACE __in_flash("tables")
+#endif
+#if TABLE_TANH_IN_RAM
+#define TABLE_TANH_PLACE __not_in_flash("tables")
+#else
+#define TABLE_TANH_PLACE __in_flash("tables")
+#endif
+
+extern "C" {
+
+TABLE_EXP2_PLACE constexpr table_exp2_t table_exp2 =
+    generate<table_exp2_t, TABLE_EXP2_LENGTH + 1>([](unsigned i)
+    {
+        return cx_exp(LN2_D * i / TABLE_EXP2_LENGTH);
+    });
+
+TABLE_TANH_PLACE constexpr table_tanh_t table_tanh =
+    generate<table_tanh_t, TABLE_TANH_LENGTH + 1>([](unsigned i)
+    {
+        return cx_tanh(TABLE_TANH_RANGE * (2.0 * i / TABLE_TANH_LENGTH - 1.0));
+    });
+
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Tables
+// V.0.1.0 2026-10-19
+// MIT License
+// Copyright (c) 2022 unmanned
+////////////////////////////////////////////////////////////////////////////////////////
+// Lookup tables computed by the compiler (constexpr, tables.cpp) and linked as const
+// data, so there is no startup loop and nothing to initialise.
+//
+// Placement policy: a table goes to flash (read through the XIP cache, no SRAM) unless
+// it is read per sample in the render, where an XIP miss costs more than the SRAM.
+// Hot tables are placed in .data, which the runtime copies to SRAM with the rest of
+// the initialised data before main. Override with TABLE_<NAME>_IN_RAM 0/1.
+//
+//   table       entries  bytes  read                         default
+//   table_exp2  257      1028   per control change (pitch)    flash
+//   table_tanh  257      1028   per sample (saturation)       SRAM
+////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include "pico.h"
+
+#define TABLE_EXP2_LENGTH 256   // One octave, 2^(i / TABLE_EXP2_LENGTH), plus the guard point
+#define TABLE_TANH_LENGTH 256   // tanh over +-TABLE_TANH_RANGE, plus the guard point
+#define TABLE_TANH_RANGE  4.0f
+
+#ifndef TABLE_EXP2_IN_RAM
+#define TABLE_EXP2_IN_RAM 0
+#endif
+#ifndef TABLE_TANH_IN_RAM
+#define TABLE_TANH_IN_RAM 1
+#endif
+
+typedef struct { float v[TABLE_EXP2_LENGTH + 1]; } table_exp2_t;
+typedef struct { float v[TABLE_TANH_LENGTH + 1]; } table_tanh_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const table_exp2_t table_exp2;
+extern const table_tanh_t table_tanh;
+
+#ifdef __cplusplus
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// 2^x, relative error below 1e-5 //////////////////////////////////////////////////////
+static inline float table_exp2f(float x)
+{
+    float fl = floorf(x);
+    float f  = (x - fl) * TABLE_EXP2_LENGTH;
+    int   i  = (int)f;
+    // x just below an integer: x - fl rounds to 1 and f to TABLE_EXP2_LENGTH
+    if (i > TABLE_EXP2_LENGTH - 1) i = TABLE_EXP2_LENGTH - 1;
+    float y  = table_exp2.v[i] + (f - i) * (table_exp2.v[i + 1] - table_exp2.v[i]);
+    return ldexpf(y, (int)fl);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// tanh, linear interpolation, clamps beyond the range (|error| < 7e-4 at the clamp) ///
+static inline float table_tanhf(float x)
+{
+    float f = (x + TABLE_TANH_RANGE) * (TABLE_TANH_LENGTH / (2.0f * TABLE_TANH_RANGE));
+    if (!(f > 0.0f))            return -1.0f;  // NaN too
+    if (f >= TABLE_TANH_LENGTH) return  1.0f;
+    int i = (int)f;
+    return table_tanh.v[i] + (f - i) * (table_tanh.v[i + 1] - table_tanh.v[i]);
+}
@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// Utilities
+// V.0.3.8 2022-07-22
+// MIT License
+// Copyright (c) 2022 unmanned
+/////////////////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+#include "utility.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// DC Block filter //////////////////////////////////////////////////////////////////////
+void dcblock_clr(dcblock* o)
+{
+    o->eax = 0.0f;
+    o->ebx = 0.0f;
+}
+
+float dcb(float in)
+{
+    static dcblock o;
+    return dcblock_process(&o, in);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Dynamic smoothing self modulating filter /////////////////////////////////////////////
+void init_dssmf(dssmf* o)
+{
+    o->frequency = 2.0f;
+    o->sensivity = 2.0f;
+    for (int r = 0; r < NRATES; r++)
+    {
+        o->w = o->frequency / dsp_rates[r];
+        o->u = tanf(PI*o->w);
+        o->v[r] = 2.0f * o->u / (1.0f + o->u);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Linear trap SVF //////////////////////////////////////////////////////////////////////
+void svflto_clr(ltosvf* o)
+{
+    o->ic1eq = 0.0f;
+    o->ic2eq = 0.0f;
+}
+
+void svflto_init(ltosvf* o, float cutoff, float Q)
+{
+    o->g = tanf(PI * cutoff * dsp_ctx.inv_rate);
+    o->k = 1.0f/Q;
+    o->a = 1.0f/(1.0f + o->g*(o->g + o->k));
+    o->b = o->g * o->a;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Linear trap SKF //////////////////////////////////////////////////////////////////////
+void ltoskf_clr(ltoskf* o)
+{
+    o->ic1eq = 0.0f;
+    o->ic2eq = 0.0f;
+}
+
+void ltoskf_init(ltoskf* o, float cutoff, float Q)
+{
+    float g = tanf(PI * cutoff * dsp_ctx.inv_rate);
+    o->k  = Q;
+    o->a0 = 1.0f/((1.0f + g)*(1.0f + g)-(g * o->k));
+    o->a1 = o->k * o->a0;
+    o->a2 = (1.0 + g) * o->a0;
+    o->a3 = g * o->a2;
+    o->a4 = 1.0f/(1.0f + g);
+    o->a5 = g * o->a4;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Linear trap SKF, fast ////////////////////////////////////////////////////////////////
+void ltfskf_clr(ltfskf* o)
+{
+    o->ic1eq = 0.0f;
+    o->ic2eq = 0.0f;
+}
+
+void ltfskf_init(ltfskf* o, float cutoff, float Q)
+{
+    float w  = PI * cutoff * dsp_ctx.inv_rate;
+    float s1 = sinf(w);
+    float s2 = sinf(2.0f * w);
+    float nrm = 1.0f / (2.f + Q * s2);
+    o->g0 = s2 * nrm;
+    o->g1 = (-2.f * s1 * s1 - Q * s2) * nrm;
+    o->g2 = (2.0f * s1 * s1) * nrm;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// One pole LP parameter smooth filter //////////////////////////////////////////////////
+void psf_init(psf* o, float time, float sample_rate)
+{
+    o->a = expf(-TAO / (time * 0.001f * sample_rate));
+    o->b = 1.0f - o->a;
+    o->o = 0.0f;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+float CELL_HOT(allpass)(float in, float a)
+{
+    static float y;
+    float out = y + a * in;
+    y = in - a * out;
+    return out;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+void snh_init(snh* o)
+{
+    o->t = 0;
+    o->value = 0.0f;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Envelope follower ////////////////////////////////////////////////////////////////////
+void ef_init(ef* o, float aMs, float rMs)
+{
+    o->envelope = 0.0f;
+    for (int i = 0; i < NRATES; i++)
+    {
+        o->a[i] = pow( 0.01, 1.0 / ( aMs * dsp_rates[i] * 0.001 ) );
+        o->r[i] = pow( 0.01, 1.0 / ( rMs * dsp_rates[i] * 0.001 ) );
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Limiter //////////////////////////////////////////////////////////////////////////////
+void limiter_init(limiter* o, float aMs, float rMs, float threshold)
+{
+    ef_init(&o->e, aMs, rMs);
+    o->threshold = threshold;
+}
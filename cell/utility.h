@@ -6,23 +6,38 @@
 /////////////////////////////////////////////////////////////////////////////////////////
 
 #pragma once
-#ifndef SAMPLE_RATE 
-#define SAMPLE_RATE 44100
-#endif
+#include <math.h>
+#include "context.h"
+#include "tables.h"
 #define PI  3.141592653589793238462f
 #define TAO 6.283185307179586476925f
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////
 // DC Block filter //////////////////////////////////////////////////////////////////////
 
-float dcb(float in)
+typedef struct
 {
-    static float eax, ebx;
-    ebx = in - eax + 0.995 * ebx;
-    eax = in;
-    return ebx;
+    float eax;
+    float ebx;
+
+} dcblock;
+
+void dcblock_clr(dcblock* o);
+
+static inline float CELL_HOT(dcblock_process)(dcblock* o, float in)
+{
+    o->ebx = in - o->eax + 0.995f * o->ebx;
+    o->eax = in;
+    return o->ebx;
 }
 
+// Shared instance
+float dcb(float in);
+
 /////////////////////////////////////////////////////////////////////////////////////////
 // Dynamic smoothing self modulating filter /////////////////////////////////////////////
 // https://cytomic.com/files/dsp/DynamicSmoothing.pdf ///////////////////////////////////
@@ -33,7 +48,7 @@ typedef struct
     float sensivity;
     float w;
     float u;
-    float v;
+    float v[NRATES];
 
     float eax;
     float ebx;
@@ -42,26 +57,19 @@ typedef struct
 
 } dssmf;
 
-void init_dssmf(dssmf* o)
-{
-    o->frequency = 2.0f;
-    o->sensivity = 2.0f;
-    o->w = o->frequency / SAMPLE_RATE;
-    o->u = tanf(PI*o->w);
-    o->v = 2.0f * o->u / (1.0f + o->u);
-}
+void init_dssmf(dssmf* o);
 
-float minimum(float a, float b) 
+static inline float CELL_HOT(minimum)(float a, float b)
 {
     return b > a ? a : b;
 }
 
-float process_dssmf(dssmf* o, float in)
+static inline float CELL_HOT(process_dssmf)(dssmf* o, float in)
 {
     o->ecx = o->eax;
     o->edx = o->ebx;
     float b = o->ecx - o->edx;
-    float g = minimum(o->v + o->sensivity * fabsf(b), 1.0f);
+    float g = minimum(o->v[dsp_ctx.rate] + o->sensivity * fabsf(b), 1.0f);
     o->eax = o->ecx + g*(in - o->ecx);
     o->ebx = o->edx + g*(o->eax - o->edx);
     return o->ebx;
@@ -86,21 +94,11 @@ typedef struct
 
 } ltosvf;
 
-void svflto_clr(ltosvf* o)
-{
-    o->ic1eq = 0.0f;
-    o->ic2eq = 0.0f;
-}
+void svflto_clr(ltosvf* o);
 
-void svflto_init(ltosvf* o, float cutoff, float Q)
-{
-    o->g = tanf(PI * cutoff / SAMPLE_RATE);
-    o->k = 1.0f/Q;
-    o->a = 1.0f/(1.0f + o->g*(o->g + o->k));
-    o->b = o->g * o->a;
-}
+void svflto_init(ltosvf* o, float cutoff, float Q);
 
-float svflto_process(ltosvf* o, float in)
+static inline float CELL_HOT(svflto_process)(ltosvf* o, float in)
 {
     float va = o->a*o->ic1eq + o->b*(in - o->ic2eq);
     float vb = o->ic2eq + o->g*va;
@@ -112,6 +110,7 @@ float svflto_process(ltosvf* o, float in)
     o->notch = o->low + o->high;
     o->peak  = o->low - o->high;
     o->all   = o->low + o->high - o->k*o->band;
+    return o->low;
 }
 
 
@@ -126,27 +125,12 @@ typedef struct
 
 } ltoskf;
 
-void ltoskf_clr(ltoskf* o)
-{
-    o->ic1eq = 0.0f;
-    o->ic2eq = 0.0f;
-}
-
+void ltoskf_clr(ltoskf* o);
 
-void ltoskf_init(ltoskf* o, float cutoff, float Q)
-{
-    float g = tanf(PI * cutoff / SAMPLE_RATE);
-    o->k  = Q;
-    o->a0 = 1.0f/((1.0f + g)*(1.0f + g)-(g * o->k));
-    o->a1 = o->k * o->a0;
-    o->a2 = (1.0 + g) * o->a0;
-    o->a3 = g * o->a2;
-    o->a4 = 1.0f/(1.0f + g);
-    o->a5 = g * o->a4;
 
-}
+void ltoskf_init(ltoskf* o, float cutoff, float Q);
 
-float ltoskf_process(ltoskf* o, float in)
+static inline float CELL_HOT(ltoskf_process)(ltoskf* o, float in)
 {
     float v1 = o->a1 * o->ic2eq + o->a2*o->ic1eq + o->a3*in;
     float v2 = o->a4 * o->ic2eq + o->a5 * v1;
@@ -166,24 +150,11 @@ typedef struct
 
 } ltfskf;
 
-void ltfskf_clr(ltfskf* o)
-{
-    o->ic1eq = 0.0f;
-    o->ic2eq = 0.0f;
-}
+void ltfskf_clr(ltfskf* o);
 
-void ltfskf_init(ltfskf* o, float cutoff, float Q)
-{
-    float w  = PI * cutoff / SAMPLE_RATE;
-    float s1 = sinf(w);
-    float s2 = sinf(2.0f * w);
-    float nrm = 1.0f / (2.f + Q * s2);
-    o->g0 = s2 * nrm;
-    o->g1 = (-2.f * s1 * s1 - Q * s2) * nrm;
-    o->g2 = (2.0f * s1 * s1) * nrm;
-}
+void ltfskf_init(ltfskf* o, float cutoff, float Q);
 
-float ltfskf_process(ltfskf* o, float in)
+static inline float CELL_HOT(ltfskf_process)(ltfskf* o, float in)
 {
     float t0 = in - o->ic2eq;
     float t1 = o->g0 * t0 + o->g1 * o->ic1eq;
@@ -204,14 +175,9 @@ typedef struct
 
 } psf;
 
-void psf_init(psf* o, float time, float sample_rate)
-{
-    o->a = expf(-TAO / (time * 0.001f * sample_rate));
-    o->b = 1.0f - o->a;
-    o->o = 0.0f;
-}
+void psf_init(psf* o, float time, float sample_rate);
 
-float psf_process(psf* o, float in)
+static inline float CELL_HOT(psf_process)(psf* o, float in)
 {
     o->o = (in * o->b) + (o->o * o->a);
     return o->o;
@@ -219,13 +185,8 @@ float psf_process(psf* o, float in)
 
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
-float allpass(float in, float a)
-{
-    static float y;
-    float out = y + a * in;
-    y = in - a * out;
-    return out;
-}    
+// Shared state
+float allpass(float in, float a);    
 
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -236,13 +197,9 @@ typedef struct
 
 } snh;
 
-void snh_init(snh* o)
-{
-    o->t = 0;
-    o->value = 0.0f;
-}
+void snh_init(snh* o);
 
-float snh_process(snh* o, float input, int time)
+static inline float CELL_HOT(snh_process)(snh* o, float input, int time)
 {
     if (o->t>time)
     {
@@ -255,22 +212,23 @@ float snh_process(snh* o, float input, int time)
 
 /////////////////////////////////////////////////////////////////////////////////////////
 // Crossfader: f == 1? a = max; f==0? b = max ///////////////////////////////////////////
-float crossfade(float a, float b, float f)
+static inline float CELL_HOT(crossfade)(float a, float b, float f)
 {
     return a * f + b * ( 1.0f - f);
 }
 
 
 /////////////////////////////////////////////////////////////////////////////////////////
-float saturate(float in, float gain, float drive, float mix)
+// tanh from table_tanh (tables.h), in SRAM for this per sample use
+static inline float CELL_HOT(saturate)(float in, float gain, float drive, float mix)
 {
-    return crossfade(sinf(tanhf(in * (gain+0.02f)*20.0f) * (drive*1.5f+1.0f)), in, mix);
+    return crossfade(sinf(table_tanhf(in * (gain+0.02f)*20.0f) * (drive*1.5f+1.0f)), in, mix);
 }
 
 
 /////////////////////////////////////////////////////////////////////////////////////////
 // Departed samples to milliseconds /////////////////////////////////////////////////////
-inline float DStoMS(float samples, float sample_rate)
+static inline float DStoMS(float samples, float sample_rate)
 {
     return samples*1000.0f/sample_rate;
 }
@@ -280,24 +238,19 @@ inline float DStoMS(float samples, float sample_rate)
 // Envelope follower ////////////////////////////////////////////////////////////////////
 typedef struct
 {
-    float a;
-    float r;
+    float a[NRATES];
+    float r[NRATES];
     float envelope;
 
 } ef;
 
-void ef_init(ef* o, float aMs, float rMs)
-{
-    o->envelope = 0.0f;
-    o->a = pow( 0.01, 1.0 / ( aMs * SAMPLE_RATE * 0.001 ) );
-    o->r = pow( 0.01, 1.0 / ( rMs * SAMPLE_RATE * 0.001 ) );
-}
+void ef_init(ef* o, float aMs, float rMs);
 
-void ef_process(ef* o, float in)
+static inline void CELL_HOT(ef_process)(ef* o, float in)
 {
-    float f = fabs(in);
-    if (f > o->envelope) o->envelope = o->a * ( o->envelope - f ) + f;
-    else                 o->envelope = o->r * ( o->envelope - f ) + f;
+    float f = fabsf(in);
+    if (f > o->envelope) o->envelope = o->a[dsp_ctx.rate] * ( o->envelope - f ) + f;
+    else                 o->envelope = o->r[dsp_ctx.rate] * ( o->envelope - f ) + f;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -310,14 +263,10 @@ typedef struct
 } limiter;
 
 
-void limiter_init(limiter* o, float aMs, float rMs, float threshold)
-{
-    ef_init(&o->e, aMs, rMs);
-    o->threshold = threshold;
-}
+void limiter_init(limiter* o, float aMs, float rMs, float threshold);
 
 
-float limit(limiter* o, float in)
+static inline float CELL_HOT(limit)(limiter* o, float in)
 {
     float out = in;
     ef_process(&o->e, in);
@@ -329,4 +278,8 @@ float limit(limiter* o, float in)
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Golden: canonical renders of the DSP cells for output regression
+////////////////////////////////////////////////////////////////////////////////////
+// Separate firmware (grib_golden), like grib_bench. Every scenario starts from
+// freshly initialised cells and renders GOLDEN_LENGTH samples at 44.1 kHz; the
+// result is printed on stdio as
+//
+//   GOLDEN-BEGIN
+//   # osc_sine 2048
+//   <samples, 8 per line>
+//   ...
+//   GOLDEN-END
+//
+// tools/golden.py stores a capture as reference files (tools/golden/*.f32) and
+// reports max abs error, RMS error and spectral difference of later captures per
+// scenario. Builds for the host as well (PICO_PLATFORM=host); references taken on
+// the host only compare against host captures, float libm differs from the board.
+// The checked in references are host renders: the golden test (test/CMakeLists.txt)
+// runs the host build against them.
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "arena.h"
+#include "cell/utility.h"
+#include "cell/oscillator.h"
+#include "cell/delay.h"
+#include "voice.h"
+////////////////////////////////////////////////////////////////////////////////////
+#define GOLDEN_LENGTH  2048
+#define GOLDEN_WAIT_MS 3000     // Time to attach a terminal
+#define SWEEP_BLOCK    16       // Filter coefficients are recomputed every block, divides GOLDEN_LENGTH
+
+static float out[GOLDEN_LENGTH];
+static float* delay_line;
+
+////////////////////////////////////////////////////////////////////////////////////
+// Oscillators: 440 Hz, pulse width 0.25 ///////////////////////////////////////////
+static void osc_render(void (*f)(oscillator*), float* y, unsigned n)
+{
+    oscillator o;
+    oscillator_init(&o);
+    o.eax = PI;
+    o.pwm = 0.25f;
+    set_delta(&o, 440.0f);
+    for (unsigned i = 0; i < n; i++) { f(&o); y[i] = o.out; }
+}
+
+static void osc_sine    (float* y, unsigned n) { osc_render(oSine,     y, n); }
+static void osc_ramp    (float* y, unsigned n) { osc_render(oRamp,     y, n); }
+static void osc_sawtooth(float* y, unsigned n) { osc_render(oSawtooth, y, n); }
+static void osc_square  (float* y, unsigned n) { osc_render(oSquare,   y, n); }
+static void osc_tomisawa(float* y, unsigned n) { osc_render(oTomisawa, y, n); }
+static void osc_triangle(float* y, unsigned n) { osc_render(oTriangle, y, n); }
+
+////////////////////////////////////////////////////////////////////////////////////
+// Filter sweeps: 110 Hz sawtooth, cutoff 40 Hz -> 12 kHz exponentially ////////////
+static float sweep_cutoff(unsigned i, unsigned n)
+{
+    return 40.0f * powf(300.0f, (float)i / n);
+}
+
+static void sweep_source(float* y, unsigned n)
+{
+    oscillator o;
+    oscillator_init(&o);
+    set_delta(&o, 110.0f);
+    for (unsigned i = 0; i < n; i++) { oSawtooth(&o); y[i] = o.out * 0.5f; }
+}
+
+static void sweep_ltfskf(float* y, unsigned n)
+{
+    ltfskf f;
+    ltfskf_clr(&f);
+    sweep_source(y, n);
+    for (unsigned b = 0; b < n; b += SWEEP_BLOCK)
+    {
+        ltfskf_init(&f, sweep_cutoff(b, n), 0.5f);
+        for (unsigned i = b; i < b + SWEEP_BLOCK; i++) y[i] = ltfskf_process(&f, y[i]);
+    }
+}
+
+static void sweep_ltoskf(float* y, unsigned n)
+{
+    ltoskf f;
+    ltoskf_clr(&f);
+    sweep_source(y, n);
+    for (unsigned b = 0; b < n; b += SWEEP_BLOCK)
+    {
+        ltoskf_init(&f, sweep_cutoff(b, n), 1.5f);
+        for (unsigned i = b; i < b + SWEEP_BLOCK; i++) y[i] = ltoskf_process(&f, y[i]);
+    }
+}
+
+static void sweep_svflto(float* y, unsigned n)
+{
+    ltosvf f;
+    svflto_clr(&f);
+    sweep_source(y, n);
+    for (unsigned b = 0; b < n; b += SWEEP_BLOCK)
+    {
+        svflto_init(&f, sweep_cutoff(b, n), 2.0f);
+        for (unsigned i = b; i < b + SWEEP_BLOCK; i++) y[i] = svflto_process(&f, y[i]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Limiter: 440 Hz sine driven from 0 to 4x full scale //////////////////////////////
+static void limiter_drive(float* y, unsigned n)
+{
+    limiter l;
+    limiter_init(&l, 0.5f, 3.0f, 0.5f);
+    osc_render(oSine, y, n);
+    for (unsigned i = 0; i < n; i++) y[i] = limit(&l, y[i] * 4.0f * i / n);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Delay: 64 sample burst into 0.01 * DELAY_LENGTH with feedback 0.9 ///////////////
+static void delay_feedback(float* y, unsigned n)
+{
+    delay d;
+    delay_init(&d, delay_line);
+    d.time     = 0.01f;
+    d.feedback = 0.9f;
+    d.amount   = 0.5f;
+    osc_render(oSine, y, n);
+    for (unsigned i = 0; i < n; i++) y[i] = delay_process(&d, i < 64 ? y[i] : 0.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// The default voice: voice_render (voice.cpp), as the synth plays it //////////////
+static void voice_chain(float* y, unsigned n)
+{
+    // Fresh from voice_init in main, which has to come before arena_seal
+    voice_params p;
+    p.freq   = 110.0f;
+    p.pw     = 0.5f;
+    p.cutoff = 2000.0f;
+    p.Q      = 0.3f;
+    p.amp    = 0.8f;
+    p.note   = 0.0f;
+    p.gate   = 1.0f;
+    voice_render(&p, y, n);
+}
+
+typedef struct
+{
+    const char* name;
+    void (*render)(float* y, unsigned n);
+
+} golden_scenario;
+
+static const golden_scenario scenarios[] =
+{
+    { "osc_sine",       osc_sine },
+    { "osc_ramp",       osc_ramp },
+    { "osc_sawtooth",   osc_sawtooth },
+    { "osc_square",     osc_square },
+    { "osc_tomisawa",   osc_tomisawa },
+    { "osc_triangle",   osc_triangle },
+    { "sweep_ltfskf",   sweep_ltfskf },
+    { "sweep_ltoskf",   sweep_ltoskf },
+    { "sweep_svflto",   sweep_svflto },
+    { "limiter_drive",  limiter_drive },
+    { "delay_feedback", delay_feedback },
+    { "voice_chain",    voice_chain },
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main()
+{
+    stdio_init_all();
+#if PICO_ON_DEVICE
+    sleep_ms(GOLDEN_WAIT_MS);
+#endif
+
+    dsp_set_rate(RATE_44K1);
+    delay_line = ARENA_NEW_ARRAY(ARENA_DSP, float, DELAY_LENGTH);
+    voice_init();
+    arena_seal();
+
+    printf("GOLDEN-BEGIN\n");
+    for (const golden_scenario& s : scenarios)
+    {
+        s.render(out, GOLDEN_LENGTH);
+        printf("# %s %d\n", s.name, GOLDEN_LENGTH);
+        for (unsigned i = 0; i < GOLDEN_LENGTH; i++)
+        {
+            printf("%.9g%c", out[i], (i % 8 == 7) ? '\n' : ' ');
+        }
+    }
+    printf("GOLDEN-END\n");
+
+#if PICO_ON_DEVICE
+    while (true)
+    {
+        tight_loop_contents();
+    }
+#else
+    return 0;
+#endif
+}
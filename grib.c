@@ -1,6 +1,8 @@
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "hardware/pll.h"
 #include "hardware/gpio.h"
@@ -8,6 +10,12 @@
 // #include "hardware/structs/clocks.h"
 #include "pico/stdlib.h"
 #include "pico/audio_i2s.h"
+#include "arena.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "midi.h"
+#include "preset.h"
+#include "replay.h"
 #include "pico/multicore.h"
 #include "4051.h"
 #include "hardware/adc.h"
@@ -15,16 +23,31 @@
 #include "cell/utility.h"
 #include "cell/delay.h"
 #include "cell/containers.h"
-#include "cell/oscillator.h"
+#include "cell/tables.h"
 #include "pico-ss-oled/include/ss_oled.h"
-#include "cell/sequencer.h"
+#include "cell/pattern.h"
 #include "cell/envelope.h"
+#include "cell/guard.h"
+#include "voice.h"
+#include "synth.h"
+#include "latency.h"
+#include "xip.h"
 ////////////////////////////////////////////////////////////////////////////////////
 // Globals /////////////////////////////////////////////////////////////////////////
-#define WAVE_TABLE_LENGTH   2048
-#define SAMPLES_PER_BUFFER  1156
+#define SAMPLES_PER_BUFFER  1156    // Frames per producer buffer, and per render
+#define RENDER_BLOCKS       2       // Renders waiting for i2s_callback_func, at most
 #define SAMPLE_RATE         44100
 #define LAG4051             1
+#define UNDERRUN_FADE       64      // Frames faded out/in around a missed buffer
+#define TELEMETRY_DRAIN     8       // Telemetry records streamed per loop
+#define TELEMETRY_PARAMS    16      // Loops between parameter records
+#define LATENCY_DEADBAND    32      // ADC counts a knob has to move to start a latency probe
+#define MIDI_UART_INDEX     1       // MIDI in on uart1 RX
+#define MIDI_RX_PIN         9
+#define MIDI_STDIO_BYTES    64      // USB CDC bytes read per loop, MIDI and console keys
+#define MIDI_NOTE_BASE      60      // MIDI note played at the frequency knob
+#define MIDI_BEND_RANGE     2.0f    // Semitones at full pitch bend
+// #define DEBUG_UNDERRUN          // Button A drops the next 4 buffers to audition the underrun policy
 ////////////////////////////////////////////////////////////////////////////////////
 #define BUTTON_C 17
 #define BUTTON_B 18
@@ -45,22 +68,60 @@
 SSOLED oled;
 static wavering cbuffer;
 static const uint32_t PIN_DCDC_PSM_CTRL = 23;
-static int16_t wave_table   [WAVE_TABLE_LENGTH];
+// The main loop renders one producer buffer per pass into wave_table, i2s_callback_func
+// copies each render into a buffer once. blocks_rendered is only written by the loop,
+// blocks_played only by the callback, so the loop waits for a free block and the
+// sample clock (cell/scheduler.h) counts exactly the samples handed to the DAC.
+static float   wave_table   [RENDER_BLOCKS][SAMPLES_PER_BUFFER];
+static volatile uint32_t blocks_rendered;
+static volatile uint32_t blocks_played;
 audio_buffer_pool_t *ap;
 
+static audio_format_t audio_format = 
+{
+        .pcm_format = AUDIO_PCM_FORMAT_S32,
+        .sample_freq = SAMPLE_RATE,
+        .channel_count = 2
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+// Master bus //////////////////////////////////////////////////////////////////////
+// Runs in place on every S32 stereo buffer the I2S DMA takes, after the voice or
+// patch, so patches without a DCB node still reach the DAC without offset.
+// DC blocker with the pole at 1 - 2^-10 (~7 Hz at 44.1 kHz); shifts only, as it
+// runs in the DMA IRQ.
+typedef struct
+{
+    int32_t x1[2];
+    int32_t y1[2];
+
+} master_bus;
+
+static master_bus master;
+
+static void master_process(audio_effect_t *effect, audio_buffer_t *buffer)
+{
+    master_bus *m = (master_bus *) effect->user_data;
+    int32_t *samples = (int32_t *) buffer->buffer->bytes;
+    for (uint i = 0; i < buffer->sample_count * 2; i++)
+    {
+        uint c = i & 1;
+        int32_t x = samples[i] >> 1; // Headroom for the overshoot
+        int32_t y = x - m->x1[c] + m->y1[c] - (m->y1[c] >> 10);
+        if (y >  0x3FFFFFFF) y =  0x3FFFFFFF;
+        if (y < -0x40000000) y = -0x40000000;
+        m->x1[c] = x;
+        m->y1[c] = y;
+        samples[i] = y * 2;
+    }
+}
 
+static audio_effect_t master_effect = { .process = master_process, .user_data = &master };
 
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 audio_buffer_pool_t *init_audio() 
 {
-    static audio_format_t audio_format = 
-    {
-            .pcm_format = AUDIO_PCM_FORMAT_S32,
-            .sample_freq = SAMPLE_RATE,
-            .channel_count = 2
-    };
-
     static audio_buffer_format_t producer_format = 
     {
             .format = &audio_format,
@@ -89,6 +150,9 @@ audio_buffer_pool_t *init_audio()
 
     ok = audio_i2s_connect(producer_pool);
     assert(ok);
+    audio_insert_effect(producer_pool, &master_effect);
+    audio_insert_effect(producer_pool, &latency_effect);
+    audio_i2s_set_underrun_policy(AUDIO_I2S_UNDERRUN_FADE, UNDERRUN_FADE);
     { 
         // initial buffer data
         audio_buffer_t *buffer = take_audio_buffer(producer_pool, true);
@@ -99,6 +163,7 @@ audio_buffer_pool_t *init_audio()
             samples[i*2+1] = 0;
         }
         buffer->sample_count = buffer->max_sample_count;
+        latency_produced(buffer->sample_count);
         give_audio_buffer(producer_pool, buffer);
     }
     audio_i2s_set_enabled(true);
@@ -116,49 +181,127 @@ static inline uint32_t _millis(void)
 
 static frame canvas;
 static float amp = 1.0f;
+
 ////////////////////////////////////////////////////////////////////////////////////
-// Core 1 interrupt Handler ////////////////////////////////////////////////////////
-void core1_interrupt_handler() 
+// Display on core 1 ///////////////////////////////////////////////////////////////
+// The main loop bumps display_pass once per pass; core 1 polls it and redraws. The
+// inter-core FIFO and SIO_IRQ_PROC1 belong to the flash lockout
+// (multicore_lockout_victim_init), whose handler parks core 1 from RAM with its
+// interrupts off while core 0 writes presets.
+static volatile uint32_t display_pass;
+
+static void display_update(void)
 {
-    // Receive Raw Value, Convert and Print Temperature Value
-    float k = SAMPLES_PER_BUFFER/OLED_WIDTH;
-    frame_init(&canvas, 128, 64);
-    // 
-    // 
-    while (multicore_fifo_rvalid())
+    TRACE_BEGIN("display");
+    char buf[10];
+    char rate[16];
+    char xrun[16];
+    audio_i2s_stats_t stats;
+    audio_i2s_underrun_t last;
+    audio_i2s_get_stats(&stats);
+    snprintf(buf, sizeof buf, "%f", amp);
+    snprintf(rate, sizeof rate, "%5d %3d%%", (int)dsp_ctx.sample_rate, (int)(dsp_ctx.load * 100.0f));
+    // Underrun count and the length of the latest one
+    if(audio_i2s_get_underruns(&last, 1)) snprintf(xrun, sizeof xrun, "U%lu %lums", (unsigned long)stats.underruns, (unsigned long)(last.duration_us / 1000));
+    else                                  snprintf(xrun, sizeof xrun, "U0");
+    // {
+    //     oledFill(&oled, 0,1);
+    //     for(int i = 0; i < OLED_WIDTH; i++)
+    //     {
+    //         oledPSET(&oled, i, wavering_get(&cbuffer)/0x80FFFF+OLED_HEIGHT/2, 0xFF);
+    //     }   
+    // }
+    oledWriteString(&oled, 0, 0, 0, "ABCDEFGHIJKLM", 1, 0, 1);
+    oledWriteString(&oled, 0, 0, 1, "NOPQRSTUVWXYZ", 1, 0, 1);
+    oledWriteString(&oled, 0, 0, 2, "[0.123456789]", 1, 1, 1);
+    oledWriteString(&oled, 0, 0, 3, buf, 1, 0, 1);
+    oledWriteString(&oled, 0, 0, 4, rate, 1, 0, 1);
+    oledWriteString(&oled, 0, 0, 5, xrun, 1, 0, 1);
+    TRACE_END("display");
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Patterns (synth.h); a recalled preset fills the idle bank, which then replaces ///
+// the playing one /////////////////////////////////////////////////////////////////
+static pattern bank[2][PRESET_PATTERNS];
+static int     bank_live;
+static_assert(SYNTH_PATTERNS <= PRESET_PATTERNS, "the pattern bank is stored in presets");
+
+////////////////////////////////////////////////////////////////////////////////////
+// Presets: knobs, pattern bank and patch in flash (preset/include/preset.h) ///////
+static preset_store_t presets;
+static preset_t       preset_buf;     // Staging for recall and save, kept off the stack
+static patch          loaded_patch;   // Patch the graph runs, saved with the preset
+
+////////////////////////////////////////////////////////////////////////////////////
+// Inputs: every 4051 channel and the buttons, one frame per loop //////////////////
+// The frames are recorded (replay/include/replay.h); 'r' on the console dumps them
+static void (* const set4051[REPLAY_CHANNELS])(unsigned) =
+{
+    set4051_0, set4051_1, set4051_2, set4051_3, set4051_4, set4051_5, set4051_6, set4051_7
+};
+
+static void scan_inputs(replay_frame_t* f)
+{
+    adc_select_input(2);
+    for(int c = 0; c < REPLAY_CHANNELS; c++)
     {
-        char buf[10];
-        snprintf(buf, sizeof buf, "%f", amp);
-        uint16_t raw = multicore_fifo_pop_blocking();   
-        // if(raw == 1)   
-        // {
-        //     oledFill(&oled, 0,1);
-        //     for(int i = 0; i < OLED_WIDTH; i++)
-        //     {
-        //         oledPSET(&oled, i, wavering_get(&cbuffer)/0x80FFFF+OLED_HEIGHT/2, 0xFF);
-        //     }   
-        // }
-        oledWriteString(&oled, 0, 0, 0, "ABCDEFGHIJKLM", 1, 0, 1);
-        oledWriteString(&oled, 0, 0, 1, "NOPQRSTUVWXYZ", 1, 0, 1);
-        oledWriteString(&oled, 0, 0, 2, "[0.123456789]", 1, 1, 1);
-        oledWriteString(&oled, 0, 0, 3, buf, 1, 0, 1);
+        set4051[c](LAG4051);
+        f->adc[c] = adc_read();
+    }
+    f->buttons = (gpio_get(BUTTON_A) ? SYNTH_BUTTON_A : 0)
+               | (gpio_get(BUTTON_B) ? SYNTH_BUTTON_B : 0)
+               | (gpio_get(BUTTON_C) ? SYNTH_BUTTON_C : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// MIDI: mono, last note priority, on the voice track; the first note mutes the ///
+// pattern on that track, start / stop run the pattern player /////////////////////
+static struct { int note; float bend; } midi_voice = { MIDI_NOTE_BASE, 0.0f };
 
+static void midi_play(const midi_message_t* m, scheduler* s, pattern_player* player, uint32_t time)
+{
+    if(midi_is_note_on(m))
+    {
+        player->mute |= 1u << VOICE_TRACK;
+        midi_voice.note = m->data[0];
+        sched_post(s, time, SCHED_NOTE, VOICE_TRACK, midi_voice.note - MIDI_NOTE_BASE + midi_voice.bend);
+        sched_post(s, time, SCHED_GATE, VOICE_TRACK, 1.0f);
     }
-    multicore_fifo_clear_irq(); // Clear interrupt
+    else if(midi_is_note_off(m))
+    {
+        if(m->data[0] == midi_voice.note) sched_post(s, time, SCHED_GATE, VOICE_TRACK, 0.0f);
+    }
+    else if((m->status & 0xF0) == MIDI_PITCH_BEND)
+    {
+        midi_voice.bend = midi_bend(m) * (MIDI_BEND_RANGE / 8192.0f);
+        sched_post(s, time, SCHED_NOTE, VOICE_TRACK, midi_voice.note - MIDI_NOTE_BASE + midi_voice.bend);
+    }
+    else if(m->status == MIDI_START) pattern_player_start(player, player->current, time);
+    else if(m->status == MIDI_STOP)  pattern_player_stop(player);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Core 1 Main Code ////////////////////////////////////////////////////////////////
 void core1_entry() 
 {
-    // Configure Core 1 Interrupt
-    multicore_fifo_clear_irq();
-    irq_set_exclusive_handler(SIO_IRQ_PROC1, core1_interrupt_handler);
-    irq_set_enabled(SIO_IRQ_PROC1, true);
-    // Infinte While Loop to wait for interrupt
+    // Parked from RAM while core 0 writes presets to flash; the only SIO_IRQ_PROC1 handler
+    multicore_lockout_victim_init();
+    uint32_t shown = display_pass;
     while (true)
     {
-        tight_loop_contents();
+        uint32_t pass = display_pass;
+        if(pass == shown)
+        {
+            tight_loop_contents();
+            continue;
+        }
+        // Passes that came and went during the last redraw are never drawn
+        uint32_t skipped = pass - shown - 1;
+        shown = pass;
+        uint32_t start = time_us_32();
+        display_update();
+        telemetry_display(TELEMETRY_CORE1, time_us_32() - start, skipped);
     }
 }
 
@@ -168,6 +311,11 @@ int main()
 {
     
     stdio_init_all();
+    // Allocations come from the arena and are single threaded, so before core 1 runs
+    frame_init(&canvas, OLED_WIDTH, OLED_HEIGHT);
+    // A repair after a power cut may erase flash; core 1 is not running yet
+    preset_backend_t flash = preset_flash_backend();
+    int preset_status = preset_mount(&presets, &flash);
     multicore_launch_core1(core1_entry);
 
     wavering_init(&cbuffer);
@@ -223,6 +371,10 @@ int main()
         96 * MHZ);
     // Reinit uart now that clk_peri has changed
     stdio_init_all();
+    // Binary records share the USB CDC port with stdio (tools/telemetry.py)
+    telemetry_set_transport(telemetry_usb_write, NULL);
+    // MIDI in; its baud divider also depends on clk_peri
+    midi_uart_init(MIDI_UART_INDEX, MIDI_RX_PIN);
     ////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////
     // DCDC PSM control
@@ -232,131 +384,243 @@ int main()
     gpio_set_dir(PIN_DCDC_PSM_CTRL, GPIO_OUT);
     gpio_put(PIN_DCDC_PSM_CTRL, 1); // PWM mode for less Audio noise
     ////////////////////////////////////////////////////////////////////////////////////
-    for (int i = 0; i < WAVE_TABLE_LENGTH; i++) 
-    {
-        wave_table[i] = 32767 * cosf(i * 2 * (float) (M_PI / WAVE_TABLE_LENGTH));
-    }
+    latency_init();
     ap = init_audio();
     ////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////
     ulong departed = 0;
-    #define NPSF 4
-    psf PSF[NPSF];
-    for(int i = 0; i < NPSF; i++)
-    {
-        psf_init(&PSF[i], 2, SAMPLE_RATE);
-    }
-
-    delay DD;
-    delay_init(&DD);
-
-    static ltfskf FF;
-    ltfskf_clr(&FF);
+    synth_controls controls;
+    synth_controls_init(&controls, SAMPLE_RATE);
 
     unsigned note = 1;
-    static oscillator osc;
-    oscillator_init(&osc);
+    // No-op on the RP2040, whose float library flushes subnormals already (cell/guard.h)
+    dsp_flush_denormals();
+    voice_init();
+    voice_params vp;
+    vp.note = 0.0f;
+    vp.gate = 0.0f;
+
+    // Everything is allocated; anything later is reported (or traps with ARENA_TRAP_LATE)
+    arena_seal();
+    arena_report();
+    if(preset_status != PRESET_OK) printf("presets: mount failed (%d), saving disabled\n", preset_status);
 
     // snh SNH;
     // snh_init(&SNH);
 
-    static limiter lim;
-    limiter_init(&lim, 0.5f, 3.0f, .5f);
-
-    static sequencer sq;
-    init_sequence(&sq, 1);
-    genRand(&sq);
+    // Steps become events on the sample they start on (cell/scheduler.h)
+    static scheduler sched;
+    static pattern_player player;
+    sched_init(&sched);
+    synth_patterns(bank[bank_live], SYNTH_PATTERN_SEED);
+    pattern_player_init(&player, bank[bank_live], SYNTH_PATTERNS, dsp_ctx.sample_rate / SYNTH_SEQUENCER_RATE);
+    pattern_player_start(&player, 0, sched.now);
 
     // envelope ar;
     // ar.a[0] = 1.0f;
     // ar.a[0] = 0.0f;
 
-    bool state_a;
-    bool state_b;
-    bool state_c;
+    bool patched = false;
+    uint32_t underrun_start = 0;
+    int knob_freq = 0;
+    int knob_cutoff = 0;
+    uint32_t midi_since = time_us_32();
+    unsigned preset_slot = 0;
+    unsigned recalled_held = 0;             // Bit per patch_ctl: recalled value holds until the knob turns
+    float    recalled_knob[PATCH_CTLS];
+    int      recalled_raw[PATCH_CTLS];
 
     ////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////
     while (true) 
     {
+        // One pass per producer buffer: wait until a rendered block has been played out
+        while(blocks_rendered - blocks_played >= RENDER_BLOCKS) tight_loop_contents();
         departed++;
-        if(gpio_get(BUTTON_A)) state_a = true; else state_a = false;
-        if(gpio_get(BUTTON_B)) state_b = true; else state_b = false;
-        if(gpio_get(BUTTON_C)) state_c = true; else state_c = false;
-
-        genRand(&sq);
-        init_sequence(&sq, adc_read());
         ////////////////////////////////////////////////////////////////////////////////////
-        // 4051 ////////////////////////////////////////////////////////////////////////////
-        adc_select_input(2);
-        set4051_0(LAG4051);
-        
-
-        set4051_1(LAG4051);
-        float a = (adc_read()-580)/3516.0f;
-        amp = a*a;
-
-        set4051_2(LAG4051);
-        int F = adc_read();
-
-        set4051_3(LAG4051);
-        float Q = (1.1f - psf_process(&PSF[1], adc_read())/4096.0f*1.05f);
-
-        set4051_4(LAG4051);
-        float pw = psf_process(&PSF[2], adc_read()/4096.0f);
-
-        set4051_5(LAG4051);
-        
-
-        set4051_6(LAG4051);
-        float freq = psf_process(&PSF[3], adc_read());
-
-        set4051_7(LAG4051);
-        float cutoff = psf_process(&PSF[0], adc_read());
+        // 4051 and buttons ////////////////////////////////////////////////////////////////
+        TRACE_BEGIN("controls");
+        replay_frame_t input;
+        input.time_us  = time_us_32();
+        input.reserved = 0;
+        scan_inputs(&input);
+        float knob[PATCH_CTLS];
+        unsigned pressed = synth_controls_map(&controls, &input, knob);
+#ifdef DEBUG_UNDERRUN
+        if(pressed & SYNTH_BUTTON_A) audio_i2s_inject_underruns(4);
+#endif
+        if(pressed & SYNTH_BUTTON_B)
+        {
+            // Toggle between the fixed voice and the patch graph
+            if(patched) { voice_unload_patch(); patched = false; }
+            else        { loaded_patch = synth_patch_chaos; patched = voice_load_patch(&loaded_patch) == 0; }
+        }
+        if(pressed & SYNTH_BUTTON_C)
+        {
+            // Next sample rate; the PIO is retuned on the next consumer take
+            dsp_set_rate((dsp_rate)((dsp_ctx.rate + 1) % NRATES));
+            audio_format.sample_freq = dsp_ctx.sample_rate;
+        }
+        int raw_freq   = input.adc[SYNTH_MUX_FREQ];
+        int raw_cutoff = input.adc[SYNTH_MUX_CUTOFF];
+        // A knob moved past the ADC noise: follow the change to the DMA
+        if(abs(raw_freq - knob_freq) > LATENCY_DEADBAND || abs(raw_cutoff - knob_cutoff) > LATENCY_DEADBAND)
+        {
+            knob_freq   = raw_freq;
+            knob_cutoff = raw_cutoff;
+            latency_stamp();
+        }
+        TRACE_END("controls");
         // osc.warp = adc_read()/4096.0f*0.9f;
         ////////////////////////////////////////////////////////////////////////////////////
         ////////////////////////////////////////////////////////////////////////////////////
         
-        osc.eax = PI;
-        osc.amplitude = 1.0f;
-        osc.pwm = (pw - 0.5f) * TAO;
-
-        set_delta(&osc, freq);
-
-        ltfskf_init(&FF, cutoff, Q);
-
-        for (int i = 0; i < WAVE_TABLE_LENGTH; i++) 
+        // A recalled value holds until its knob is turned (soft takeover)
+        int raw_ctl[PATCH_CTLS] = { raw_freq, input.adc[SYNTH_MUX_PW], raw_cutoff, input.adc[SYNTH_MUX_Q], input.adc[SYNTH_MUX_AMP] };
+        for(int i = 0; i < PATCH_CTLS; i++)
         {
-
-            form[3](&osc);
-            float out = osc.out*0.5f;
-            out = ltfskf_process(&FF, out);
-            out = limit(&lim, out);
-            out = dcb(out) * amp;
-
-            wave_table[i] = 32767.0f * out;
+            if(!(recalled_held & (1u << i))) continue;
+            if(abs(raw_ctl[i] - recalled_raw[i]) > LATENCY_DEADBAND) recalled_held &= ~(1u << i);
+            else knob[i] = recalled_knob[i];
         }
+        amp = knob[PATCH_CTL_AMP];
+
+        vp.freq   = knob[PATCH_CTL_FREQ];
+        vp.pw     = knob[PATCH_CTL_PW];
+        vp.cutoff = knob[PATCH_CTL_CUTOFF];
+        vp.Q      = knob[PATCH_CTL_Q];
+        vp.amp    = knob[PATCH_CTL_AMP];
+        // MIDI that arrived during the last block, at the same offset into this one
+        uint32_t midi_now = time_us_32();
+        midi_message_t m;
+        while(midi_take(&m, midi_now))
+            midi_play(&m, &sched, &player, sched.now + midi_offset(&m, midi_since, dsp_ctx.sample_rate, SAMPLES_PER_BUFFER));
+        midi_since = midi_now;
+        // Keeps the tempo across rate changes; the step in progress is not restarted
+        player.step_length = dsp_ctx.sample_rate / SYNTH_SEQUENCER_RATE;
+        pattern_schedule(&player, &sched, SAMPLES_PER_BUFFER);
+        TRACE_BEGIN("render");
+        xip_counters_clear();
+        uint32_t t0 = time_us_32();
+        voice_render_events(&vp, &sched, wave_table[blocks_rendered % RENDER_BLOCKS], SAMPLES_PER_BUFFER);
+        input.render_us = time_us_32() - t0;
+        dsp_ctx.load = input.render_us * 1e-6f * dsp_ctx.sample_rate / SAMPLES_PER_BUFFER;
+        xip_counters xip = xip_counters_read();
+        TRACE_END("render");
+        TRACE_COUNTER("xip misses", xip.misses);
+        latency_rendered();
+        // Hand the block to i2s_callback_func
+        __mem_fence_release();
+        blocks_rendered++;
+        TRACE_COUNTER("load %", dsp_ctx.load * 100.0f);
+        ////////////////////////////////////////////////////////////////////////////////////
+        // Telemetry ///////////////////////////////////////////////////////////////////////
+        telemetry_load(TELEMETRY_MAIN, dsp_ctx.load);
+        telemetry_xip(TELEMETRY_MAIN, xip.accesses, xip.misses);
+        if(departed % TELEMETRY_PARAMS == 0)
+        {
+            telemetry_param(TELEMETRY_MAIN, PATCH_CTL_FREQ,   vp.freq);
+            telemetry_param(TELEMETRY_MAIN, PATCH_CTL_PW,     vp.pw);
+            telemetry_param(TELEMETRY_MAIN, PATCH_CTL_CUTOFF, vp.cutoff);
+            telemetry_param(TELEMETRY_MAIN, PATCH_CTL_Q,      vp.Q);
+            telemetry_param(TELEMETRY_MAIN, PATCH_CTL_AMP,    vp.amp);
+        }
+        // Once per underrun, after it ended and its length is known
+        audio_i2s_underrun_t last;
+        if(audio_i2s_get_underruns(&last, 1) && last.start_us != underrun_start)
+        {
+            audio_i2s_stats_t stats;
+            audio_i2s_get_stats(&stats);
+            underrun_start = last.start_us;
+            telemetry_underrun(TELEMETRY_MAIN, stats.underruns, last.duration_us);
+        }
+        uint32_t copied_us, latency_us;
+        if(latency_poll(&copied_us, &latency_us)) telemetry_latency(TELEMETRY_MAIN, copied_us, latency_us);
+        telemetry_drain(TELEMETRY_DRAIN);
+        // Console: 'l' prints the latency histogram, 'g' the denormal / NaN guard counters (cell/guard.h),
+        // 't' dumps the trace rings (tools/trace2chrome.py), 'r' the recorded inputs (grib_replay_run).
+        // Keys share the USB port with MIDI (midi/include/midi.h)
+        int key = midi_stdio_poll(MIDI_STDIO_BYTES);
+        input.key = key < 0 ? REPLAY_NO_KEY : key;
+        replay_record(&input);
+        if(key == 'l') latency_report();
+        if(key == 'r') replay_dump();
+        if(key == 'g')
+            for(int i = 0; i < GUARD_CELLS; i++)
+                printf("guard %-8s flushed %lu reset %lu\n", guard_names[i],
+                       (unsigned long)dsp_guard.flushed[i], (unsigned long)dsp_guard.reset[i]);
+        // '0'..'9' recall a preset, swapped in before the next block; 's' saves to the last slot
+        if(key >= '0' && key <= '9')
+        {
+            preset_slot = key - '0';
+            if(preset_load(&presets, preset_slot, &preset_buf) == PRESET_OK)
+            {
+                int idle = bank_live ^ 1;
+                unsigned count = preset_buf.patterns;
+                if(count < 1 || count > PRESET_PATTERNS) count = 1;
+                memcpy(bank[idle], preset_buf.pattern, sizeof bank[idle]);
+                player.bank  = bank[idle];
+                player.count = count;
+                if(player.current >= count) player.current = 0;
+                bank_live = idle;
+
+                if(preset_buf.patched)
+                {
+                    loaded_patch = preset_buf.patch;
+                    patched = voice_load_patch(&loaded_patch) == 0;
+                }
+                else if(patched) { voice_unload_patch(); patched = false; }
+
+                memcpy(recalled_knob, preset_buf.knob, sizeof recalled_knob);
+                memcpy(recalled_raw, raw_ctl, sizeof recalled_raw);
+                recalled_held = (1u << PATCH_CTLS) - 1;
+            }
+        }
+        if(key == 's' && preset_status == PRESET_OK)
+        {
+            // Stalls the loop (and underruns) for the flash write
+            memcpy(preset_buf.knob, knob, sizeof preset_buf.knob);
+            preset_buf.patched  = patched;
+            preset_buf.patterns = player.count;
+            memcpy(preset_buf.pattern, bank[bank_live], sizeof preset_buf.pattern);
+            preset_buf.patch = loaded_patch;
+            printf("preset %u: save %d\n", preset_slot, preset_save(&presets, preset_slot, &preset_buf));
+        }
+#if GRIB_TRACE
+        if(key == 't') trace_dump();
+#endif
 
-        uint16_t raw = 1; //adc_read();
-        multicore_fifo_push_blocking(raw);
+        // Core 1 redraws once it sees the pass
+        display_pass++;
     }
-    delay_clr(&DD);
     return 0;
 }
 
 void i2s_callback_func()
 {
+    // Nothing new rendered: the pool drains and the underrun policy covers the gap,
+    // a block is never played twice
+    if (blocks_played == blocks_rendered) { TRACE_INSTANT("render late"); return; }
     audio_buffer_t *buffer = take_audio_buffer(ap, false);
-    if (buffer == NULL) { return; }
+    if (buffer == NULL) { TRACE_INSTANT("producer starved"); return; }
+    TRACE_BEGIN("i2s_callback");
+    __mem_fence_acquire();
     int32_t *samples = (int32_t *) buffer->buffer->bytes;
-    for (uint i = 0; i < buffer->max_sample_count; i++) 
-    {
-        samples[i*2+0] = wave_table[i]<<16u;  // L
-        samples[i*2+1] = wave_table[i]<<16u;  // R
-        if(i%0xF==0) wavering_set(&cbuffer, samples[i*2]);
-    }
+    // float straight to S32 stereo, saturating, in one pass
+    assert(buffer->max_sample_count == SAMPLES_PER_BUFFER);
+    audio_f32_to_s32_stereo(wave_table[blocks_played % RENDER_BLOCKS], samples, buffer->max_sample_count);
+    for (uint i = 0; i < buffer->max_sample_count; i += 0xF) wavering_set(&cbuffer, samples[i*2]);
+    // First frames of every buffer, left channel
+    int16_t scope[4];
+    for (uint i = 0; i < 4; i++) scope[i] = samples[i*2] >> 16;
+    telemetry_scope(TELEMETRY_IRQ, 0, scope);
     buffer->sample_count = buffer->max_sample_count;
+    latency_produced(buffer->sample_count);
     give_audio_buffer(ap, buffer);
+    // The block is copied, the loop may render over it
+    __mem_fence_release();
+    blocks_played++;
+    TRACE_END("i2s_callback");
     return;
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "latency.h"
+
+typedef enum
+{
+    PROBE_IDLE = 0,
+    PROBE_STAMPED,      // Waiting for the render
+    PROBE_RENDERED,     // Waiting for the producer
+    PROBE_QUEUED,       // Waiting for the consumer
+
+} probe_state;
+
+static volatile probe_state state;
+static uint32_t t_stamp;
+static uint32_t t_produced;
+static uint32_t target;         // Frame offset of the producer buffer carrying the change
+static uint32_t produced;       // Frames given by the producer
+static uint32_t consumed;       // Frames taken by the consumer
+static latency_stats stats;
+static volatile bool fresh;
+static uint32_t last_produced_us, last_total_us;
+
+void latency_init(void)
+{
+    state = PROBE_IDLE;
+    memset(&stats, 0, sizeof stats);
+    stats.min_us = UINT32_MAX;
+}
+
+void latency_stamp(void)
+{
+    if (state != PROBE_IDLE) return;
+    t_stamp = time_us_32();
+    state = PROBE_STAMPED;
+}
+
+void latency_rendered(void)
+{
+    if (state == PROBE_STAMPED) state = PROBE_RENDERED;
+}
+
+void latency_produced(uint32_t frames)
+{
+    if (state == PROBE_RENDERED)
+    {
+        t_produced = time_us_32();
+        target = produced;
+        state = PROBE_QUEUED;
+    }
+    produced += frames;
+}
+
+static void latency_process(audio_effect_t* effect, audio_buffer_t* buffer)
+{
+    (void)effect;
+    // Before the count: this buffer holds frames consumed .. consumed + sample_count
+    if (state == PROBE_QUEUED && (int32_t)(consumed + buffer->sample_count - target) > 0)
+    {
+        uint32_t us = time_us_32() - t_stamp;
+        uint32_t bin = us / LATENCY_BIN_US;
+        stats.bins[bin < LATENCY_BINS ? bin : LATENCY_BINS - 1]++;
+        stats.count++;
+        stats.sum_us += us;
+        stats.produced_sum_us += t_produced - t_stamp;
+        if (us < stats.min_us) stats.min_us = us;
+        if (us > stats.max_us) stats.max_us = us;
+        last_produced_us = t_produced - t_stamp;
+        last_total_us = us;
+        fresh = true;
+        state = PROBE_IDLE;
+    }
+    consumed += buffer->sample_count;
+}
+
+audio_effect_t latency_effect = { .process = latency_process };
+
+bool latency_poll(uint32_t* produced_us, uint32_t* total_us)
+{
+    uint32_t save = save_and_disable_interrupts();
+    bool r = fresh;
+    *produced_us = last_produced_us;
+    *total_us = last_total_us;
+    fresh = false;
+    restore_interrupts(save);
+    return r;
+}
+
+void latency_get(latency_stats* s)
+{
+    uint32_t save = save_and_disable_interrupts();
+    *s = stats;
+    restore_interrupts(save);
+}
+
+void latency_report(void)
+{
+    latency_stats s;
+    latency_get(&s);
+    printf("latency: %lu probes", (unsigned long)s.count);
+    if (!s.count)
+    {
+        printf("\n");
+        return;
+    }
+    printf(", min %lu us, mean %lu us (buffer copy after %lu us), max %lu us\n",
+           (unsigned long)s.min_us, (unsigned long)(s.sum_us / s.count),
+           (unsigned long)(s.produced_sum_us / s.count), (unsigned long)s.max_us);
+    for (int i = 0; i < LATENCY_BINS; i++)
+    {
+        if (!s.bins[i]) continue;
+        printf("%3d ms%s %6lu ", i * LATENCY_BIN_US / 1000, i == LATENCY_BINS - 1 ? "+" : " ", (unsigned long)s.bins[i]);
+        for (uint32_t j = 0; j < s.bins[i] * 50 / s.count; j++) putchar('#');
+        putchar('\n');
+    }
+}
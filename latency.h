@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Latency: knob change to the first DMA'd buffer that carries it
+////////////////////////////////////////////////////////////////////////////////////
+// One probe is in flight at a time and walks through the stages of the pipeline:
+//
+//   latency_stamp      main loop  a control moved (ADC read)
+//   latency_rendered   main loop  voice_render with the new value finished
+//   latency_produced   DMA IRQ    i2s_callback_func copied a render into a buffer
+//   latency_consumed   DMA IRQ    the consumer (I2S DMA) took a buffer
+//
+// Both sides count frames, as producer and consumer buffers differ in size (1156 and
+// 256 frames in grib.c): the producer stamps the frame offset of the buffer that
+// carries the change, the consumer adds up the frames it takes, and the probe
+// completes when the consumer takes the buffer holding that frame. With chained DMA
+// that buffer is queued behind the playing one, so it is heard up to one consumer
+// buffer period later than reported.
+////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/audio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LATENCY_BINS   32      // Histogram bins
+#define LATENCY_BIN_US 2000    // Bin width; the last bin takes everything longer
+
+typedef struct
+{
+    uint32_t count;                 // Completed probes
+    uint32_t min_us, max_us;
+    uint64_t sum_us;
+    uint64_t produced_sum_us;       // Stamp to buffer copy, queue wait is the rest
+    uint32_t bins[LATENCY_BINS];
+
+} latency_stats;
+
+void latency_init(void);
+
+// Main loop; stamp starts a probe unless one is running
+void latency_stamp(void);
+void latency_rendered(void);
+
+// Producer, right before every give_audio_buffer (the buffer is the consumer's after it),
+// with the buffer's sample_count
+void latency_produced(uint32_t frames);
+
+// Consumer side probe, insert with audio_insert_effect after the connection is made
+extern audio_effect_t latency_effect;
+
+// Latest completed probe in us (stamp to buffer copy, stamp to DMA), false if none since the last call
+bool latency_poll(uint32_t* produced_us, uint32_t* total_us);
+
+void latency_get(latency_stats* s);
+void latency_report(void);
+
+#ifdef __cplusplus
+}
+#endif
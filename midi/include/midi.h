@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#ifndef _MIDI_H
+#define _MIDI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pico.h"
+
+/** \file midi.h
+ *  \defgroup grib_midi grib_midi
+ *  MIDI input from the UART and the USB CDC port, queued with arrival times for the renderer
+ *
+ * - midi_parse turns a byte stream into messages: running status, realtime bytes anywhere
+ *   (also inside a message or a sysex), system common messages, sysex skipped up to its
+ *   end or the next status byte.
+ * - Every input (MIDI_UART from its RX IRQ, MIDI_USB from the main loop) owns a parser and
+ *   a ring. A ring has a single producer and a single consumer, so like the telemetry rings
+ *   no locks or atomics beyond load/store ordering are needed. Messages posted to a full
+ *   ring are counted and dropped.
+ * - The renderer takes the messages that arrived before its block at the block boundary,
+ *   oldest first across both inputs, and places each one at midi_offset: its distance from
+ *   the previous boundary, converted to samples. Every message is delayed by the same one
+ *   block, so the spacing between messages survives at sample resolution instead of being
+ *   quantised to blocks.
+ *
+ * MIDI_UART messages carry the arrival time of their last byte. MIDI_USB bytes are read
+ * once per loop, so its messages carry the time of that poll.
+ *
+ * The USB CDC port also carries the console keys. midi_stdio_poll hands a byte to the
+ * console when the USB parser has nothing to complete; once a channel message set a
+ * running status the data bytes belong to MIDI until a system common message (e.g. a tune
+ * request, 0xF6) clears it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Messages per ring, power of two
+#ifndef MIDI_QUEUE_LENGTH
+#define MIDI_QUEUE_LENGTH 64
+#endif
+
+#define MIDI_BAUD 31250
+
+#define MIDI_NOTE_OFF          0x80
+#define MIDI_NOTE_ON           0x90
+#define MIDI_POLY_PRESSURE     0xA0
+#define MIDI_CONTROL_CHANGE    0xB0
+#define MIDI_PROGRAM_CHANGE    0xC0
+#define MIDI_CHANNEL_PRESSURE  0xD0
+#define MIDI_PITCH_BEND        0xE0
+#define MIDI_SYSEX             0xF0
+#define MIDI_SYSEX_END         0xF7
+#define MIDI_TUNE_REQUEST      0xF6
+#define MIDI_CLOCK             0xF8
+#define MIDI_START             0xFA
+#define MIDI_STOP              0xFC
+
+typedef enum midi_source {
+    MIDI_UART = 0, ///< 31250 baud input, posted from the UART RX IRQ
+    MIDI_USB,      ///< USB CDC port, posted from the main loop
+    MIDI_SOURCES
+} midi_source_t;
+
+/** \brief One complete message, 8 bytes
+ * \ingroup grib_midi
+ */
+typedef struct midi_message {
+    uint32_t time_us; ///< time_us_32 when the last byte arrived
+    uint8_t status;   ///< Channel messages keep the channel in the low nibble
+    uint8_t data[2];  ///< Unused bytes are 0
+    uint8_t source;   ///< midi_source_t
+} midi_message_t;
+
+/** \brief Byte stream state of one input
+ * \ingroup grib_midi
+ */
+typedef struct midi_parser {
+    uint8_t status;   ///< Status of the message being received or the running status, 0 if none
+    uint8_t data[2];
+    uint8_t count;    ///< Data bytes received for status
+    bool sysex;       ///< Inside a sysex, data bytes are skipped
+    uint32_t skipped; ///< Sysex data bytes skipped
+    uint32_t stray;   ///< Data bytes without a status
+} midi_parser_t;
+
+typedef struct midi_stats {
+    uint32_t dropped[MIDI_SOURCES]; ///< Messages lost to a full ring
+    uint32_t skipped[MIDI_SOURCES]; ///< Sysex data bytes
+    uint32_t stray[MIDI_SOURCES];   ///< Data bytes without a status
+} midi_stats_t;
+
+void midi_parser_init(midi_parser_t *p);
+
+/** \brief Add one byte; returns true and fills msg (but not time_us, source) when it completes a message
+ * \ingroup grib_midi
+ */
+bool midi_parse(midi_parser_t *p, uint8_t byte, midi_message_t *msg);
+
+/** \brief True if a data byte now would not belong to any message
+ * \ingroup grib_midi
+ */
+static inline bool midi_parser_idle(const midi_parser_t *p) {
+    return p->status == 0 && !p->sysex;
+}
+
+/** \brief Parse bytes that arrived at time_us on source and queue the messages; returns the number queued
+ * \ingroup grib_midi
+ *
+ * Only ever call with the same source from one context.
+ */
+uint midi_feed(midi_source_t source, const uint8_t *bytes, size_t size, uint32_t time_us);
+
+/** \brief Take the oldest message that arrived before until_us, from either input
+ * \ingroup grib_midi
+ */
+bool midi_take(midi_message_t *msg, uint32_t until_us);
+
+/** \brief Samples from the block boundary at since_us to msg, at most n - 1
+ * \ingroup grib_midi
+ */
+uint midi_offset(const midi_message_t *msg, uint32_t since_us, uint32_t sample_rate, uint n);
+
+/** \brief Listen on uart at MIDI_BAUD, bytes timestamped and queued from its RX IRQ
+ * \ingroup grib_midi
+ */
+void midi_uart_init(uint uart_index, uint rx_pin);
+
+/** \brief Feed up to max bytes waiting on stdio to MIDI_USB; returns the last console key or -1
+ * \ingroup grib_midi
+ */
+int midi_stdio_poll(uint max);
+
+void midi_get_stats(midi_stats_t *stats);
+
+static inline bool midi_is_note_on(const midi_message_t *msg) {
+    return (msg->status & 0xF0) == MIDI_NOTE_ON && msg->data[1] != 0;
+}
+
+// A note on with velocity 0 is a note off
+static inline bool midi_is_note_off(const midi_message_t *msg) {
+    return (msg->status & 0xF0) == MIDI_NOTE_OFF || ((msg->status & 0xF0) == MIDI_NOTE_ON && msg->data[1] == 0);
+}
+
+// Pitch bend -8192 < 8192
+static inline int midi_bend(const midi_message_t *msg) {
+    return (msg->data[0] | (msg->data[1] << 7)) - 8192;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_MIDI_H
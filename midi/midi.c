@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "midi.h"
+
+#if LIB_HARDWARE_UART
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+#endif
+
+static_assert(!(MIDI_QUEUE_LENGTH & (MIDI_QUEUE_LENGTH - 1)), "MIDI_QUEUE_LENGTH must be a power of two");
+
+// head is only written by the producer, tail only by the consumer
+typedef struct midi_ring {
+    midi_message_t messages[MIDI_QUEUE_LENGTH];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;  ///< Written by the producer
+    midi_parser_t parser;
+} midi_ring_t;
+
+static midi_ring_t rings[MIDI_SOURCES];
+
+void midi_parser_init(midi_parser_t *p) {
+    memset(p, 0, sizeof *p);
+}
+
+// Data bytes after status
+static uint midi_length(uint8_t status) {
+    switch (status & 0xF0) {
+        case MIDI_PROGRAM_CHANGE:
+        case MIDI_CHANNEL_PRESSURE:
+            return 1;
+        case 0xF0:
+            // MTC quarter frame and song select take one, song position two
+            return status == 0xF2 ? 2 : 1;
+        default:
+            return 2;
+    }
+}
+
+bool midi_parse(midi_parser_t *p, uint8_t byte, midi_message_t *msg) {
+    if (byte >= MIDI_CLOCK) {
+        // Realtime: a message on its own, wherever it falls; 0xF9 and 0xFD are undefined
+        if (byte == 0xF9 || byte == 0xFD) return false;
+        *msg = (midi_message_t) { .status = byte };
+        return true;
+    }
+    if (byte & 0x80) {
+        // Any other status byte ends a sysex
+        p->sysex = byte == MIDI_SYSEX;
+        p->count = 0;
+        if (byte >= MIDI_SYSEX) {
+            // System common messages clear the running status
+            p->status = 0;
+            if (byte == MIDI_TUNE_REQUEST) {
+                *msg = (midi_message_t) { .status = byte };
+                return true;
+            }
+            if (byte == 0xF1 || byte == 0xF2 || byte == 0xF3) p->status = byte;
+            return false;
+        }
+        p->status = byte;
+        return false;
+    }
+    if (p->sysex) {
+        p->skipped++;
+        return false;
+    }
+    if (p->status == 0) {
+        p->stray++;
+        return false;
+    }
+    p->data[p->count++] = byte;
+    if (p->count < midi_length(p->status)) return false;
+    *msg = (midi_message_t) { .status = p->status, .data = { p->data[0], p->count > 1 ? p->data[1] : 0 } };
+    p->count = 0;
+    // Only channel messages run on
+    if (p->status >= MIDI_SYSEX) p->status = 0;
+    return true;
+}
+
+uint midi_feed(midi_source_t source, const uint8_t *bytes, size_t size, uint32_t time_us) {
+    assert(source < MIDI_SOURCES);
+    midi_ring_t *ring = &rings[source];
+    uint queued = 0;
+    for (size_t i = 0; i < size; i++) {
+        midi_message_t msg;
+        if (!midi_parse(&ring->parser, bytes[i], &msg)) continue;
+        msg.time_us = time_us;
+        msg.source = (uint8_t) source;
+        uint32_t head = ring->head;
+        if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= MIDI_QUEUE_LENGTH) {
+            ring->dropped++;
+            continue;
+        }
+        ring->messages[head & (MIDI_QUEUE_LENGTH - 1)] = msg;
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+        queued++;
+    }
+    return queued;
+}
+
+bool midi_take(midi_message_t *msg, uint32_t until_us) {
+    midi_ring_t *oldest = NULL;
+    for (uint i = 0; i < MIDI_SOURCES; i++) {
+        midi_ring_t *ring = &rings[i];
+        uint32_t tail = ring->tail;
+        if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) continue;
+        const midi_message_t *m = &ring->messages[tail & (MIDI_QUEUE_LENGTH - 1)];
+        if ((int32_t) (m->time_us - until_us) > 0) continue;
+        if (!oldest || (int32_t) (m->time_us - oldest->messages[oldest->tail & (MIDI_QUEUE_LENGTH - 1)].time_us) < 0) {
+            oldest = ring;
+        }
+    }
+    if (!oldest) return false;
+    *msg = oldest->messages[oldest->tail & (MIDI_QUEUE_LENGTH - 1)];
+    __atomic_store_n(&oldest->tail, oldest->tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint midi_offset(const midi_message_t *msg, uint32_t since_us, uint32_t sample_rate, uint n) {
+    int32_t us = (int32_t) (msg->time_us - since_us);
+    if (us <= 0 || n == 0) return 0;
+    uint64_t offset = ((uint64_t) us * sample_rate) / 1000000u;
+    // A loop slower than the block squeezes its messages into the block
+    return offset < n ? (uint) offset : n - 1;
+}
+
+void midi_get_stats(midi_stats_t *stats) {
+    for (uint i = 0; i < MIDI_SOURCES; i++) {
+        stats->dropped[i] = rings[i].dropped;
+        stats->skipped[i] = rings[i].parser.skipped;
+        stats->stray[i] = rings[i].parser.stray;
+    }
+}
+
+#if LIB_HARDWARE_UART
+static uart_inst_t *midi_uart;
+
+static void midi_uart_irq(void) {
+    uint32_t now = time_us_32();
+    while (uart_is_readable(midi_uart)) {
+        uint8_t byte = (uint8_t) uart_getc(midi_uart);
+        midi_feed(MIDI_UART, &byte, 1, now);
+    }
+}
+
+void midi_uart_init(uint uart_index, uint rx_pin) {
+    midi_uart = uart_get_instance(uart_index);
+    uart_init(midi_uart, MIDI_BAUD);
+    gpio_set_function(rx_pin, GPIO_FUNC_UART);
+    // One interrupt per byte, so every byte gets its own arrival time (a byte takes 320 us)
+    uart_set_fifo_enabled(midi_uart, false);
+    uint irq = uart_index ? UART1_IRQ : UART0_IRQ;
+    irq_set_exclusive_handler(irq, midi_uart_irq);
+    irq_set_enabled(irq, true);
+    uart_set_irq_enables(midi_uart, true, false);
+}
+#else
+void midi_uart_init(uint uart_index, uint rx_pin) {
+    (void) uart_index;
+    (void) rx_pin;
+}
+#endif
+
+int midi_stdio_poll(uint max) {
+    midi_ring_t *ring = &rings[MIDI_USB];
+    int key = -1;
+    uint32_t now = time_us_32();
+    for (uint i = 0; i < max; i++) {
+        int c = getchar_timeout_us(0);
+        if (c == PICO_ERROR_TIMEOUT) break;
+        uint8_t byte = (uint8_t) c;
+        if (byte < 0x80 && midi_parser_idle(&ring->parser)) {
+            key = c;
+            continue;
+        }
+        midi_feed(MIDI_USB, &byte, 1, now);
+    }
+    return key;
+}
@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#ifndef _PRESET_H
+#define _PRESET_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico.h"
+#include "patch.h"
+#include "pattern.h"
+
+/** \file preset.h
+ *  \defgroup grib_preset grib_preset
+ *  Presets (knob values, sequencer patterns, patch routing) in a wear leveled flash log
+ *
+ * The store is PRESET_SECTORS erase sectors at the end of flash, split into fixed size
+ * records of PRESET_RECORD_SIZE bytes. A save appends a record (header, CRC-32, preset) at
+ * the write head; the newest valid record of a slot is its value. The head walks the
+ * region as a ring, so every sector is erased once per lap whichever slots are saved.
+ *
+ * - The two sectors ahead of the head's sector are kept empty. When the head enters a
+ *   sector, the one two ahead is emptied: its records that are still the newest of their
+ *   slot are copied to the head, then it is erased. Saving never writes over a live record,
+ *   and a slot saved once is never lost to an erase.
+ * - preset_mount rebuilds the slot index from the record headers and finishes a copy or
+ *   erase that a power cut interrupted. A torn record fails its CRC and is ignored, so a
+ *   save either lands completely or the previous value stays.
+ * - preset_load copies a record to RAM; on the device it reads through the uncached XIP
+ *   window, costs a few microseconds and evicts nothing from the XIP cache. The caller
+ *   swaps the loaded set in between two renders.
+ * - Erasing and programming stop the XIP bus: both cores are held off flash and interrupts
+ *   are off for up to ~50 ms per erase (once every PRESET_RECORDS_PER_SECTOR saves, plus
+ *   copies) and ~1 ms per record. Audio underruns during a save.
+ *
+ * Storage is reached through a preset_backend_t, so the same log runs on the device flash
+ * (preset_flash_backend) and on a file on the host (preset_file_backend).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Erase sectors reserved at the end of flash
+#ifndef PRESET_SECTORS
+#define PRESET_SECTORS 8
+#endif
+
+// Presets addressable by slot number
+#ifndef PRESET_SLOTS
+#define PRESET_SLOTS 16
+#endif
+
+#define PRESET_SECTOR_SIZE 4096u
+#define PRESET_PAGE_SIZE 256u
+#define PRESET_RECORD_SIZE 1024u
+#define PRESET_RECORDS_PER_SECTOR (PRESET_SECTOR_SIZE / PRESET_RECORD_SIZE)
+#define PRESET_RECORDS (PRESET_SECTORS * PRESET_RECORDS_PER_SECTOR)
+#define PRESET_REGION_SIZE (PRESET_SECTORS * PRESET_SECTOR_SIZE)
+#define PRESET_PATTERNS 4
+#define PRESET_MAGIC 0x53505247u // 'GRPS'
+
+#define PRESET_OK 0
+#define PRESET_EINVAL -1   ///< Slot out of range
+#define PRESET_EEMPTY -2   ///< Slot never saved
+#define PRESET_EIO -3      ///< Backend read, program or erase failed
+#define PRESET_ECORRUPT -4 ///< Region damaged beyond an interrupted save
+
+/** \brief One preset, stored as a flat struct
+ * \ingroup grib_preset
+ */
+typedef struct preset {
+    float knob[PATCH_CTLS];              ///< Control values by patch_ctl
+    uint8_t patched;                     ///< 1: the patch graph runs instead of the fixed voice
+    uint8_t patterns;                    ///< Patterns in use
+    pattern pattern[PRESET_PATTERNS];
+    patch patch;
+} preset_t;
+
+/** \brief Record header, in front of the preset
+ * \ingroup grib_preset
+ */
+typedef struct preset_header {
+    uint32_t magic;
+    uint32_t seq;   ///< Store wide save counter, the highest copy of a slot is its value
+    uint16_t slot;
+    uint16_t size;  ///< sizeof(preset_t) of the writer, records of another layout are ignored
+    uint32_t crc;   ///< CRC-32 of the header up to here and the preset
+} preset_header_t;
+
+static_assert(sizeof(preset_header_t) + sizeof(preset_t) <= PRESET_RECORD_SIZE, "preset does not fit a record");
+static_assert(PRESET_RECORD_SIZE % PRESET_PAGE_SIZE == 0, "records are whole flash pages");
+// Live records have to fit beside the head's sector and the two empty ones ahead of it
+static_assert(PRESET_SLOTS <= (PRESET_SECTORS - 3) * PRESET_RECORDS_PER_SECTOR, "too many slots for the region");
+
+/** \brief Storage under the log; offsets are relative to the region
+ * \ingroup grib_preset
+ *
+ * program writes whole pages into erased flash, erase clears one sector to 0xFF.
+ */
+typedef struct preset_backend {
+    bool (*read)(uint32_t offset, void *dst, size_t size, void *ctx);
+    bool (*program)(uint32_t offset, const void *src, size_t size, void *ctx);
+    bool (*erase)(uint32_t offset, void *ctx);
+    void *ctx;
+} preset_backend_t;
+
+typedef struct preset_store {
+    preset_backend_t backend;
+    int16_t latest[PRESET_SLOTS]; ///< Record holding each slot, -1 if none
+    uint16_t head;                ///< Next record to write
+    uint32_t seq;                 ///< seq of the newest record
+    uint32_t erases;              ///< Sector erases since mount
+    uint32_t copies;              ///< Live records moved ahead of an erase since mount
+} preset_store_t;
+
+/** \brief Scan the region and repair an interrupted save; returns PRESET_OK or a negative PRESET_E* code
+ * \ingroup grib_preset
+ */
+int preset_mount(preset_store_t *store, const preset_backend_t *backend);
+
+/** \brief Append p as the new value of slot
+ * \ingroup grib_preset
+ */
+int preset_save(preset_store_t *store, uint slot, const preset_t *p);
+
+/** \brief Copy the value of slot to p
+ * \ingroup grib_preset
+ */
+int preset_load(const preset_store_t *store, uint slot, preset_t *p);
+
+static inline bool preset_exists(const preset_store_t *store, uint slot) {
+    return slot < PRESET_SLOTS && store->latest[slot] >= 0;
+}
+
+/** \brief The last PRESET_REGION_SIZE bytes of the board's flash
+ * \ingroup grib_preset
+ *
+ * Core 1 has to run multicore_lockout_victim_init, or keep off flash while saving.
+ */
+preset_backend_t preset_flash_backend(void);
+
+/** \brief A region file (a FILE * opened "r+b"); missing bytes read as erased
+ * \ingroup grib_preset
+ */
+preset_backend_t preset_file_backend(void *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_PRESET_H
@@ -0,0 +1,268 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "preset.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#endif
+
+#define PRESET_HEADER_CRC_BYTES offsetof(preset_header_t, crc)
+
+typedef struct preset_record {
+    preset_header_t header;
+    preset_t preset;
+    uint8_t pad[PRESET_RECORD_SIZE - sizeof(preset_header_t) - sizeof(preset_t)];
+} preset_record_t;
+
+static_assert(sizeof(preset_record_t) == PRESET_RECORD_SIZE, "record is padded to whole pages");
+
+// Staging for one record: flash programming must not read from flash
+static preset_record_t record;
+
+// Nibble-wise CRC-32 (IEEE), 64 byte table
+static uint32_t preset_crc(uint32_t crc, const void *data, size_t size) {
+    static const uint32_t t[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = t[(crc ^ p[i]) & 0xF] ^ (crc >> 4);
+        crc = t[(crc ^ (p[i] >> 4)) & 0xF] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+static uint32_t preset_record_crc(const preset_record_t *r) {
+    uint32_t crc = preset_crc(0, &r->header, PRESET_HEADER_CRC_BYTES);
+    return preset_crc(crc, &r->preset, sizeof r->preset);
+}
+
+static uint32_t preset_offset(uint index) {
+    return index * PRESET_RECORD_SIZE;
+}
+
+static uint preset_sector(uint index) {
+    return index / PRESET_RECORDS_PER_SECTOR;
+}
+
+static bool preset_blank(const preset_store_t *store, uint32_t offset, size_t size) {
+    uint32_t chunk[PRESET_PAGE_SIZE / 4];
+    while (size) {
+        size_t n = size < sizeof chunk ? size : sizeof chunk;
+        if (!store->backend.read(offset, chunk, n, store->backend.ctx)) return false;
+        for (size_t i = 0; i < n / 4; i++) {
+            if (chunk[i] != 0xFFFFFFFFu) return false;
+        }
+        offset += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Read record index into record; false if it is blank, torn or of another layout
+static bool preset_read(const preset_store_t *store, uint index) {
+    if (!store->backend.read(preset_offset(index), &record, sizeof record, store->backend.ctx)) return false;
+    const preset_header_t *h = &record.header;
+    return h->magic == PRESET_MAGIC && h->size == sizeof(preset_t) && h->slot < PRESET_SLOTS &&
+           h->crc == preset_record_crc(&record);
+}
+
+// Stamp record as the newest value of its slot and append it at the head
+static int preset_append(preset_store_t *store) {
+    record.header.magic = PRESET_MAGIC;
+    record.header.seq = ++store->seq;
+    record.header.size = sizeof(preset_t);
+    record.header.crc = preset_record_crc(&record);
+    if (!store->backend.program(preset_offset(store->head), &record, sizeof record, store->backend.ctx)) {
+        return PRESET_EIO;
+    }
+    store->latest[record.header.slot] = (int16_t) store->head;
+    store->head = (store->head + 1) % PRESET_RECORDS;
+    return PRESET_OK;
+}
+
+// Keep the two sectors after the head's sector empty: live records of a sector in the
+// way are copied to the head, then it is erased. The second sector is the spill room
+// that lets the copies fit even after an interrupted copy wasted a record.
+static int preset_make_room(preset_store_t *store) {
+    for (uint ahead = 1; ahead <= 2; ahead++) {
+        uint victim = (preset_sector(store->head) + ahead) % PRESET_SECTORS;
+        uint first = victim * PRESET_RECORDS_PER_SECTOR;
+        if (preset_blank(store, preset_offset(first), PRESET_SECTOR_SIZE)) continue;
+        for (uint i = first; i < first + PRESET_RECORDS_PER_SECTOR; i++) {
+            if (!preset_read(store, i) || store->latest[record.header.slot] != (int16_t) i) continue;
+            if (preset_sector(store->head) == victim) return PRESET_ECORRUPT;
+            int r = preset_append(store);
+            if (r != PRESET_OK) return r;
+            store->copies++;
+        }
+        if (!store->backend.erase(preset_offset(first), store->backend.ctx)) return PRESET_EIO;
+        store->erases++;
+        // The copies may have moved the head on; look at both sectors ahead of it again
+        ahead = 0;
+    }
+    return PRESET_OK;
+}
+
+int preset_mount(preset_store_t *store, const preset_backend_t *backend) {
+    memset(store, 0, sizeof *store);
+    store->backend = *backend;
+    uint32_t seq[PRESET_SLOTS];
+    int newest = -1;
+    for (uint s = 0; s < PRESET_SLOTS; s++) store->latest[s] = -1;
+    for (uint i = 0; i < PRESET_RECORDS; i++) {
+        if (!preset_read(store, i)) continue;
+        const preset_header_t *h = &record.header;
+        if (store->latest[h->slot] < 0 || h->seq > seq[h->slot]) {
+            store->latest[h->slot] = (int16_t) i;
+            seq[h->slot] = h->seq;
+        }
+        if (newest < 0 || h->seq > store->seq) {
+            newest = (int) i;
+            store->seq = h->seq;
+        }
+    }
+    store->head = newest < 0 ? 0 : (newest + 1) % PRESET_RECORDS;
+
+    // Skip what an interrupted save left behind the newest record
+    while (store->head % PRESET_RECORDS_PER_SECTOR && !preset_blank(store, preset_offset(store->head), PRESET_RECORD_SIZE)) {
+        store->head = (store->head + 1) % PRESET_RECORDS;
+    }
+    uint first = preset_sector(store->head) * PRESET_RECORDS_PER_SECTOR;
+    if (store->head == first && !preset_blank(store, preset_offset(first), PRESET_SECTOR_SIZE)) {
+        // An erase cut short; only copies of its records may be live
+        for (uint s = 0; s < PRESET_SLOTS; s++) {
+            if (store->latest[s] >= 0 && preset_sector((uint) store->latest[s]) == preset_sector(first)) return PRESET_ECORRUPT;
+        }
+        if (!backend->erase(preset_offset(first), backend->ctx)) return PRESET_EIO;
+        store->erases++;
+    }
+    return preset_make_room(store);
+}
+
+int preset_save(preset_store_t *store, uint slot, const preset_t *p) {
+    if (slot >= PRESET_SLOTS) return PRESET_EINVAL;
+    memset(&record, 0xFF, sizeof record);
+    record.header.slot = (uint16_t) slot;
+    record.preset = *p;
+    int r = preset_append(store);
+    if (r != PRESET_OK) return r;
+    return store->head % PRESET_RECORDS_PER_SECTOR ? PRESET_OK : preset_make_room(store);
+}
+
+int preset_load(const preset_store_t *store, uint slot, preset_t *p) {
+    if (slot >= PRESET_SLOTS) return PRESET_EINVAL;
+    if (store->latest[slot] < 0) return PRESET_EEMPTY;
+    if (!preset_read(store, (uint) store->latest[slot])) return PRESET_EIO;
+    *p = record.preset;
+    return PRESET_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Device flash ////////////////////////////////////////////////////////////////////////
+#if PICO_ON_DEVICE
+#define PRESET_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - PRESET_REGION_SIZE)
+
+extern char __flash_binary_end;
+
+static bool preset_flash_read(uint32_t offset, void *dst, size_t size, void *ctx) {
+    (void) ctx;
+    // Uncached window: a recall does not evict the render's code from the XIP cache
+    memcpy(dst, (const void *) (XIP_NOCACHE_NOALLOC_BASE + PRESET_FLASH_OFFSET + offset), size);
+    return true;
+}
+
+// Nothing may run from flash while it is written: core 1 is parked, interrupts are off
+static bool preset_flash_begin(uint32_t *irq, bool *parked) {
+    if ((uintptr_t) &__flash_binary_end - XIP_BASE > PRESET_FLASH_OFFSET) return false;
+    *parked = multicore_lockout_victim_is_initialized(1);
+    if (*parked) multicore_lockout_start_blocking();
+    *irq = save_and_disable_interrupts();
+    return true;
+}
+
+static void preset_flash_end(uint32_t irq, bool parked) {
+    restore_interrupts(irq);
+    if (parked) multicore_lockout_end_blocking();
+}
+
+static bool preset_flash_program(uint32_t offset, const void *src, size_t size, void *ctx) {
+    (void) ctx;
+    uint32_t irq;
+    bool parked;
+    if (!preset_flash_begin(&irq, &parked)) return false;
+    flash_range_program(PRESET_FLASH_OFFSET + offset, src, size);
+    preset_flash_end(irq, parked);
+    return true;
+}
+
+static bool preset_flash_erase(uint32_t offset, void *ctx) {
+    (void) ctx;
+    uint32_t irq;
+    bool parked;
+    if (!preset_flash_begin(&irq, &parked)) return false;
+    flash_range_erase(PRESET_FLASH_OFFSET + offset, FLASH_SECTOR_SIZE);
+    preset_flash_end(irq, parked);
+    return true;
+}
+
+preset_backend_t preset_flash_backend(void) {
+    static_assert(FLASH_SECTOR_SIZE == PRESET_SECTOR_SIZE && FLASH_PAGE_SIZE == PRESET_PAGE_SIZE, "flash geometry");
+    return (preset_backend_t) { preset_flash_read, preset_flash_program, preset_flash_erase, NULL };
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// File ////////////////////////////////////////////////////////////////////////////////
+static bool preset_file_read(uint32_t offset, void *dst, size_t size, void *ctx) {
+    FILE *f = ctx;
+    if (fseek(f, (long) offset, SEEK_SET) != 0) return false;
+    size_t n = fread(dst, 1, size, f);
+    // Past the end of the file is erased flash
+    memset((uint8_t *) dst + n, 0xFF, size - n);
+    return true;
+}
+
+// Writing past the end would leave a hole of zeros; fill it as erased flash first
+static bool preset_file_seek(FILE *f, uint32_t offset) {
+    if (fseek(f, 0, SEEK_END) != 0) return false;
+    long end = ftell(f);
+    for (; end >= 0 && end < (long) offset; end++) {
+        if (fputc(0xFF, f) == EOF) return false;
+    }
+    return end >= 0 && fseek(f, (long) offset, SEEK_SET) == 0;
+}
+
+// Like NOR flash, programming only clears bits
+static bool preset_file_program(uint32_t offset, const void *src, size_t size, void *ctx) {
+    uint8_t page[PRESET_PAGE_SIZE];
+    const uint8_t *s = src;
+    for (size_t done = 0; done < size; done += sizeof page) {
+        if (!preset_file_read(offset + done, page, sizeof page, ctx)) return false;
+        for (size_t i = 0; i < sizeof page; i++) page[i] &= s[done + i];
+        if (!preset_file_seek(ctx, offset + done) || fwrite(page, 1, sizeof page, ctx) != sizeof page) return false;
+    }
+    return fflush(ctx) == 0;
+}
+
+static bool preset_file_erase(uint32_t offset, void *ctx) {
+    uint8_t sector[PRESET_SECTOR_SIZE];
+    memset(sector, 0xFF, sizeof sector);
+    if (!preset_file_seek(ctx, offset) || fwrite(sector, 1, sizeof sector, ctx) != sizeof sector) return false;
+    return fflush(ctx) == 0;
+}
+
+preset_backend_t preset_file_backend(void *file) {
+    return (preset_backend_t) { preset_file_read, preset_file_program, preset_file_erase, file };
+}
@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pico.h"
+
+/** \file replay.h
+ *  \defgroup grib_replay grib_replay
+ *  Input frames of the control loop, recorded on the device and replayed on the host
+ *
+ * Once per loop the synth reads the eight 4051 channels, the buttons and a console key
+ * into a frame and hands it to replay_record. The ring keeps the latest REPLAY_LENGTH
+ * frames (about 13 s at 1156 samples per loop), so after a glitch there is a window
+ * leading up to it.
+ *
+ * replay_dump prints the ring between REPLAY-BEGIN and REPLAY-END lines, oldest frame
+ * first, one frame per line as
+ *
+ *     <time_us> <adc0> ... <adc7> <buttons> <key> <render_us>
+ *
+ * replay_read parses such a capture back into frames. grib_replay_run (replay_run.c)
+ * feeds them into the same control mapping (synth.h) and render path as the
+ * main loop, in place of the ADC and the buttons, one frame per block; the output and the
+ * render time of every block are then reproducible offline. time_us and render_us are
+ * not inputs: they keep the device's loop period and render time next to the host's.
+ *
+ * Only the main loop records, so the ring needs no locks.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Frames in the ring, power of two
+#ifndef REPLAY_LENGTH
+#define REPLAY_LENGTH 512
+#endif
+
+// 4051 channels
+#define REPLAY_CHANNELS 8
+
+// key when no console key was read
+#define REPLAY_NO_KEY (-1)
+
+typedef struct replay_frame {
+    uint32_t time_us;                  // Loop start
+    uint16_t adc[REPLAY_CHANNELS];     // Raw 12-bit reading per 4051 channel
+    uint8_t buttons;                   // Bit per button, set while held
+    uint8_t reserved;
+    int16_t key;                       // Console key of the loop or REPLAY_NO_KEY
+    uint32_t render_us;                // Render time of the loop
+} replay_frame_t;
+
+/** \brief Append a frame, overwriting the oldest one when the ring is full
+ * \ingroup grib_replay
+ */
+void replay_record(const replay_frame_t *frame);
+
+/** \brief Print the ring, oldest frame first
+ * \ingroup grib_replay
+ */
+void replay_dump(void);
+
+/** \brief Drop all recorded frames
+ * \ingroup grib_replay
+ */
+void replay_clear(void);
+
+/** \brief Parse the frames of a replay_dump capture; text around the REPLAY-BEGIN and
+ * REPLAY-END lines (console output, other dumps) is skipped
+ * \ingroup grib_replay
+ *
+ * \param file   Capture
+ * \param frames Destination, up to max frames
+ * \return The number of frames, or -1 for a malformed frame line or a missing REPLAY-END
+ */
+int replay_read(FILE *file, replay_frame_t *frames, uint max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "replay.h"
+
+static_assert(!(REPLAY_LENGTH & (REPLAY_LENGTH - 1)), "REPLAY_LENGTH must be a power of two");
+
+static replay_frame_t ring[REPLAY_LENGTH];
+static uint32_t head;
+
+void replay_record(const replay_frame_t *frame) {
+    ring[head++ & (REPLAY_LENGTH - 1)] = *frame;
+}
+
+void replay_dump(void) {
+    uint32_t count = head < REPLAY_LENGTH ? head : REPLAY_LENGTH;
+    printf("REPLAY-BEGIN\n");
+    for (uint32_t i = head - count; i != head; i++) {
+        const replay_frame_t *f = &ring[i & (REPLAY_LENGTH - 1)];
+        printf("%lu", (unsigned long) f->time_us);
+        for (uint c = 0; c < REPLAY_CHANNELS; c++) {
+            printf(" %u", f->adc[c]);
+        }
+        printf(" %u %d %lu\n", f->buttons, f->key, (unsigned long) f->render_us);
+    }
+    printf("REPLAY-END\n");
+}
+
+void replay_clear(void) {
+    head = 0;
+}
+
+static bool replay_parse(const char *line, replay_frame_t *f) {
+    unsigned long time_us, render_us;
+    unsigned adc[REPLAY_CHANNELS], buttons;
+    int key, end = 0;
+    if (sscanf(line, "%lu %u %u %u %u %u %u %u %u %u %d %lu %n", &time_us,
+               &adc[0], &adc[1], &adc[2], &adc[3], &adc[4], &adc[5], &adc[6], &adc[7],
+               &buttons, &key, &render_us, &end) != 12 || line[end] != '\0') {
+        return false;
+    }
+    memset(f, 0, sizeof *f);
+    f->time_us = time_us;
+    for (uint c = 0; c < REPLAY_CHANNELS; c++) {
+        if (adc[c] > 0xFFFF) return false;
+        f->adc[c] = adc[c];
+    }
+    if (buttons > 0xFF || key < -1 || key > 0x7FFF) return false;
+    f->buttons = buttons;
+    f->key = key;
+    f->render_us = render_us;
+    return true;
+}
+
+int replay_read(FILE *file, replay_frame_t *frames, uint max) {
+    char line[160];
+    bool inside = false;
+    uint count = 0;
+    while (fgets(line, sizeof line, file)) {
+        if (!inside) {
+            inside = strncmp(line, "REPLAY-BEGIN", 12) == 0;
+            continue;
+        }
+        if (strncmp(line, "REPLAY-END", 10) == 0) return count;
+        replay_frame_t f;
+        if (!replay_parse(line, &f)) return -1;
+        if (count < max) frames[count++] = f;
+    }
+    return -1;
+}
@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Replay: recorded input frames through the synth's control and render path
+////////////////////////////////////////////////////////////////////////////////////
+// Host program (grib_replay_run, PICO_PLATFORM=host). Reads a capture of the 'r'
+// console dump (replay/include/replay.h) on stdin and runs the main loop of grib.c
+// without the hardware, one block of REPLAY_BLOCK samples per frame: knobs and
+// buttons through synth_controls_map, button B toggles the chaos patch, button C
+// steps the sample rate, the pattern bank plays from SYNTH_PATTERN_SEED.
+//
+//   grib_replay_run [out.f32] < capture.txt
+//
+// Prints one line per frame
+//
+//   <frame> <period_us> <device_us> <host_us> <hash>
+//
+// period_us and device_us are the loop period and render time the device recorded,
+// host_us the render time here, hash an FNV-1a of the block's samples: the same
+// capture gives the same hashes on every run, and a slow block on the device shows
+// up as a slow block here. A summary with the guard counters (cell/guard.h)
+// follows; out.f32 receives the raw float output. Like the device, the host flushes
+// subnormals to zero (dsp_flush_denormals). ctest runs test/data/replay_test.txt and
+// checks the output hash of the summary.
+//
+// Not replayed: MIDI, preset recall and save (the keys are listed in the summary),
+// and the soft takeover that follows a recall.
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "arena.h"
+#include "replay.h"
+#include "synth.h"
+#include "voice.h"
+#include "cell/context.h"
+#include "cell/scheduler.h"
+#include "cell/pattern.h"
+#include "cell/guard.h"
+////////////////////////////////////////////////////////////////////////////////////
+#define SAMPLE_RATE   44100
+#define REPLAY_BLOCK  1156      // SAMPLES_PER_BUFFER in grib.c
+#define REPLAY_FRAMES 65536     // Longest capture
+
+static replay_frame_t frames[REPLAY_FRAMES];
+static float          block[REPLAY_BLOCK];
+static pattern        bank[SYNTH_PATTERNS];
+
+static uint32_t fnv1a(const float* x, unsigned n, uint32_t h)
+{
+    const uint8_t* b = (const uint8_t*)x;
+    for (unsigned i = 0; i < n * sizeof(float); i++) h = (h ^ b[i]) * 16777619u;
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    int count = replay_read(stdin, frames, REPLAY_FRAMES);
+    if (count < 0)
+    {
+        fprintf(stderr, "replay: no REPLAY-BEGIN .. REPLAY-END capture on stdin, or a malformed frame\n");
+        return 2;
+    }
+    FILE* out = NULL;
+    if (argc > 1 && !(out = fopen(argv[1], "wb")))
+    {
+        fprintf(stderr, "replay: cannot write %s\n", argv[1]);
+        return 2;
+    }
+
+    // Subnormal tails would make the host timing meaningless (cell/guard.h)
+    dsp_flush_denormals();
+    dsp_set_rate(RATE_44K1);
+    synth_controls controls;
+    synth_controls_init(&controls, SAMPLE_RATE);
+    voice_init();
+    voice_params vp;
+    vp.note = 0.0f;
+    vp.gate = 0.0f;
+    arena_seal();
+
+    static scheduler sched;
+    static pattern_player player;
+    sched_init(&sched);
+    synth_patterns(bank, SYNTH_PATTERN_SEED);
+    pattern_player_init(&player, bank, SYNTH_PATTERNS, dsp_ctx.sample_rate / SYNTH_SEQUENCER_RATE);
+    pattern_player_start(&player, 0, sched.now);
+
+    bool patched = false;
+    uint32_t hash = 2166136261u;
+    uint64_t host_sum = 0, device_sum = 0;
+    uint32_t host_max = 0, device_max = 0;
+    int host_slowest = 0, device_slowest = 0;
+
+    printf("# frame period_us device_us host_us hash\n");
+    for (int i = 0; i < count; i++)
+    {
+        // Same order as the loop in grib.c
+        const replay_frame_t* f = &frames[i];
+        float knob[PATCH_CTLS];
+        unsigned pressed = synth_controls_map(&controls, f, knob);
+        if (pressed & SYNTH_BUTTON_B)
+        {
+            if (patched) { voice_unload_patch(); patched = false; }
+            else         patched = voice_load_patch(&synth_patch_chaos) == 0;
+        }
+        if (pressed & SYNTH_BUTTON_C) dsp_set_rate((dsp_rate)((dsp_ctx.rate + 1) % NRATES));
+
+        vp.freq   = knob[PATCH_CTL_FREQ];
+        vp.pw     = knob[PATCH_CTL_PW];
+        vp.cutoff = knob[PATCH_CTL_CUTOFF];
+        vp.Q      = knob[PATCH_CTL_Q];
+        vp.amp    = knob[PATCH_CTL_AMP];
+        player.step_length = dsp_ctx.sample_rate / SYNTH_SEQUENCER_RATE;
+        pattern_schedule(&player, &sched, REPLAY_BLOCK);
+
+        uint64_t t0 = time_us_64();
+        voice_render_events(&vp, &sched, block, REPLAY_BLOCK);
+        uint32_t host_us = (uint32_t)(time_us_64() - t0);
+        dsp_ctx.load = host_us * 1e-6f * dsp_ctx.sample_rate / REPLAY_BLOCK;
+
+        uint32_t h = fnv1a(block, REPLAY_BLOCK, 2166136261u);
+        hash = fnv1a(block, REPLAY_BLOCK, hash);
+        if (out) fwrite(block, sizeof(float), REPLAY_BLOCK, out);
+
+        uint32_t period = i ? f->time_us - frames[i - 1].time_us : 0;
+        printf("%d %lu %lu %lu %08lx\n", i, (unsigned long)period, (unsigned long)f->render_us,
+               (unsigned long)host_us, (unsigned long)h);
+
+        host_sum   += host_us;
+        device_sum += f->render_us;
+        if (host_us > host_max)        { host_max = host_us;        host_slowest = i; }
+        if (f->render_us > device_max) { device_max = f->render_us; device_slowest = i; }
+    }
+    if (out) fclose(out);
+
+    printf("# frames %d, output %08lx\n", count, (unsigned long)hash);
+    if (count > 0)
+    {
+        printf("# host   render mean %.1f us, max %lu us at frame %d\n", (double)host_sum / count, (unsigned long)host_max, host_slowest);
+        printf("# device render mean %.1f us, max %lu us at frame %d\n", (double)device_sum / count, (unsigned long)device_max, device_slowest);
+    }
+    for (int i = 0; i < GUARD_CELLS; i++)
+        printf("# guard %-8s flushed %lu reset %lu\n", guard_names[i],
+               (unsigned long)dsp_guard.flushed[i], (unsigned long)dsp_guard.reset[i]);
+    // Console keys with the frame they arrived in
+    printf("# keys (not replayed):");
+    for (int i = 0; i < count; i++)
+    {
+        int key = frames[i].key;
+        if (key != REPLAY_NO_KEY) printf(" %d:%c", i, key > ' ' && key < 0x7F ? key : '?');
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Synth: what the main loop does with its inputs, without the hardware
+////////////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "synth.h"
+#include "voice.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+// Controls ////////////////////////////////////////////////////////////////////////
+void synth_controls_init(synth_controls* c, float sample_rate)
+{
+    memset(c, 0, sizeof(synth_controls));
+    for (int i = 0; i < 4; i++) psf_init(&c->smooth[i], 2, sample_rate);
+}
+
+unsigned synth_controls_map(synth_controls* c, const replay_frame_t* f, float knob[PATCH_CTLS])
+{
+    float a = (f->adc[SYNTH_MUX_AMP] - 580) / 3516.0f;
+    knob[PATCH_CTL_AMP]    = a * a;
+    knob[PATCH_CTL_Q]      = 1.1f - psf_process(&c->smooth[1], f->adc[SYNTH_MUX_Q]) / 4096.0f * 1.05f;
+    knob[PATCH_CTL_PW]     = psf_process(&c->smooth[2], f->adc[SYNTH_MUX_PW] / 4096.0f);
+    knob[PATCH_CTL_FREQ]   = psf_process(&c->smooth[3], f->adc[SYNTH_MUX_FREQ]);
+    knob[PATCH_CTL_CUTOFF] = psf_process(&c->smooth[0], f->adc[SYNTH_MUX_CUTOFF]);
+
+    unsigned pressed = f->buttons & ~c->buttons;
+    c->buttons = f->buttons;
+    return pressed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Patch: roessler -> svf -> mix osc -> delay -> limiter -> dcb -> amp /////////////
+const patch synth_patch_chaos = 
+{
+    .count  = 8,
+    .output = 7,
+    .node   = 
+    {
+        { .kind = PATCH_ROESSLER, .in = { PATCH_NONE, PATCH_NONE }, .bind = { PATCH_NONE, PATCH_NONE, PATCH_NONE, PATCH_NONE }, .param = { 0.01f, 0.1f } },
+        { .kind = PATCH_SVFLTO,   .in = { 0, PATCH_NONE }, .bind = { PATCH_CTL_CUTOFF, PATCH_CTL_Q, PATCH_NONE, PATCH_NONE } },
+        { .kind = PATCH_OSC,      .in = { PATCH_NONE, PATCH_NONE }, .bind = { PATCH_CTL_FREQ, PATCH_CTL_PW, PATCH_NONE, PATCH_NONE }, .param = { 0.0f, 0.5f, 3.0f, 0.5f } },
+        { .kind = PATCH_MIX,      .in = { 1, 2 }, .bind = { PATCH_NONE, PATCH_NONE, PATCH_NONE, PATCH_NONE }, .param = { 0.5f } },
+        { .kind = PATCH_DELAY,    .in = { 3, PATCH_NONE }, .bind = { PATCH_NONE, PATCH_NONE, PATCH_NONE, PATCH_NONE }, .param = { 0.25f, 0.5f, 0.5f } },
+        { .kind = PATCH_LIMITER,  .in = { 4, PATCH_NONE }, .bind = { PATCH_NONE, PATCH_NONE, PATCH_NONE, PATCH_NONE }, .param = { 0.5f } },
+        { .kind = PATCH_DCB,      .in = { 5, PATCH_NONE }, .bind = { PATCH_NONE, PATCH_NONE, PATCH_NONE, PATCH_NONE } },
+        { .kind = PATCH_GAIN,     .in = { 6, PATCH_NONE }, .bind = { PATCH_CTL_AMP, PATCH_NONE, PATCH_NONE, PATCH_NONE } },
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+// Patterns ////////////////////////////////////////////////////////////////////////
+void synth_patterns(pattern* p, uint32_t seed)
+{
+    prng r;
+    prng_seed(&r, seed);
+    for (int i = 0; i < SYNTH_PATTERNS; i++)
+    {
+        pattern_clr(&p[i]);
+        p[i].next   = (i + 1) % SYNTH_PATTERNS;
+        p[i].repeat = 2;
+    }
+    p[1].swing = 96;
+    for (int s = 0; s < PATTERN_STEPS; s++)
+    {
+        bool gate = prng_next(&r) >> 31;
+        pattern_set(&p[0].track[VOICE_TRACK], s, gate, false, PATTERN_ALWAYS, 1, 0);
+        // Same gates, every fourth step ratcheted, the rest played three times in four
+        pattern_set(&p[1].track[VOICE_TRACK], s, gate, !gate, (s & 3) ? 11 : PATTERN_ALWAYS,
+                    (s & 3) ? 1 : 3, (s & 7) == 6 ? 7 : 0);
+    }
+}
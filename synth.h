@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Synth: what the main loop does with its inputs, without the hardware
+////////////////////////////////////////////////////////////////////////////////////
+// grib.c reads the 4051 and the buttons into a frame (replay/include/replay.h) and
+// maps it here; grib_replay_run maps recorded frames instead. The knob curves and
+// smoothing, the button edges, the pattern bank and the chaos patch live in here so
+// that both render the same blocks from the same frames.
+////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include "replay.h"
+#include "cell/utility.h"
+#include "cell/patch.h"
+#include "cell/pattern.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 4051 channels of the knobs; 0, 2 and 5 are read and recorded but unused
+#define SYNTH_MUX_AMP        1
+#define SYNTH_MUX_Q          3
+#define SYNTH_MUX_PW         4
+#define SYNTH_MUX_FREQ       6
+#define SYNTH_MUX_CUTOFF     7
+
+// replay_frame_t.buttons
+#define SYNTH_BUTTON_A       0x01
+#define SYNTH_BUTTON_B       0x02
+#define SYNTH_BUTTON_C       0x04
+
+#define SYNTH_SEQUENCER_RATE 8      // Steps per second, on the played sample clock
+#define SYNTH_PATTERNS       2      // Patterns in the bank, chained 0 -> 1 -> 0
+#define SYNTH_PATTERN_SEED   1      // Gates drawn for the bank, same seed same patterns
+
+typedef struct
+{
+    psf     smooth[4];  // Cutoff, Q, pw, freq
+    uint8_t buttons;    // Held in the previous frame
+
+} synth_controls;
+
+// The knob smoothing filters step once per frame, not per sample
+void synth_controls_init(synth_controls* c, float sample_rate);
+
+// Knob values of frame f in patch_ctl order (cell/patch.h); returns the buttons
+// pressed since the previous frame
+unsigned synth_controls_map(synth_controls* c, const replay_frame_t* f, float knob[PATCH_CTLS]);
+
+// Patch: roessler -> svf -> mix osc -> delay -> limiter -> dcb -> amp
+extern const patch synth_patch_chaos;
+
+// SYNTH_PATTERNS patterns: random gates on the voice track, the second play
+// ratcheted and swung
+void synth_patterns(pattern* p, uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,164 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pico.h"
+
+/** \file telemetry.h
+ *  \defgroup grib_telemetry grib_telemetry
+ *  Binary telemetry records, posted from any context and streamed out later
+ *
+ * Posting a record costs a timestamp and a 16 byte copy, so it is fine in the DMA IRQ
+ * where a printf would stretch the handler by milliseconds.
+ *
+ * - Every producing context (main loop, audio IRQ, core 1) owns one ring. A ring has a
+ *   single producer and a single consumer, so no locks or atomics beyond load/store
+ *   ordering are needed. Records posted to a full ring are counted and dropped.
+ * - telemetry_drain runs from the main loop. It writes at most a given number of
+ *   records per call to the transport, so a slow host cannot stall the loop.
+ * - On the wire every record is framed as 'G' 'R' <16 byte record> <sum of record
+ *   bytes mod 256>. The decoder (tools/telemetry.py) resyncs on the sync bytes, so
+ *   frames can share the USB CDC port with ordinary stdio text.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Records per ring, power of two
+#ifndef TELEMETRY_RING_LENGTH
+#define TELEMETRY_RING_LENGTH 32
+#endif
+
+#define TELEMETRY_SYNC0 0x47 // 'G'
+#define TELEMETRY_SYNC1 0x52 // 'R'
+#define TELEMETRY_FRAME_SIZE (2 + sizeof(telemetry_record_t) + 1)
+
+typedef enum telemetry_source {
+    TELEMETRY_MAIN = 0, ///< Core 0 main loop
+    TELEMETRY_IRQ,      ///< Audio DMA IRQ
+    TELEMETRY_CORE1,    ///< Core 1
+    TELEMETRY_SOURCES
+} telemetry_source_t;
+
+typedef enum telemetry_type {
+    TELEMETRY_LOAD = 1, ///< f[0] DSP load (render time / real time)
+    TELEMETRY_UNDERRUN, ///< i[0] underruns so far, i[1] duration of the latest one in us
+    TELEMETRY_PARAM,    ///< tag parameter index, f[0] value
+    TELEMETRY_SCOPE,    ///< tag channel, s[0..3] consecutive Q15 samples
+    TELEMETRY_DROPPED,  ///< tag source, i[0] records dropped on that ring since the last report
+    TELEMETRY_LATENCY,  ///< i[0] control change to buffer copy, i[1] to the DMA taking it, in us
+    TELEMETRY_XIP,      ///< i[0] XIP cache accesses, i[1] misses during the last render
+    TELEMETRY_DISPLAY,  ///< i[0] redraw time in us, i[1] main loop passes skipped since the last redraw
+} telemetry_type_t;
+
+/** \brief One record, 16 bytes, little endian on the wire
+ * \ingroup grib_telemetry
+ */
+typedef struct telemetry_record {
+    uint32_t time_us;  ///< Low 32 bits of time_us_64
+    uint8_t type;      ///< telemetry_type_t
+    uint8_t tag;       ///< Type specific
+    uint16_t seq;      ///< Per source counter, gaps are drops
+    union {
+        float f[2];
+        int32_t i[2];
+        int16_t s[4];
+    } data;
+} telemetry_record_t;
+
+static_assert(sizeof(telemetry_record_t) == 16, "telemetry record is 16 bytes on the wire");
+
+/** \brief Transport for framed records; returns false if the bytes could not be sent
+ * \ingroup grib_telemetry
+ */
+typedef bool (*telemetry_write_fn)(const uint8_t *bytes, size_t size, void *ctx);
+
+/** \brief Route drained records to write (NULL discards them)
+ * \ingroup grib_telemetry
+ */
+void telemetry_set_transport(telemetry_write_fn write, void *ctx);
+
+/** \brief Queue a record on the ring of source; time_us and seq are filled in
+ * \ingroup grib_telemetry
+ *
+ * Only ever call with the same source from one context. Returns false if the ring was full.
+ */
+bool telemetry_post(telemetry_source_t source, telemetry_record_t *record);
+
+/** \brief Send up to max records, taking turns between the rings; returns the number sent
+ * \ingroup grib_telemetry
+ */
+uint telemetry_drain(uint max);
+
+/** \brief Write to the USB CDC port, dropping the frame while no host is attached
+ * \ingroup grib_telemetry
+ */
+bool telemetry_usb_write(const uint8_t *bytes, size_t size, void *ctx);
+
+/** \brief Write to a stdio FILE passed as ctx; loopback for host builds
+ * \ingroup grib_telemetry
+ */
+bool telemetry_file_write(const uint8_t *bytes, size_t size, void *ctx);
+
+static inline bool telemetry_load(telemetry_source_t source, float load) {
+    telemetry_record_t r = { .type = TELEMETRY_LOAD };
+    r.data.f[0] = load;
+    return telemetry_post(source, &r);
+}
+
+static inline bool telemetry_underrun(telemetry_source_t source, uint32_t count, uint32_t duration_us) {
+    telemetry_record_t r = { .type = TELEMETRY_UNDERRUN };
+    r.data.i[0] = (int32_t) count;
+    r.data.i[1] = (int32_t) duration_us;
+    return telemetry_post(source, &r);
+}
+
+static inline bool telemetry_param(telemetry_source_t source, uint8_t index, float value) {
+    telemetry_record_t r = { .type = TELEMETRY_PARAM, .tag = index };
+    r.data.f[0] = value;
+    return telemetry_post(source, &r);
+}
+
+static inline bool telemetry_scope(telemetry_source_t source, uint8_t channel, const int16_t samples[4]) {
+    telemetry_record_t r = { .type = TELEMETRY_SCOPE, .tag = channel };
+    memcpy(r.data.s, samples, sizeof r.data.s);
+    return telemetry_post(source, &r);
+}
+
+static inline bool telemetry_latency(telemetry_source_t source, uint32_t produced_us, uint32_t total_us) {
+    telemetry_record_t r = { .type = TELEMETRY_LATENCY };
+    r.data.i[0] = (int32_t) produced_us;
+    r.data.i[1] = (int32_t) total_us;
+    return telemetry_post(source, &r);
+}
+
+static inline bool telemetry_xip(telemetry_source_t source, uint32_t accesses, uint32_t misses) {
+    telemetry_record_t r = { .type = TELEMETRY_XIP };
+    r.data.i[0] = (int32_t) accesses;
+    r.data.i[1] = (int32_t) misses;
+    return telemetry_post(source, &r);
+}
+
+static inline bool telemetry_display(telemetry_source_t source, uint32_t redraw_us, uint32_t skipped) {
+    telemetry_record_t r = { .type = TELEMETRY_DISPLAY };
+    r.data.i[0] = (int32_t) redraw_us;
+    r.data.i[1] = (int32_t) skipped;
+    return telemetry_post(source, &r);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_TELEMETRY_H
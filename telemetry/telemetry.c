@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "telemetry.h"
+
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#endif
+
+static_assert(!(TELEMETRY_RING_LENGTH & (TELEMETRY_RING_LENGTH - 1)), "TELEMETRY_RING_LENGTH must be a power of two");
+
+// head is only written by the producer, tail only by the consumer
+typedef struct telemetry_ring {
+    telemetry_record_t records[TELEMETRY_RING_LENGTH];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;   ///< Written by the producer
+    uint32_t reported;  ///< Drops already sent, written by the consumer
+    uint16_t seq;
+} telemetry_ring_t;
+
+static telemetry_ring_t rings[TELEMETRY_SOURCES];
+static telemetry_write_fn transport_write;
+static void *transport_ctx;
+static uint next_ring;
+
+void telemetry_set_transport(telemetry_write_fn write, void *ctx) {
+    transport_write = write;
+    transport_ctx = ctx;
+}
+
+bool telemetry_post(telemetry_source_t source, telemetry_record_t *record) {
+    assert(source < TELEMETRY_SOURCES);
+    telemetry_ring_t *ring = &rings[source];
+    uint32_t head = ring->head;
+    record->time_us = time_us_32();
+    record->seq = ring->seq++;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= TELEMETRY_RING_LENGTH) {
+        ring->dropped++;
+        return false;
+    }
+    ring->records[head & (TELEMETRY_RING_LENGTH - 1)] = *record;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool telemetry_send(const telemetry_record_t *record) {
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    uint8_t sum = 0;
+    frame[0] = TELEMETRY_SYNC0;
+    frame[1] = TELEMETRY_SYNC1;
+    memcpy(frame + 2, record, sizeof *record);
+    for (uint i = 0; i < sizeof *record; i++) {
+        sum += frame[2 + i];
+    }
+    frame[TELEMETRY_FRAME_SIZE - 1] = sum;
+    return !transport_write || transport_write(frame, sizeof frame, transport_ctx);
+}
+
+uint telemetry_drain(uint max) {
+    uint sent = 0;
+    uint idle = 0;
+    while (sent < max && idle < TELEMETRY_SOURCES) {
+        telemetry_ring_t *ring = &rings[next_ring];
+        telemetry_source_t source = (telemetry_source_t) next_ring;
+        next_ring = (next_ring + 1) % TELEMETRY_SOURCES;
+
+        uint32_t dropped = ring->dropped;
+        if (dropped != ring->reported) {
+            telemetry_record_t r = { .time_us = time_us_32(), .type = TELEMETRY_DROPPED, .tag = (uint8_t) source };
+            r.data.i[0] = (int32_t) (dropped - ring->reported);
+            if (!telemetry_send(&r)) break;
+            ring->reported = dropped;
+            sent++;
+            idle = 0;
+            continue;
+        }
+        uint32_t tail = ring->tail;
+        if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+            idle++;
+            continue;
+        }
+        if (!telemetry_send(&ring->records[tail & (TELEMETRY_RING_LENGTH - 1)])) break;
+        __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+        sent++;
+        idle = 0;
+    }
+    return sent;
+}
+
+bool telemetry_usb_write(const uint8_t *bytes, size_t size, void *ctx) {
+    (void) ctx;
+#if LIB_PICO_STDIO_USB
+    // raw driver output, no CR/LF translation; frames are dropped while nobody listens
+    if (stdio_usb_connected()) {
+        stdio_usb.out_chars((const char *) bytes, (int) size);
+    }
+#else
+    (void) bytes;
+    (void) size;
+#endif
+    return true;
+}
+
+bool telemetry_file_write(const uint8_t *bytes, size_t size, void *ctx) {
+    return fwrite(bytes, 1, size, (FILE *) ctx) == size;
+}
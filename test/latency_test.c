@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Latency probe bookkeeping on the host
+////////////////////////////////////////////////////////////////////////////////////
+// Drives latency.c the way grib.c does, with producer buffers of PRODUCER_FRAMES and
+// consumer buffers of CONSUMER_FRAMES: the producer refills while fewer than
+// QUEUE_FRAMES are waiting, the consumer takes one buffer per tick through
+// latency_effect. A probe is stamped at every tick phase in turn; it has to complete
+// on exactly the consumer take that holds the first frame of the producer buffer
+// carrying the change, no earlier (the queue wait counts) and no later.
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "latency.h"
+
+#define PRODUCER_FRAMES 1156    // SAMPLES_PER_BUFFER in grib.c
+#define CONSUMER_FRAMES 256     // PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH
+#define QUEUE_FRAMES    (3 * PRODUCER_FRAMES)
+#define PROBES          200
+
+static uint32_t produced, consumed;
+
+// The producer's i2s_callback_func: one buffer if there is room, true if it gave one
+static bool produce(void)
+{
+    if (produced - consumed >= QUEUE_FRAMES) return false;
+    latency_produced(PRODUCER_FRAMES);
+    produced += PRODUCER_FRAMES;
+    return true;
+}
+
+static void consume(void)
+{
+    audio_buffer_t b = { .sample_count = CONSUMER_FRAMES };
+    latency_effect.process(&latency_effect, &b);
+    consumed += CONSUMER_FRAMES;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(void)
+{
+    uint32_t copied_us, total_us;
+    int failed = 0, completed = 0;
+    latency_init();
+    produce();
+
+    for (int p = 0; p < PROBES; p++)
+    {
+        // Knob moved, rendered; the next buffer given carries it
+        for (int i = 0; i < p % 7; i++) { consume(); produce(); }
+        latency_stamp();
+        latency_rendered();
+        while (!produce()) consume();
+        uint32_t target = produced - PRODUCER_FRAMES;
+
+        for (int takes = 0; ; takes++)
+        {
+            bool holds = consumed <= target && target < consumed + CONSUMER_FRAMES;
+            consume();
+            produce();
+            bool done = latency_poll(&copied_us, &total_us);
+            if (done != holds)
+            {
+                printf("probe %d: frame %lu, take %d of frames %lu.., %s\n", p, (unsigned long)target, takes,
+                       (unsigned long)(consumed - CONSUMER_FRAMES), done ? "completed early" : "missed");
+                failed = 1;
+                break;
+            }
+            if (done)
+            {
+                completed++;
+                break;
+            }
+        }
+        if (failed) break;
+    }
+
+    latency_stats s;
+    latency_get(&s);
+    printf("%d of %d probes completed on the consumer buffer holding their frame, %lu counted\n",
+           completed, PROBES, (unsigned long)s.count);
+    return failed || s.count != PROBES;
+}
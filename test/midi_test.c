@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIDI parser and queue on the host
+////////////////////////////////////////////////////////////////////////////////////
+// Byte level: short streams through midi_parse, each against the messages it has to
+// give and the sysex and stray bytes it has to count. Realtime bytes inside a message,
+// a running status and a sysex, sysex skipped up to F7 or the next status byte, and
+// the system common messages (F1, F2, F3 with data, F6 on its own, F4/F5 undefined)
+// clearing the running status.
+//
+// Stream: a standard MIDI file (data/midi_test.mid, one track, 49 channel messages
+// with running status as stored, velocity 0 note offs, bends, CCs, program changes,
+// channel pressure, sysex and meta events) played into midi_feed on MIDI_UART at its
+// event times, a MIDI clock on MIDI_USB next to it. The renderer's side takes the
+// messages at every block boundary (midi_take) and places them (midi_offset). Every
+// channel message of the file has to come out once, in order, with its time, and land
+// one block after it arrived; the clocks interleave in time order. Nothing may be
+// dropped and no byte may be stray.
+//
+//   grib_midi_test data/midi_test.mid
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "midi.h"
+
+#define RATE      44100
+#define BLOCK     1156          // SAMPLES_PER_BUFFER in grib.c
+#define FILE_MAX  65536
+#define BYTES_MAX 65536
+#define CLOCK_US  20833         // 24 per quarter note at 120 bpm
+
+////////////////////////////////////////////////////////////////////////////////////
+// Byte level
+typedef struct
+{
+    const char* name;
+    uint8_t     bytes[16];
+    unsigned    size;
+    uint8_t     expect[6][3];   // status, data[0], data[1]
+    unsigned    messages;
+    uint32_t    skipped;
+    uint32_t    stray;
+
+} parse_case;
+
+static const parse_case parse_cases[] =
+{
+    { "running status",           { 0x90, 60, 100, 61, 0 }, 5,
+      { { 0x90, 60, 100 }, { 0x90, 61, 0 } }, 2, 0, 0 },
+    { "realtime inside message",  { 0x90, 60, 0xF8, 100, 61, 0xFA, 0 }, 7,
+      { { 0xF8, 0, 0 }, { 0x90, 60, 100 }, { 0xFA, 0, 0 }, { 0x90, 61, 0 } }, 4, 0, 0 },
+    { "undefined realtime",       { 0x90, 0xF9, 60, 0xFD, 100 }, 5,
+      { { 0x90, 60, 100 } }, 1, 0, 0 },
+    { "one data byte",            { 0xC0, 5, 6, 0xD1, 0xF8, 7 }, 6,
+      { { 0xC0, 5, 0 }, { 0xC0, 6, 0 }, { 0xF8, 0, 0 }, { 0xD1, 7, 0 } }, 4, 0, 0 },
+    { "sysex skipped",            { 0x90, 60, 100, 0xF0, 1, 2, 0xF8, 3, 0xF7, 62, 1 }, 11,
+      { { 0x90, 60, 100 }, { 0xF8, 0, 0 } }, 2, 3, 2 },
+    { "sysex ended by status",    { 0xF0, 1, 2, 0x91, 62, 70 }, 6,
+      { { 0x91, 62, 70 } }, 1, 2, 0 },
+    { "F3 cancels pending",       { 0x91, 62, 0xF3, 5, 70, 1 }, 6,
+      { { 0xF3, 5, 0 } }, 1, 0, 2 },
+    { "F6 on its own",            { 0xB0, 0xF6, 7, 0xF6 }, 4,
+      { { 0xF6, 0, 0 }, { 0xF6, 0, 0 } }, 2, 0, 1 },
+    { "F2 two data bytes",        { 0xB0, 7, 90, 0xF2, 1, 2, 3 }, 7,
+      { { 0xB0, 7, 90 }, { 0xF2, 1, 2 } }, 2, 0, 1 },
+    { "F1 quarter frame",         { 0xF1, 0x23, 0xF1, 0xF8, 0x45 }, 5,
+      { { 0xF1, 0x23, 0 }, { 0xF8, 0, 0 }, { 0xF1, 0x45, 0 } }, 3, 0, 0 },
+    { "F5 undefined",             { 0x90, 60, 100, 0xF5, 61, 0 }, 6,
+      { { 0x90, 60, 100 } }, 1, 0, 2 },
+};
+
+static int parse_test(void)
+{
+    int failed = 0;
+    for (unsigned c = 0; c < sizeof parse_cases / sizeof parse_cases[0]; c++)
+    {
+        const parse_case* t = &parse_cases[c];
+        midi_parser_t p;
+        midi_parser_init(&p);
+        unsigned n = 0;
+        bool ok = true;
+        for (unsigned i = 0; i < t->size; i++)
+        {
+            midi_message_t m;
+            if (!midi_parse(&p, t->bytes[i], &m)) continue;
+            ok &= n < t->messages && m.status == t->expect[n][0] && m.data[0] == t->expect[n][1] &&
+                  m.data[1] == t->expect[n][2];
+            n++;
+        }
+        ok &= n == t->messages && p.skipped == t->skipped && p.stray == t->stray;
+        printf("%-24s %u messages, skipped %lu, stray %lu  %s\n", t->name, n, (unsigned long)p.skipped,
+               (unsigned long)p.stray, ok ? "ok" : "FAIL");
+        failed |= !ok;
+    }
+    return failed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Stream
+typedef struct
+{
+    uint32_t time_us;
+    uint8_t  byte;
+
+} timed_byte;
+
+static uint8_t        file[FILE_MAX];
+static timed_byte     bytes[BYTES_MAX];
+static midi_message_t expect[BYTES_MAX / 2];
+static unsigned       nbytes, nexpect;
+
+static uint32_t vlq(const uint8_t** p, const uint8_t* end)
+{
+    uint32_t v = 0;
+    while (*p < end)
+    {
+        uint8_t b = *(*p)++;
+        v = (v << 7) | (b & 0x7F);
+        if (!(b & 0x80)) break;
+    }
+    return v;
+}
+
+static void put(uint32_t t, uint8_t b)
+{
+    if (nbytes < BYTES_MAX) bytes[nbytes++] = (timed_byte){ t, b };
+}
+
+// The first track of a format 0 or 1 file as the bytes on the wire, and its channel
+// messages with the running status spelled out. One tempo for the whole track.
+static bool read_smf(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    size_t len = fread(file, 1, sizeof file, f);
+    fclose(f);
+    if (len < 22 || memcmp(file, "MThd", 4) || memcmp(file + 8 + file[7], "MTrk", 4)) return false;
+
+    uint32_t ppq = (file[12] << 8) | file[13];
+    const uint8_t* p = file + 8 + file[7] + 8;
+    const uint8_t* end = file + len;
+    uint64_t ticks = 0, tempo = 500000;
+    uint8_t status = 0;
+    while (p < end)
+    {
+        ticks += vlq(&p, end);
+        uint32_t t = (uint32_t)(ticks * tempo / ppq);
+        if (*p == 0xFF)
+        {
+            uint8_t type = p[1];
+            p += 2;
+            uint32_t l = vlq(&p, end);
+            if (type == 0x51 && l == 3) tempo = (p[0] << 16) | (p[1] << 8) | p[2];
+            p += l;
+            continue;
+        }
+        if (*p == 0xF0 || *p == 0xF7)
+        {
+            // F0 <length> <data>: on the wire F0 <data>; F7 <length> <bytes> as they are
+            if (*p == 0xF0) put(t, 0xF0);
+            p++;
+            uint32_t l = vlq(&p, end);
+            for (uint32_t i = 0; i < l; i++) put(t, p[i]);
+            p += l;
+            status = 0;
+            continue;
+        }
+        // Channel event, the running status as stored in the file
+        if (*p & 0x80) put(t, status = *p++);
+        unsigned n = (status & 0xE0) == 0xC0 ? 1 : 2;
+        midi_message_t m = { .time_us = t, .status = status, .source = MIDI_UART };
+        for (unsigned i = 0; i < n; i++) put(t, m.data[i] = *p++);
+        expect[nexpect++] = m;
+    }
+    return true;
+}
+
+static int stream_test(const char* path)
+{
+    if (!read_smf(path))
+    {
+        printf("cannot read %s\n", path);
+        return 1;
+    }
+    unsigned next = 0, got = 0, clocks = 0, clocks_fed = 0, bad = 0;
+    uint32_t since = 0, last = 0, clock_at = 0;
+    long lat_min = BLOCK, lat_max = 0;
+    for (uint32_t k = 1; got < nexpect && k < 100000; k++)
+    {
+        uint32_t now = (uint32_t)((uint64_t)k * BLOCK * 1000000 / RATE);
+        // Bytes and clocks that arrived during the block, in time order
+        while ((next < nbytes && bytes[next].time_us < now) || clock_at < now)
+        {
+            bool uart = next < nbytes && bytes[next].time_us < now;
+            if (uart && (clock_at >= now || bytes[next].time_us <= clock_at))
+            {
+                midi_feed(MIDI_UART, &bytes[next].byte, 1, bytes[next].time_us);
+                next++;
+            }
+            else
+            {
+                uint8_t clock = MIDI_CLOCK;
+                midi_feed(MIDI_USB, &clock, 1, clock_at);
+                clock_at += CLOCK_US;
+                clocks_fed++;
+            }
+        }
+        midi_message_t m;
+        while (midi_take(&m, now))
+        {
+            if ((int32_t)(m.time_us - last) < 0) bad++;
+            last = m.time_us;
+            // Sample position against the arrival time: one block late, give or take the
+            // rounding of the boundary and of the offset to whole microseconds and samples
+            long at = (long)k * BLOCK + midi_offset(&m, since, RATE, BLOCK);
+            long lat = at - (long)((uint64_t)m.time_us * RATE / 1000000);
+            if (lat < lat_min) lat_min = lat;
+            if (lat > lat_max) lat_max = lat;
+            if (m.source == MIDI_USB)
+            {
+                bad += m.status != MIDI_CLOCK;
+                clocks++;
+                continue;
+            }
+            const midi_message_t* e = &expect[got];
+            if (got >= nexpect || m.status != e->status || m.data[0] != e->data[0] ||
+                m.data[1] != e->data[1] || m.time_us != e->time_us)
+            {
+                if (bad < 5) printf("message %u: %02x %u %u at %lu\n", got, m.status, m.data[0], m.data[1],
+                                    (unsigned long)m.time_us);
+                bad++;
+            }
+            got++;
+        }
+        since = now;
+    }
+
+    midi_stats_t s;
+    midi_get_stats(&s);
+    bool ok = !bad && got == nexpect && clocks == clocks_fed && lat_min >= BLOCK - 1 && lat_max <= BLOCK + 1 &&
+              !s.dropped[MIDI_UART] && !s.dropped[MIDI_USB] && !s.stray[MIDI_UART] && !s.stray[MIDI_USB];
+    printf("%u bytes, %u of %u messages, %u clocks, %u wrong, latency %ld .. %ld samples, "
+           "sysex skipped %lu, dropped %lu, stray %lu  %s\n", nbytes, got, nexpect, clocks, bad, lat_min,
+           lat_max, (unsigned long)s.skipped[MIDI_UART], (unsigned long)(s.dropped[0] + s.dropped[1]),
+           (unsigned long)(s.stray[0] + s.stray[1]), ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: grib_midi_test file.mid\n");
+        return 2;
+    }
+    int failed = parse_test();
+    failed |= stream_test(argv[1]);
+    return failed;
+}
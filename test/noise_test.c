@@ -0,0 +1,212 @@
+////////////////////////////////////////////////////////////////////////////////////
+// PRNG and noise statistics on the host
+////////////////////////////////////////////////////////////////////////////////////
+// cell/random.h:
+//   mean    of 2^24 prng_float draws, against 1/2
+//   chi2    of the same draws in 256 bins (255 degrees of freedom)
+//   serial  lag-1 correlation of the draws
+//   range   prng_range(n) for several n: chi2 of the n buckets, and never >= n
+//   repro   the same seed gives the same sequence, nearby seeds unrelated ones
+//
+// cell/noise.c: white, pink and blue noise through their block renders, the averaged
+// spectrum of windowed FFT frames summed per octave. Each octave step has to stay
+// within the bound of its colour: white flat, pink -3 dB/oct, blue +3 dB/oct (less
+// towards Nyquist, where the first difference flattens out: +2.3 and +1.3 dB in the
+// top two octaves). The same seed has to render the same noise.
+//
+// Bounds leave a margin over the measured figures for the fixed seeds used here; the
+// program prints a table and exits with 1 when a bound is missed.
+////////////////////////////////////////////////////////////////////////////////////
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "random.h"
+#include "noise.h"
+
+#define DRAWS    (1 << 24)
+#define BINS     256
+#define RANGE_N  1000000
+#define FFT_N    4096
+#define FRAMES   400
+#define OCTAVES  10        // Bins 2 .. FFT_N / 2, one octave each
+#define PI       3.14159265358979323846
+
+static int failed;
+
+static void check(const char* what, double value, double lo, double hi)
+{
+    bool ok = value >= lo && value <= hi;
+    printf("%-24s %12.5f  [%g .. %g]  %s\n", what, value, lo, hi, ok ? "ok" : "FAIL");
+    failed |= !ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// random.h
+static void prng_stats(void)
+{
+    static uint32_t bins[BINS];
+    prng r;
+    prng_seed(&r, 1);
+    double sum = 0.0, serial = 0.0, prev = prng_float(&r) - 0.5;
+    bool in_range = true;
+    for (long i = 0; i < DRAWS; i++)
+    {
+        float x = prng_float(&r);
+        in_range &= x >= 0.0f && x < 1.0f;
+        bins[(int)(x * BINS)]++;
+        sum += x;
+        serial += (x - 0.5) * prev;
+        prev = x - 0.5;
+    }
+    // Drawn apart, so the float draws above are back to back
+    for (long i = 0; i < DRAWS / 16; i++)
+    {
+        float y = prng_bipolar(&r);
+        in_range &= y >= -1.0f && y < 1.0f;
+    }
+    double expect = (double)DRAWS / BINS, chi2 = 0.0;
+    for (int i = 0; i < BINS; i++) chi2 += (bins[i] - expect) * (bins[i] - expect) / expect;
+
+    check("float, bipolar in range", in_range, 1, 1);
+    check("float mean", sum / DRAWS, 0.4995, 0.5005);
+    // 255 degrees of freedom: 0.1 % tails at about 190 and 330
+    check("float chi2 (255)", chi2, 190.0, 330.0);
+    // Standard deviation 2^-12 for 2^24 draws
+    check("float serial corr", serial / DRAWS * 12.0, -1e-3, 1e-3);
+
+    static const unsigned sizes[] = { 2, 3, 10, 100, 1000, 65536 };
+    for (unsigned s = 0; s < sizeof sizes / sizeof sizes[0]; s++)
+    {
+        static uint32_t count[65536];
+        unsigned n = sizes[s];
+        memset(count, 0, sizeof count);
+        bool below = true;
+        for (long i = 0; i < RANGE_N; i++)
+        {
+            unsigned v = prng_range(&r, n);
+            below &= v < n;
+            count[v < n ? v : 0]++;
+        }
+        double e = (double)RANGE_N / n, c = 0.0;
+        for (unsigned i = 0; i < n; i++) c += (count[i] - e) * (count[i] - e) / e;
+        char what[32];
+        snprintf(what, sizeof what, "range %u below n", n);
+        check(what, below, 1, 1);
+        // Five standard deviations over the n - 1 degrees of freedom
+        snprintf(what, sizeof what, "range %u chi2 (%u)", n, n - 1);
+        check(what, c, 0.0, n - 1 + 5.0 * sqrt(2.0 * (n - 1)));
+    }
+
+    prng a, b;
+    prng_seed(&a, 7);
+    prng_seed(&b, 7);
+    int same = 0;
+    for (int i = 0; i < 1000; i++) same += prng_next(&a) == prng_next(&b);
+    check("same seed, same of 1000", same, 1000, 1000);
+    // Seeds 7 and 8 give sequences that share no more than chance
+    prng_seed(&a, 7);
+    prng_seed(&b, 8);
+    int bits = 0;
+    for (int i = 0; i < 1000; i++) bits += __builtin_popcount(prng_next(&a) ^ prng_next(&b));
+    check("seed 7 vs 8, bits differ", bits / 32000.0, 0.48, 0.52);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// noise.c
+static void fft(double complex* a, int n)
+{
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) { double complex t = a[i]; a[i] = a[j]; a[j] = t; }
+    }
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        double complex w = cexp(-2.0 * PI * I / len);
+        for (int i = 0; i < n; i += len)
+        {
+            double complex x = 1.0;
+            for (int j = 0; j < len / 2; j++, x *= w)
+            {
+                double complex u = a[i + j], v = a[i + j + len / 2] * x;
+                a[i + j] = u + v;
+                a[i + j + len / 2] = u - v;
+            }
+        }
+    }
+}
+
+typedef void (*noise_render)(noise*, float*, unsigned);
+
+// Level of octave k (bins 2^(k+1) .. 2^(k+2)) in dB, mean power per bin
+static void spectrum(noise_render render, uint32_t seed, double* octave)
+{
+    static double complex a[FFT_N];
+    static double power[FFT_N / 2];
+    static float block[FFT_N];
+    noise o;
+    noise_init(&o, seed);
+    memset(power, 0, sizeof power);
+    for (int f = 0; f < FRAMES; f++)
+    {
+        render(&o, block, FFT_N);
+        for (int i = 0; i < FFT_N; i++) a[i] = block[i] * (0.5 - 0.5 * cos(2.0 * PI * i / FFT_N));
+        fft(a, FFT_N);
+        for (int i = 1; i < FFT_N / 2; i++) power[i] += creal(a[i] * conj(a[i]));
+    }
+    for (int k = 0; k < OCTAVES; k++)
+    {
+        int lo = 2 << k, hi = 4 << k;
+        if (hi > FFT_N / 2) hi = FFT_N / 2;
+        double e = 0.0;
+        for (int i = lo; i < hi; i++) e += power[i];
+        octave[k] = 10.0 * log10(e / (hi - lo));
+    }
+}
+
+// Every octave step within lo .. hi dB, the top one within top_lo .. hi
+static void slopes(const char* name, noise_render render, double lo, double hi, double top_lo)
+{
+    double octave[OCTAVES];
+    spectrum(render, 42, octave);
+    printf("%-5s dB/oct:", name);
+    bool ok = true;
+    for (int k = 1; k < OCTAVES; k++)
+    {
+        double d = octave[k] - octave[k - 1];
+        ok &= d >= (k == OCTAVES - 1 ? top_lo : lo) && d <= hi;
+        printf(" %+.2f", d);
+    }
+    printf("  [%+g .. %+g]  %s\n", lo, hi, ok ? "ok" : "FAIL");
+    failed |= !ok;
+
+    // Same seed, same noise; another seed, other noise
+    static float x[FFT_N], y[FFT_N];
+    noise a, b;
+    noise_init(&a, 5);
+    noise_init(&b, 5);
+    render(&a, x, FFT_N);
+    render(&b, y, FFT_N);
+    bool same = memcmp(x, y, sizeof x) == 0;
+    noise_init(&b, 6);
+    render(&b, y, FFT_N);
+    bool other = memcmp(x, y, sizeof x) != 0;
+    printf("%-5s same seed %s, other seed %s  %s\n", name, same ? "same" : "differs",
+           other ? "differs" : "same", same && other ? "ok" : "FAIL");
+    failed |= !(same && other);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(void)
+{
+    prng_stats();
+    slopes("white", noise_white_render, -0.5, 0.5, -0.5);
+    slopes("pink",  noise_pink_render,  -3.8, -2.4, -3.8);
+    slopes("blue",  noise_blue_render,   2.0,  3.6,  1.0);
+    return failed;
+}
@@ -0,0 +1,227 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Preset log under power cuts on the host
+////////////////////////////////////////////////////////////////////////////////////
+// preset_file_backend on a temporary file, behind a backend that counts the page
+// programs and sector erases and can cut the power after any number of them. The
+// operation the cut falls on is left half done: half a page programmed, or the first
+// half of a sector erased.
+//
+// SAVES saves of random values, mostly to a few hot slots, against a model of what
+// every slot should hold. One save in CUT_ONE_IN loses power part way; a third of the
+// mounts after a cut lose power too. After a cut the store is mounted again and the
+// slot saved has to hold its old or its new value, every other slot its value. After
+// every save all slots are loaded and checked, and now and then the store is mounted
+// from scratch. At the end, sector erases have to be spread evenly over the region:
+// the head walks it as a ring, so no sector is erased more than one lap ahead of any
+// other, plus the erases the cuts repeated.
+//
+//   grib_preset_test [seeds]    (default 2, seeds 1 .. 30 pass; 4 s a seed)
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "preset.h"
+#include "random.h"
+
+#define SAVES       20000
+#define CUT_ONE_IN  50
+#define NO_CUT      -1
+#define EMPTY       ~0u
+
+static preset_backend_t file;
+static long             budget = NO_CUT;   // Operations left before the power cut
+static unsigned         erases[PRESET_SECTORS];
+
+static bool cut_read(uint32_t offset, void* dst, size_t size, void* ctx)
+{
+    (void)ctx;
+    return file.read(offset, dst, size, file.ctx);
+}
+
+static bool cut_program(uint32_t offset, const void* src, size_t size, void* ctx)
+{
+    (void)ctx;
+    const uint8_t* s = src;
+    for (size_t done = 0; done < size; done += PRESET_PAGE_SIZE)
+    {
+        if (budget == 0)
+        {
+            // Half a page
+            uint8_t page[PRESET_PAGE_SIZE];
+            memset(page, 0xFF, sizeof page);
+            memcpy(page, s + done, sizeof page / 2);
+            file.program(offset + done, page, sizeof page, file.ctx);
+            return false;
+        }
+        if (budget > 0) budget--;
+        if (!file.program(offset + done, s + done, PRESET_PAGE_SIZE, file.ctx)) return false;
+    }
+    return true;
+}
+
+static bool cut_erase(uint32_t offset, void* ctx)
+{
+    (void)ctx;
+    if (budget == 0)
+    {
+        // The first half erased, the second half as it was
+        static uint8_t sector[PRESET_SECTOR_SIZE];
+        file.read(offset, sector, sizeof sector, file.ctx);
+        file.erase(offset, file.ctx);
+        file.program(offset + sizeof sector / 2, sector + sizeof sector / 2, sizeof sector / 2, file.ctx);
+        return false;
+    }
+    if (budget > 0) budget--;
+    erases[offset / PRESET_SECTOR_SIZE]++;
+    return file.erase(offset, file.ctx);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// A preset carrying v, telling apart every slot and value
+static void fill(preset_t* p, unsigned slot, unsigned v)
+{
+    memset(p, 0, sizeof *p);
+    for (int i = 0; i < PATCH_CTLS; i++) p->knob[i] = slot * 1000.0f + v + i * 0.25f;
+    p->patterns = v & 3;
+    p->pattern[0].swing = v;
+    p->patch.count = slot;
+}
+
+static bool holds(const preset_t* p, unsigned slot, unsigned v)
+{
+    preset_t q;
+    fill(&q, slot, v);
+    return memcmp(p, &q, sizeof q) == 0;
+}
+
+// Every slot but skip against the model; returns the mismatches
+static unsigned check(const preset_store_t* st, const unsigned* model, unsigned skip, int save)
+{
+    unsigned errors = 0;
+    for (unsigned s = 0; s < PRESET_SLOTS; s++)
+    {
+        if (s == skip) continue;
+        preset_t q;
+        int r = preset_load(st, s, &q);
+        bool ok = model[s] == EMPTY ? r == PRESET_EEMPTY : r == PRESET_OK && holds(&q, s, model[s]);
+        if (!ok && errors++ == 0) printf("save %d: slot %u load %d, not the value saved last\n", save, s, r);
+    }
+    return errors;
+}
+
+static int run(unsigned seed)
+{
+    FILE* f = tmpfile();
+    if (!f)
+    {
+        printf("no temporary file\n");
+        return 1;
+    }
+    file = preset_file_backend(f);
+    const preset_backend_t backend = { cut_read, cut_program, cut_erase, NULL };
+    memset(erases, 0, sizeof erases);
+    prng rng;
+    prng_seed(&rng, seed);
+
+    preset_store_t st;
+    int r = preset_mount(&st, &backend);
+    if (r != PRESET_OK)
+    {
+        printf("seed %u: blank mount %d\n", seed, r);
+        fclose(f);
+        return 1;
+    }
+    unsigned model[PRESET_SLOTS];
+    for (unsigned s = 0; s < PRESET_SLOTS; s++) model[s] = EMPTY;
+    unsigned errors = 0, cuts = 0, kept_new = 0, kept_old = 0;
+
+    for (int i = 0; i < SAVES && !errors; i++)
+    {
+        unsigned slot = prng_range(&rng, 4) == 0 ? prng_range(&rng, PRESET_SLOTS) : prng_range(&rng, 3);
+        unsigned v = prng_range(&rng, 256);
+        preset_t p;
+        fill(&p, slot, v);
+        bool cut = prng_range(&rng, CUT_ONE_IN) == 0;
+        if (cut) budget = prng_range(&rng, 12);
+        r = preset_save(&st, slot, &p);
+        budget = NO_CUT;
+
+        if (cut && r != PRESET_OK)
+        {
+            cuts++;
+            // Power back, and sometimes lost again while mounting
+            if (prng_range(&rng, 3) == 0)
+            {
+                budget = prng_range(&rng, 6);
+                preset_mount(&st, &backend);
+                budget = NO_CUT;
+            }
+            r = preset_mount(&st, &backend);
+            if (r != PRESET_OK)
+            {
+                printf("seed %u, save %d: mount after the cut %d\n", seed, i, r);
+                errors++;
+                break;
+            }
+            preset_t q;
+            r = preset_load(&st, slot, &q);
+            if (r == PRESET_OK && holds(&q, slot, v))
+            {
+                model[slot] = v;
+                kept_new++;
+            }
+            else if (model[slot] == EMPTY ? r == PRESET_EEMPTY : r == PRESET_OK && holds(&q, slot, model[slot]))
+            {
+                kept_old++;
+            }
+            else
+            {
+                printf("seed %u, save %d: slot %u neither old nor new after the cut (%d)\n", seed, i, slot, r);
+                errors++;
+            }
+            errors += check(&st, model, slot, i);
+            continue;
+        }
+        if (r != PRESET_OK)
+        {
+            printf("seed %u, save %d: save %d\n", seed, i, r);
+            errors++;
+            break;
+        }
+        model[slot] = v;
+        if (i % 97 == 0 && (r = preset_mount(&st, &backend)) != PRESET_OK)
+        {
+            printf("seed %u, save %d: mount %d\n", seed, i, r);
+            errors++;
+            break;
+        }
+        errors += check(&st, model, PRESET_SLOTS, i);
+    }
+    fclose(f);
+
+    // A lap erases every sector once; a cut can repeat an erase, or leave one to the mount
+    unsigned lo = ~0u, hi = 0;
+    for (unsigned s = 0; s < PRESET_SECTORS; s++)
+    {
+        if (erases[s] < lo) lo = erases[s];
+        if (erases[s] > hi) hi = erases[s];
+    }
+    bool even = hi - lo <= 1 + cuts / PRESET_SECTORS;
+    printf("seed %u: %d saves, %u power cuts (%u kept the new value, %u the old), %u errors, "
+           "erases per sector %u .. %u  %s\n", seed, SAVES, cuts, kept_new, kept_old, errors, lo, hi,
+           !errors && even ? "ok" : "FAIL");
+    return errors || !even;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    printf("record %u of %u bytes, preset %u\n", (unsigned)(sizeof(preset_header_t) + sizeof(preset_t)),
+           PRESET_RECORD_SIZE, (unsigned)sizeof(preset_t));
+    unsigned seeds = argc > 1 ? (unsigned)atoi(argv[1]) : 2;
+    int failed = 0;
+    for (unsigned seed = 1; seed <= seeds; seed++) failed |= run(seed);
+    return failed;
+}
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Resampler quality on the host
+////////////////////////////////////////////////////////////////////////////////////
+// Streams a sine through audio_resample (audio/resampler.cpp) in blocks of varying
+// size and measures the output:
+//
+//   THD+N  everything but the tone, after a least squares fit of the tone at the
+//          output rate (gain droop and delay do not count)
+//   ref    the fixed point output against audio_resample_reference, the same kernel
+//          in double precision
+//   alias  a tone above the output Nyquist frequency, level at the output
+//
+// Each case has a bound, taken from the measured figures with a few dB to spare; the
+// program prints a table and exits with 1 when a bound is missed.
+////////////////////////////////////////////////////////////////////////////////////
+#include <cmath>
+#include <cstdio>
+#include "pico/stdlib.h"
+#include "pico/resampler.h"
+#include "arena.h"
+
+#define INPUT     16384
+#define BLOCK_MAX 256
+#define AMPLITUDE 16000.0
+
+static int16_t input[INPUT];
+static int16_t output[INPUT * 4];
+static float   reference[INPUT * 4];
+
+struct test_case
+{
+    const char*               name;
+    audio_resampler_quality_t quality;
+    uint32_t                  in_rate;
+    uint32_t                  out_rate;
+    double                    freq;
+    double                    bound;  // dB: THD+N at most, or for an alias the level at most
+    bool                      alias;
+};
+
+// With 16 taps the transition band is wide: a tone just above the output Nyquist
+// frequency is only partly removed, one an octave above it is gone
+static const test_case cases[] =
+{
+    { "sinc",   AUDIO_RESAMPLER_SINC,   22050, 44100,  5000.0, -76.0, false },
+    { "sinc",   AUDIO_RESAMPLER_SINC,   44100, 48000,  1000.0, -77.0, false },
+    { "sinc",   AUDIO_RESAMPLER_SINC,   44100, 48000, 15000.0, -75.0, false },
+    { "sinc",   AUDIO_RESAMPLER_SINC,   48000, 44100, 12000.0, -76.0, false },
+    { "sinc",   AUDIO_RESAMPLER_SINC,   96000, 48000,  1000.0, -85.0, false },
+    { "sinc",   AUDIO_RESAMPLER_SINC,   48000, 44100, 23500.0, -17.0, true  },
+    { "sinc",   AUDIO_RESAMPLER_SINC,   96000, 48000, 36000.0, -50.0, true  },
+    { "sinc",   AUDIO_RESAMPLER_SINC,   96000, 48000, 40000.0, -80.0, true  },
+    { "linear", AUDIO_RESAMPLER_LINEAR, 44100, 48000,  1000.0, -56.0, false },
+    { "linear", AUDIO_RESAMPLER_LINEAR, 96000, 48000,  1000.0, -85.0, false },
+};
+
+// Output of the whole input, in blocks of 1 .. BLOCK_MAX samples
+static uint stream(audio_resampler_t* r)
+{
+    uint n = 0, block = 1;
+    for (uint i = 0; i < INPUT; i += block, block = block * 7 % BLOCK_MAX + 1)
+    {
+        if (block > INPUT - i) block = INPUT - i;
+        n += audio_resample(r, input + i, block, output + n);
+    }
+    return n;
+}
+
+// Residual of y[0 .. n) after the least squares fit of a + b sin(wt) + c cos(wt), in dB
+// of the fitted tone; with fit false, the level of y against a full AMPLITUDE sine
+static double residual_db(const double* y, uint n, double w, bool fit)
+{
+    double m[3][4] = {};
+    for (uint j = 0; j < n; j++)
+    {
+        double v[3] = { 1.0, std::sin(w * j), std::cos(w * j) };
+        for (int a = 0; a < 3; a++)
+        {
+            for (int b = 0; b < 3; b++) m[a][b] += v[a] * v[b];
+            m[a][3] += v[a] * y[j];
+        }
+    }
+    // Gauss-Jordan on the 3x3 normal equations
+    for (int a = 0; a < 3; a++)
+    {
+        for (int b = 0; b < 3; b++)
+        {
+            if (b == a) continue;
+            double f = m[b][a] / m[a][a];
+            for (int c = a; c < 4; c++) m[b][c] -= f * m[a][c];
+        }
+    }
+    double x[3] = { m[0][3] / m[0][0], m[1][3] / m[1][1], m[2][3] / m[2][2] };
+    double tone = 0.0, rest = 0.0;
+    for (uint j = 0; j < n; j++)
+    {
+        double t = x[1] * std::sin(w * j) + x[2] * std::cos(w * j);
+        double e = fit ? y[j] - x[0] - t : y[j];
+        tone += t * t;
+        rest += e * e;
+    }
+    if (!fit) tone = n * AMPLITUDE * AMPLITUDE / 2.0;
+    return 10.0 * std::log10(rest / tone + 1e-30);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main()
+{
+    static double y[INPUT * 4];
+    int failed = 0;
+
+    printf("# quality  in_rate out_rate  tone Hz   THD+N/alias dB  bound dB  ref dB\n");
+    for (const test_case& c : cases)
+    {
+        for (uint i = 0; i < INPUT; i++)
+            input[i] = (int16_t)std::lrint(AMPLITUDE * std::sin(2.0 * M_PI * c.freq * i / c.in_rate));
+
+        audio_resampler_t r;
+        audio_resampler_init(&r, c.in_rate, c.out_rate, BLOCK_MAX, c.quality);
+        uint n = stream(&r);
+
+        // Skip the kernel's run-in and run-out
+        uint skip = 2 * AUDIO_RESAMPLER_TAPS * c.out_rate / c.in_rate + 2 * AUDIO_RESAMPLER_TAPS;
+        uint m = n - 2 * skip;
+        for (uint j = 0; j < m; j++) y[j] = output[skip + j];
+        // The output's own phase step: output j sits at input j * step / 2^16
+        double w = 2.0 * M_PI * c.freq / c.in_rate * (r.step / 65536.0);
+        double level = residual_db(y, m, w, !c.alias);
+
+        // The fixed point sinc against its double precision kernel, over the same span
+        double ref = NAN;
+        if (c.quality == AUDIO_RESAMPLER_SINC && !c.alias)
+        {
+            uint k = audio_resample_reference(&r, input, INPUT, reference, INPUT * 4);
+            if (k < skip + m) m = k > skip ? k - skip : 0;
+            double e = 0.0, s = 0.0;
+            for (uint j = 0; j < m; j++)
+            {
+                double d = output[skip + j] - reference[skip + j];
+                e += d * d;
+                s += (double)reference[skip + j] * reference[skip + j];
+            }
+            ref = 10.0 * std::log10(s / (e + 1e-30));
+        }
+
+        bool ok = level <= c.bound && (std::isnan(ref) || ref >= 75.0);
+        printf("%-8s %8lu %8lu %8.0f %s %7.1f   %8.1f  %6.1f  %s\n", c.name, (unsigned long)c.in_rate,
+               (unsigned long)c.out_rate, c.freq, c.alias ? "alias" : "THD+N", level, c.bound, ref,
+               ok ? "ok" : "FAIL");
+        failed |= !ok;
+    }
+    return failed;
+}
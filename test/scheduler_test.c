@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Scheduler ordering on the host
+////////////////////////////////////////////////////////////////////////////////////
+// cell/scheduler.h driven the way voice_render_events does, a block split at the
+// event times by sched_span, every event taken with sched_pop:
+//
+//   order      random times in a window, posted in random order: each pops on the
+//              sample it was posted for, in time order
+//   same time  events posted for one sample pop in the order they were posted, also
+//              when posts for other samples come in between
+//   wrap       the clock started just below 2^32 and events on both sides of the
+//              wrap: they pop in time order and on their sample
+//   late       an event posted for a sample already rendered pops at the next block
+//              start and is counted in late
+//   full       the post after SCHED_LENGTH is refused and counted in dropped
+//
+// The program prints a line per case and exits with 1 when one fails.
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "scheduler.h"
+#include "random.h"
+
+#define BLOCK   1156        // SAMPLES_PER_BUFFER in grib.c
+#define ROUNDS  2000
+
+static int failed;
+
+static void report(const char* name, unsigned popped, unsigned bad)
+{
+    printf("%-10s %6u events, %u wrong  %s\n", name, popped, bad, bad ? "FAIL" : "ok");
+    failed |= bad != 0;
+}
+
+// Every post carries its number in value, so the events of one sample have to pop
+// with rising values
+static float posts;
+
+static void post(scheduler* s, uint32_t time)
+{
+    sched_post(s, time, SCHED_PARAM, 0, posts++);
+}
+
+// Renders blocks until the queue is empty. Every event has to pop on its own sample
+// (or at the block start for a late one) and after the one popped before it.
+static unsigned render(scheduler* s, unsigned* popped)
+{
+    unsigned bad = 0, blocks = 0;
+    uint32_t last = s->now;
+    float    last_value = -1.0f;
+    while (s->count && blocks++ < 1000)
+    {
+        uint32_t start = s->now;
+        unsigned n = BLOCK;
+        while (n)
+        {
+            sched_event e;
+            while (sched_pop(s, &e))
+            {
+                bool due = e.time == s->now || (s->now == start && (int32_t)(e.time - s->now) < 0);
+                bool order = (int32_t)(e.time - last) > 0 || (e.time == last && e.value > last_value);
+                if ((!due || !order) && bad++ < 5)
+                    printf("  post %.0f for %lu popped at %lu\n", e.value, (unsigned long)e.time,
+                           (unsigned long)s->now);
+                last = e.time;
+                last_value = e.value;
+                (*popped)++;
+            }
+            unsigned m = sched_span(s, n);
+            sched_advance(s, m);
+            n -= m;
+        }
+    }
+    return bad + (s->count != 0);
+}
+
+static void order_test(prng* r)
+{
+    unsigned popped = 0, bad = 0;
+    scheduler s;
+    sched_init(&s);
+    for (int k = 0; k < ROUNDS; k++)
+    {
+        unsigned n = 1 + prng_range(r, SCHED_LENGTH);
+        for (unsigned i = 0; i < n; i++) post(&s, s.now + prng_range(r, 4 * BLOCK));
+        bad += render(&s, &popped);
+    }
+    bad += s.dropped + s.late;
+    report("order", popped, bad);
+}
+
+static void same_time_test(prng* r)
+{
+    unsigned popped = 0, bad = 0;
+    scheduler s;
+    sched_init(&s);
+    for (int k = 0; k < ROUNDS; k++)
+    {
+        // Four samples, posted for in random turns
+        uint32_t at[4];
+        for (int j = 0; j < 4; j++) at[j] = s.now + prng_range(r, 3 * BLOCK);
+        for (unsigned i = 0; i < SCHED_LENGTH; i++) post(&s, at[prng_range(r, 4)]);
+        bad += render(&s, &popped);
+    }
+    bad += s.dropped + s.late;
+    report("same time", popped, bad);
+}
+
+static void wrap_test(prng* r)
+{
+    unsigned popped = 0, bad = 0;
+    scheduler s;
+    sched_init(&s);
+    for (int k = 0; k < ROUNDS; k++)
+    {
+        s.now = 0u - 2 * BLOCK + prng_range(r, BLOCK);
+        for (unsigned i = 0; i < SCHED_LENGTH; i++) post(&s, s.now + prng_range(r, 4 * BLOCK));
+        bad += render(&s, &popped);
+        // Rendered past the wrap
+        bad += s.now > 4 * BLOCK;
+    }
+    bad += s.dropped + s.late;
+    report("wrap", popped, bad);
+}
+
+static void late_test(void)
+{
+    unsigned popped = 0, bad = 0;
+    scheduler s;
+    sched_init(&s);
+    sched_advance(&s, 10 * BLOCK);
+    sched_post(&s, s.now - 1, SCHED_GATE, 0, 1.0f);
+    sched_post(&s, s.now - BLOCK, SCHED_GATE, 1, 0.0f);
+    sched_post(&s, s.now + 5, SCHED_GATE, 2, 1.0f);
+    // Both late ones are due at s.now, in post order, before the one in the block
+    sched_event e;
+    bad += !sched_pop(&s, &e) || e.target != 0 || e.time != s.now;
+    bad += !sched_pop(&s, &e) || e.target != 1 || e.time != s.now;
+    bad += sched_pop(&s, &e) || sched_span(&s, BLOCK) != 5;
+    bad += render(&s, &popped);
+    bad += s.late != 2;
+    report("late", popped + 2, bad);
+}
+
+static void full_test(void)
+{
+    unsigned bad = 0;
+    scheduler s;
+    sched_init(&s);
+    for (unsigned i = 0; i < SCHED_LENGTH; i++) bad += !sched_post(&s, i, SCHED_GATE, 0, 0.0f);
+    bad += sched_post(&s, 0, SCHED_GATE, 0, 0.0f);
+    bad += s.dropped != 1 || s.count != SCHED_LENGTH;
+    sched_clr(&s);
+    bad += s.count != 0 || !sched_post(&s, 0, SCHED_GATE, 0, 0.0f);
+    report("full", SCHED_LENGTH + 1, bad);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(void)
+{
+    prng r;
+    prng_seed(&r, 1);
+    order_test(&r);
+    same_time_test(&r);
+    wrap_test(&r);
+    late_test();
+    full_test();
+    return failed;
+}
@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Telemetry records through tools/telemetry.py on the host
+////////////////////////////////////////////////////////////////////////////////////
+// Every record type is posted on the ring grib.c posts it from, the IRQ ring is run
+// over so a DROPPED report goes out too, and everything is drained in small bites
+// through telemetry_file_write into a capture, with stdio text written between the
+// drains the way it shares the USB CDC port. The capture is decoded by
+// tools/telemetry.py; every record the transport was given has to come back, in
+// order, with the text the decoder should print for it.
+//
+//   grib_telemetry_test python3 tools/telemetry.py capture.bin
+////////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "telemetry.h"
+
+#define RECORDS  128
+#define LINE     160
+#define OVERRUN  3          // IRQ records posted to a full ring
+
+// tools/telemetry.py names
+static const char* const params[]  = { "freq", "pw", "cutoff", "Q", "amp" };
+static const char* const sources[] = { "main", "irq", "core1" };
+
+static FILE*    capture;
+static char     expect[RECORDS][LINE];
+static unsigned sent;
+
+// The line telemetry.py prints for r, without the time
+static void describe(const telemetry_record_t* r, char* line, size_t size)
+{
+    char text[LINE];
+    const char* name;
+    switch(r->type)
+    {
+    case TELEMETRY_LOAD:
+        name = "load";
+        snprintf(text, sizeof text, "%.1f %%", r->data.f[0] * 100.0);
+        break;
+    case TELEMETRY_UNDERRUN:
+        name = "underrun";
+        snprintf(text, sizeof text, "%d total, last %d us", (int)r->data.i[0], (int)r->data.i[1]);
+        break;
+    case TELEMETRY_PARAM:
+        name = "param";
+        snprintf(text, sizeof text, "%s = %g", params[r->tag], r->data.f[0]);
+        break;
+    case TELEMETRY_SCOPE:
+        name = "scope";
+        snprintf(text, sizeof text, "ch%d %6d %6d %6d %6d", r->tag, r->data.s[0], r->data.s[1], r->data.s[2],
+                 r->data.s[3]);
+        break;
+    case TELEMETRY_DROPPED:
+        name = "dropped";
+        snprintf(text, sizeof text, "%d records on %s", (int)r->data.i[0], sources[r->tag]);
+        break;
+    case TELEMETRY_LATENCY:
+        name = "latency";
+        snprintf(text, sizeof text, "%.2f ms, buffer copy after %.2f ms", r->data.i[1] / 1000.0,
+                 r->data.i[0] / 1000.0);
+        break;
+    case TELEMETRY_XIP:
+        name = "xip";
+        snprintf(text, sizeof text, "%d accesses, %d misses (%.1f %% hit)", (int)r->data.i[0], (int)r->data.i[1],
+                 100.0 * (r->data.i[0] - r->data.i[1]) / r->data.i[0]);
+        break;
+    case TELEMETRY_DISPLAY:
+        name = "display";
+        snprintf(text, sizeof text, "redraw %d us, %d passes skipped", (int)r->data.i[0], (int)r->data.i[1]);
+        break;
+    default:
+        name = "?";
+        text[0] = 0;
+    }
+    snprintf(line, size, "%5d %-8s %s", r->seq, name, text);
+}
+
+// telemetry_file_write, keeping what the decoder should print for every frame
+static bool record_write(const uint8_t* bytes, size_t size, void* ctx)
+{
+    telemetry_record_t r;
+    memcpy(&r, bytes + 2, sizeof r);
+    if (sent < RECORDS) describe(&r, expect[sent++], LINE);
+    return telemetry_file_write(bytes, size, ctx);
+}
+
+static unsigned post_all(void)
+{
+    unsigned posted = 0;
+    posted += telemetry_load(TELEMETRY_MAIN, 0.25f);
+    posted += telemetry_xip(TELEMETRY_MAIN, 4000, 120);
+    for (uint8_t p = 0; p < 5; p++) posted += telemetry_param(TELEMETRY_MAIN, p, 440.0f / (1 << p));
+    posted += telemetry_underrun(TELEMETRY_MAIN, 3, 1500);
+    posted += telemetry_latency(TELEMETRY_MAIN, 8250, 23500);
+    for (int i = 0; i < TELEMETRY_RING_LENGTH + OVERRUN; i++)
+    {
+        const int16_t scope[4] = { (int16_t)i, (int16_t)-i, 32767, -32768 };
+        posted += telemetry_scope(TELEMETRY_IRQ, 0, scope);
+    }
+    posted += telemetry_display(TELEMETRY_CORE1, 2100, 1);
+    posted += telemetry_display(TELEMETRY_CORE1, 1900, 0);
+    return posted;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        printf("usage: grib_telemetry_test python3 telemetry.py capture.bin\n");
+        return 2;
+    }
+    capture = fopen(argv[3], "wb");
+    if (!capture)
+    {
+        printf("cannot write %s\n", argv[3]);
+        return 1;
+    }
+    telemetry_set_transport(record_write, capture);
+    unsigned posted = post_all();
+    // Drained a few at a time, stdio text in between
+    for (unsigned n = 0; telemetry_drain(5) || n == 0; n++) fprintf(capture, "pass %u\r\n", n);
+    fclose(capture);
+    bool counted = posted == 2 + 5 + 2 + TELEMETRY_RING_LENGTH + 2 && sent == posted + 1;
+
+    char cmd[1024];
+    snprintf(cmd, sizeof cmd, "\"%s\" \"%s\" \"%s\"", argv[1], argv[2], argv[3]);
+    FILE* p = popen(cmd, "r");
+    if (!p)
+    {
+        printf("cannot run %s\n", cmd);
+        return 1;
+    }
+    char line[LINE];
+    unsigned got = 0, bad = 0;
+    bool summary = false;
+    while (fgets(line, sizeof line, p))
+    {
+        line[strcspn(line, "\r\n")] = 0;
+        if (strncmp(line, "latency:", 8) == 0)
+        {
+            summary = strstr(line, "1 probes, min 23.50 ms") != NULL;
+            continue;
+        }
+        // Time first, then seq, type and text
+        const char* rest = line + strspn(line, " ");
+        rest += strspn(rest, "0123456789");
+        rest += *rest == ' ';
+        if (got >= sent || strcmp(rest, expect[got]) != 0)
+        {
+            if (bad++ < 5) printf("record %u: \"%s\", expected \"%s\"\n", got, rest, got < sent ? expect[got] : "");
+        }
+        got++;
+    }
+    int status = pclose(p);
+
+    bool ok = counted && !bad && got == sent && summary && status == 0;
+    printf("%u posted, %u sent, %u decoded, %u wrong, latency summary %s  %s\n", posted, sent, got, bad,
+           summary ? "ok" : "missing", ok ? "ok" : "FAIL");
+    return !ok;
+}
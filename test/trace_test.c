@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Trace rings from two threads on the host
+////////////////////////////////////////////////////////////////////////////////////
+// Built with GRIB_TRACE=1. The main thread records one instant, then two threads
+// record EVENTS events each at the same time: begin, counter and end around a
+// counting loop, so the rings wrap. trace_dump is read back and has to hold
+//   - one ring per thread, the main thread's first, each thread on one ring only
+//   - the latest TRACE_LENGTH events of every full ring, in the order recorded: the
+//     counter values consecutive, the kinds in B C E turn, times never going back
+//   - lines of "<ring> <time_us> <B|E|I|C> <value> <name>" between TRACE-BEGIN and
+//     TRACE-END, as tools/trace2chrome.py reads them
+// and after trace_clear an empty dump.
+////////////////////////////////////////////////////////////////////////////////////
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "pico/stdlib.h"
+#include "trace.h"
+
+#define EVENTS   (3 * TRACE_LENGTH)
+#define THREADS  2
+#define LINE     128
+
+static pthread_barrier_t start;
+static const char* const names[THREADS] = { "worker0", "worker1" };
+
+static void* worker(void* arg)
+{
+    const char* name = names[(int)(intptr_t)arg];
+    pthread_barrier_wait(&start);
+    volatile int spin = 0;
+    for (int i = 0; i < EVENTS / 3; i++)
+    {
+        TRACE_BEGIN(name);
+        TRACE_COUNTER(name, i);
+        for (int k = 0; k < 100; k++) spin += k;
+        TRACE_END(name);
+    }
+    return NULL;
+}
+
+// trace_dump into a temporary file instead of stdout
+static FILE* dump(void)
+{
+    FILE* f = tmpfile();
+    fflush(stdout);
+    int saved = dup(1);
+    dup2(fileno(f), 1);
+    trace_dump();
+    fflush(stdout);
+    dup2(saved, 1);
+    close(saved);
+    rewind(f);
+    return f;
+}
+
+typedef struct
+{
+    unsigned events;
+    unsigned counters;
+    const char* name;
+    long last_value;
+    unsigned long last_time;
+    char last_kind;
+
+} ring_check;
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(void)
+{
+    TRACE_INSTANT("main");
+    pthread_barrier_init(&start, NULL, THREADS);
+    pthread_t t[THREADS];
+    for (int i = 0; i < THREADS; i++) pthread_create(&t[i], NULL, worker, (void*)(intptr_t)i);
+    for (int i = 0; i < THREADS; i++) pthread_join(t[i], NULL);
+
+    FILE* f = dump();
+    char line[LINE];
+    ring_check rings[TRACE_RINGS];
+    memset(rings, 0, sizeof rings);
+    unsigned bad = 0, lines = 0;
+    bool begin = false, end = false;
+    while (fgets(line, sizeof line, f))
+    {
+        if (strcmp(line, "TRACE-BEGIN\n") == 0) { begin = true; continue; }
+        if (strcmp(line, "TRACE-END\n") == 0)   { end = true; continue; }
+        unsigned r;
+        unsigned long time;
+        char kind, name[32];
+        long value;
+        lines++;
+        if (sscanf(line, "%u %lu %c %ld %31s", &r, &time, &kind, &value, name) != 5 || r >= TRACE_RINGS)
+        {
+            if (bad++ < 5) printf("malformed: %s", line);
+            continue;
+        }
+        ring_check* c = &rings[r];
+        const char* expect = r == 0 ? "main" : r <= THREADS ? NULL : "";
+        for (int i = 0; i < THREADS && !expect; i++) if (strcmp(name, names[i]) == 0) expect = names[i];
+        bool ok = expect && strcmp(name, expect) == 0 && (!c->name || c->name == expect) && time >= c->last_time;
+        if (r > 0 && c->events)
+        {
+            // B C E in turn, the counter one up from the last one
+            ok &= (c->last_kind == 'B' && kind == 'C') || (c->last_kind == 'C' && kind == 'E') ||
+                  (c->last_kind == 'E' && kind == 'B');
+            if (kind == 'C' && c->counters) ok &= value == c->last_value + 1;
+        }
+        if (kind == 'C')
+        {
+            c->last_value = value;
+            c->counters++;
+        }
+        if (!ok && bad++ < 5) printf("ring %u: %s", r, line);
+        c->name = expect;
+        c->last_time = time;
+        c->last_kind = kind;
+        c->events++;
+    }
+    fclose(f);
+
+    // The threads' rings wrapped: the latest events, up to the last counter
+    for (int r = 1; r <= THREADS; r++)
+    {
+        bool ok = rings[r].events == TRACE_LENGTH && rings[r].last_kind == 'E' &&
+                  rings[r].last_value == EVENTS / 3 - 1 && rings[r].name && rings[r].name != rings[3 - r].name;
+        if (!ok && bad++ < 5) printf("ring %d: %u events, last counter %ld\n", r, rings[r].events, rings[r].last_value);
+    }
+    bad += rings[0].events != 1 || !begin || !end;
+    for (int r = THREADS + 1; r < TRACE_RINGS; r++) bad += rings[r].events != 0;
+
+    // Cleared, nothing left
+    trace_clear();
+    f = dump();
+    unsigned left = 0;
+    while (fgets(line, sizeof line, f)) left += strncmp(line, "TRACE-", 6) != 0;
+    fclose(f);
+
+    bool ok = !bad && !left;
+    printf("%u events on %d threads, %u wrong, %u left after trace_clear  %s\n", lines, THREADS + 1, bad, left,
+           ok ? "ok" : "FAIL");
+    return !ok;
+}
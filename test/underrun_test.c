@@ -0,0 +1,191 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Underrun policies of the I2S driver, simulated on the host
+////////////////////////////////////////////////////////////////////////////////////
+// A sine producer feeds a consumer that misses buffers in gaps of one to three DMA
+// slots, injected the way audio_i2s_inject_underruns does. Every slot goes through the
+// driver's own underrun code (audio_i2s_underrun.c) as the DMA IRQ of audio_i2s.c
+// calls it: audio_i2s_underrun_skip, then audio_i2s_underrun_recover on a real buffer
+// or audio_i2s_underrun_fill in its place; the producer's buffers stay queued and play
+// late.
+//
+// For every policy, at S16 and S32, the output stream is checked for:
+//   step   largest sample to sample jump, against the sine's own slope; SILENCE cuts
+//          out and back in, REPEAT and FADE must not click
+//   level  RMS of the first fill slot of each gap against the sine: REPEAT keeps
+//          playing, FADE fades out
+//   log    one underrun per gap in the stats and the log, with its slots and duration
+// and a table is printed. Exit status 1 when a bound is missed.
+////////////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/audio_i2s.h"
+
+#define RATE        44100
+#define FREQ        441.0
+#define FRAMES      256                  // PICO_AUDIO_I2S_BUFFER_SAMPLE_LENGTH
+#define CHANNELS    2
+#define FADE        64                   // PICO_AUDIO_I2S_UNDERRUN_FADE_SAMPLES
+#define SLOTS       96
+#define SLOT_US     5805                 // FRAMES at RATE
+#define PI          3.14159265358979323846
+
+static const char* const policy_names[] = { "silence", "repeat", "fade" };
+
+// Gaps the producer misses: 1, 2 and 3 buffers
+#define GAPS 3
+static const int gap_slot[GAPS]   = { 10, 30, 60 };
+static const uint gap_length[GAPS] = { 1, 2, 3 };
+
+typedef struct
+{
+    audio_format_t        format;
+    audio_buffer_format_t buffer_format;
+    int32_t               amplitude;
+    double                phase;
+
+} stream;
+
+static void stream_init(stream* s, uint16_t pcm)
+{
+    memset(s, 0, sizeof *s);
+    s->format.sample_freq   = RATE;
+    s->format.pcm_format    = pcm;
+    s->format.channel_count = CHANNELS;
+    s->buffer_format.format = &s->format;
+    s->buffer_format.sample_stride = CHANNELS * (pcm == AUDIO_PCM_FORMAT_S32 ? 4 : 2);
+    s->amplitude = pcm == AUDIO_PCM_FORMAT_S32 ? 0x40000000 : 0x4000;
+}
+
+static int32_t get(const audio_buffer_t* ab, uint i)
+{
+    if (ab->format->format->pcm_format == AUDIO_PCM_FORMAT_S32) return ((const int32_t*)ab->buffer->bytes)[i];
+    return ((const int16_t*)ab->buffer->bytes)[i];
+}
+
+// Next buffer of the producer, continuing the sine where the last one ended
+static void produce(stream* s, audio_buffer_t* ab)
+{
+    for (uint k = 0; k < FRAMES; k++, s->phase += 2.0 * PI * FREQ / RATE)
+    {
+        int32_t v = (int32_t)lrint(s->amplitude * sin(s->phase));
+        for (uint c = 0; c < CHANNELS; c++)
+        {
+            if (s->format.pcm_format == AUDIO_PCM_FORMAT_S32) ((int32_t*)ab->buffer->bytes)[k * CHANNELS + c] = v;
+            else ((int16_t*)ab->buffer->bytes)[k * CHANNELS + c] = (int16_t)v;
+        }
+    }
+    ab->sample_count = FRAMES;
+    ab->format = &s->buffer_format;
+}
+
+typedef struct
+{
+    double step;        // Largest jump / the sine's largest jump
+    double level;       // Smallest first-slot RMS of a gap / the sine's RMS
+    double level_max;   // Largest
+    bool   logged;      // Stats and log agree with the gaps
+
+} result;
+
+static result run(audio_i2s_underrun_policy_t policy, uint16_t pcm)
+{
+    static int32_t data[2][FRAMES * CHANNELS], fill_data[FRAMES * CHANNELS], silent[FRAMES * CHANNELS];
+    mem_buffer_t mem[2]   = { { sizeof data[0], (uint8_t*)data[0], 0 }, { sizeof data[1], (uint8_t*)data[1], 0 } };
+    mem_buffer_t fill_mem = { sizeof fill_data, (uint8_t*)fill_data, 0 };
+    mem_buffer_t zero_mem = { sizeof silent, (uint8_t*)silent, 0 };
+    audio_buffer_t real[2] = { { .buffer = &mem[0] }, { .buffer = &mem[1] } };
+    audio_buffer_t fill    = { .buffer = &fill_mem, .max_sample_count = FRAMES };
+    audio_buffer_t silence = { .buffer = &zero_mem, .sample_count = FRAMES };
+
+    stream s;
+    stream_init(&s, pcm);
+    fill.format = silence.format = &s.buffer_format;
+
+    audio_i2s_underrun_state_t u = { .policy = policy, .fade = FADE, .fill = &fill, .silence = &silence };
+    audio_i2s_stats_t stats = { 0 };
+    const double slope = s.amplitude * 2.0 * PI * FREQ / RATE;
+    const double rms = s.amplitude / sqrt(2.0);
+    result r = { 0.0, INFINITY, 0.0, false };
+    const audio_buffer_t* last = NULL;
+    int32_t prev = 0;
+    int real_next = 0;
+
+    for (int slot = 0; slot < SLOTS; slot++)
+    {
+        uint32_t now_us = slot * SLOT_US;
+        for (int g = 0; g < GAPS; g++) if (slot == gap_slot[g]) u.inject = gap_length[g];
+        const audio_buffer_t* play;
+        if (audio_i2s_underrun_skip(&u))
+        {
+            uint32_t underruns = stats.underruns;
+            play = audio_i2s_underrun_fill(&u, last, now_us, &stats);
+            if (stats.underruns != underruns)
+            {
+                double sum = 0.0;
+                for (uint k = 0; k < play->sample_count; k++) sum += (double)get(play, k * CHANNELS) * get(play, k * CHANNELS);
+                double level = sqrt(sum / play->sample_count) / rms;
+                if (level < r.level)     r.level = level;
+                if (level > r.level_max) r.level_max = level;
+            }
+        }
+        else
+        {
+            // The producer's next buffer, late after a gap
+            audio_buffer_t* ab = &real[real_next ^= 1];
+            produce(&s, ab);
+            audio_i2s_underrun_recover(&u, ab, now_us);
+            play = last = ab;
+        }
+        for (uint k = 0; k < play->sample_count; k++)
+        {
+            int32_t v = get(play, k * CHANNELS);
+            double step = fabs((double)v - prev) / slope;
+            if ((slot || k) && step > r.step) r.step = step;
+            if (get(play, k * CHANNELS + 1) != v) r.step = INFINITY;  // Channels stay equal
+            prev = v;
+        }
+    }
+
+    r.logged = stats.underruns == GAPS && stats.silence == 1 + 2 + 3 && u.logged == GAPS && !u.active;
+    for (int g = 0; g < GAPS; g++)
+    {
+        const audio_i2s_underrun_t* e = &u.log[g];
+        r.logged &= e->start_us == gap_slot[g] * SLOT_US && e->buffers == gap_length[g] &&
+                    e->duration_us == gap_length[g] * SLOT_US;
+    }
+    return r;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+int main(void)
+{
+    static const uint16_t formats[] = { AUDIO_PCM_FORMAT_S16, AUDIO_PCM_FORMAT_S32 };
+    int failed = 0;
+
+    printf("# policy  format  step/slope  gap level (min .. max)  log\n");
+    for (int f = 0; f < 2; f++)
+    {
+        for (int p = AUDIO_I2S_UNDERRUN_SILENCE; p <= AUDIO_I2S_UNDERRUN_FADE; p++)
+        {
+            result r = run((audio_i2s_underrun_policy_t)p, formats[f]);
+            bool ok;
+            switch (p)
+            {
+                // A hard cut: the simulation has to see it, or it would not see a click either
+                case AUDIO_I2S_UNDERRUN_SILENCE: ok = r.step > 8.0 && r.level_max == 0.0; break;
+                // Continuous through the gap, at the sine's level
+                case AUDIO_I2S_UNDERRUN_REPEAT:  ok = r.step < 2.0 && r.level > 0.7 && r.level_max < 1.1; break;
+                // Continuous, faded out within the first slot
+                default:                         ok = r.step < 2.0 && r.level < 0.5; break;
+            }
+            ok &= r.logged;
+            printf("%-9s %s  %10.2f  %.3f .. %.3f  %s  %s\n", policy_names[p], f ? "S32" : "S16",
+                   r.step, r.level, r.level_max, r.logged ? "logged" : "log wrong", ok ? "ok" : "FAIL");
+            failed |= !ok;
+        }
+    }
+    return failed;
+}
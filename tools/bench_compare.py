@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Compare a grib_bench capture against a baseline.
+
+    bench_compare.py capture.txt --baseline base.txt                  # fail above +10 %
+    bench_compare.py capture.txt --baseline base.txt --tolerance 0.05 # fail above +5 %
+    bench_compare.py capture.txt --baseline base.json --update        # make capture the baseline
+    bench_compare.py ram.txt --baseline xip.txt --field cold_ns_per_sample
+                                                    # SRAM kernels against grib_bench_xip
+    bench_compare.py run1.txt run2.txt run3.txt --baseline tools/bench_baseline_host.json \
+        --calibrate calibrate --tolerance 1.5 --exclude tail_ --exclude runaway_
+                                                    # the host test (test/CMakeLists.txt)
+
+The capture is the serial output of grib_bench; everything outside
+BENCH-BEGIN / BENCH-END is ignored, so a raw terminal log works. "-" reads
+stdin. With several captures the fastest of each result counts, which steadies
+a baseline taken on a busy host. Exits 1 when a kernel got slower than the
+tolerance allows, 2 on malformed input.
+
+Absolute times only compare on the same clock and machine. With --calibrate every
+result is taken relative to the named kernel at the same block size in the same
+run, on both sides, so a faster or slower host cancels out.
+"""
+import argparse
+import json
+import os
+import sys
+
+
+def load(path):
+    if path == "-":
+        text = sys.stdin.read()
+    else:
+        with open(path) as f:
+            text = f.read()
+    begin = text.find("BENCH-BEGIN")
+    end = text.find("BENCH-END")
+    if begin >= 0 and end > begin:
+        text = text[begin + len("BENCH-BEGIN"):end]
+    return json.loads(text)
+
+
+def fastest(runs):
+    run = runs[0]
+    for other in runs[1:]:
+        best = {(r["kernel"], r["block"]): r for r in other["results"]}
+        for r in run["results"]:
+            o = best.get((r["kernel"], r["block"]), {})
+            for key, value in o.items():
+                if key.endswith("ns_per_sample") and value < r.get(key, value + 1):
+                    r[key] = value
+                    if key == "ns_per_sample":
+                        r["samples_per_s"] = round(1e9 / value) if value > 0 else r.get("samples_per_s")
+    return run
+
+
+def index(run, field, calibrate=None):
+    values = {(r["kernel"], r["block"]): r[field] for r in run["results"] if field in r}
+    if not calibrate:
+        return values
+    scale = {block: value for (kernel, block), value in values.items() if kernel == calibrate}
+    return {key: value / scale[key[1]] for key, value in values.items()
+            if key[0] != calibrate and scale.get(key[1], 0.0) > 0.0}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("capture", nargs="+")
+    ap.add_argument("--baseline", required=True, help="capture or JSON to compare against (written by --update)")
+    ap.add_argument("--tolerance", type=float, default=0.10, help="allowed slowdown, 0.10 = 10 %%")
+    ap.add_argument("--update", action="store_true", help="write the capture as the baseline")
+    ap.add_argument("--field", default="ns_per_sample", help="result to compare, e.g. cold_ns_per_sample")
+    ap.add_argument("--exclude", action="append", default=[], metavar="PREFIX",
+                    help="skip kernels whose name starts with PREFIX")
+    ap.add_argument("--calibrate", metavar="KERNEL", help="compare results relative to KERNEL, e.g. calibrate")
+    args = ap.parse_args()
+
+    runs = []
+    for path in args.capture:
+        try:
+            runs.append(load(path))
+        except (OSError, ValueError) as e:
+            print("bench_compare: %s: %s" % (path, e), file=sys.stderr)
+            return 2
+    run = fastest(runs)
+
+    if args.update:
+        with open(args.baseline, "w") as f:
+            json.dump(run, f, indent=1)
+            f.write("\n")
+        print("baseline: %d results written to %s" % (len(run["results"]), args.baseline))
+        return 0
+
+    base = load(args.baseline)
+    if base.get("clk_sys") != run.get("clk_sys") or base.get("sample_rate") != run.get("sample_rate"):
+        print("warning: baseline clk_sys %s / %s Hz, capture %s / %s Hz" % (
+            base.get("clk_sys"), base.get("sample_rate"), run.get("clk_sys"), run.get("sample_rate")))
+
+    now, ref = index(run, args.field, args.calibrate), index(base, args.field, args.calibrate)
+    if args.calibrate and not ref:
+        print("bench_compare: no %s results to calibrate against" % args.calibrate, file=sys.stderr)
+        return 2
+    for key in list(now.keys() | ref.keys()):
+        if key[0].startswith(tuple(args.exclude)):
+            now.pop(key, None)
+            ref.pop(key, None)
+    failed = 0
+    unit = "x " + args.calibrate if args.calibrate else "ns"
+    print("%-20s %5s %10s %10s %8s" % ("kernel", "block", "base", "now", "change"), "(%s)" % unit)
+    for key in sorted(now.keys() | ref.keys()):
+        kernel, block = key
+        if key not in ref:
+            print("%-20s %5d %10s %10.2f %8s" % (kernel, block, "-", now[key], "new"))
+            continue
+        if key not in now:
+            print("%-20s %5d %10.2f %10s %8s" % (kernel, block, ref[key], "-", "missing"))
+            failed += 1
+            continue
+        if ref[key] <= 0.0:
+            # Below the timer resolution (host builds time cold blocks in whole us)
+            print("%-20s %5d %10.2f %10.2f %8s" % (kernel, block, ref[key], now[key], "n/a"))
+            continue
+        change = now[key] / ref[key] - 1.0
+        slow = change > args.tolerance
+        failed += slow
+        print("%-20s %5d %10.2f %10.2f %+7.1f%%%s" % (kernel, block, ref[key], now[key], change * 100.0,
+                                                    "  REGRESSION" if slow else ""))
+    print("%d of %d over +%.0f %%" % (failed, len(ref), args.tolerance * 100.0))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Compare a grib_golden capture against the reference renders.
+
+    golden.py capture.txt             # compare to tools/golden/*.f32
+    golden.py capture.txt --update    # store capture as the new references
+    golden.py capture.txt --only sweep_ltfskf,voice_chain
+    grib_golden | golden.py -         # the host test (test/CMakeLists.txt)
+
+Per scenario it reports
+    max   largest absolute sample error
+    rms   RMS error relative to the reference RMS, dB
+    spec  log spectral distance (Hann window, bins within 90 dB of the peak), dB
+and fails when a scenario exceeds its tolerance (TOLERANCE below, or the
+--max/--rms/--spec overrides). Exits 1 on a failure or a missing reference, 2 on
+malformed input. Plain python, no numpy.
+"""
+import argparse
+import array
+import cmath
+import math
+import os
+import sys
+
+REFERENCE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "golden")
+
+# max abs, rms dB, spectral dB
+DEFAULT = (1e-4, -80.0, 0.5)
+TOLERANCE = {
+    # Long feedback paths amplify rounding, allow a little more
+    "delay_feedback": (1e-3, -70.0, 1.0),
+    "limiter_drive":  (1e-3, -70.0, 1.0),
+}
+
+
+def load(path):
+    scenarios = {}
+    lengths = {}
+    name = None
+    inside = False
+    with (sys.stdin if path == "-" else open(path)) as f:
+        for line in f:
+            line = line.strip()
+            if line == "GOLDEN-BEGIN":
+                inside = True
+            elif line == "GOLDEN-END":
+                break
+            elif not inside or not line:
+                continue
+            elif line.startswith("#"):
+                name, length = line[1:].split()
+                scenarios[name] = array.array("f")
+                lengths[name] = int(length)
+            else:
+                scenarios[name].extend(float(x) for x in line.split())
+    for name, samples in scenarios.items():
+        if len(samples) != lengths[name]:
+            raise ValueError("%s: %d of %d samples" % (name, len(samples), lengths[name]))
+    return scenarios
+
+
+def fft(x):
+    n = len(x)
+    if n == 1:
+        return list(x)
+    even = fft(x[0::2])
+    odd = fft(x[1::2])
+    out = [0j] * n
+    for k in range(n // 2):
+        t = cmath.exp(-2j * math.pi * k / n) * odd[k]
+        out[k] = even[k] + t
+        out[k + n // 2] = even[k] - t
+    return out
+
+
+def spectrum_db(x):
+    n = 1 << (len(x).bit_length() - 1)
+    w = [0.5 - 0.5 * math.cos(2.0 * math.pi * i / n) for i in range(n)]
+    X = fft([complex(x[i] * w[i]) for i in range(n)])
+    return [20.0 * math.log10(abs(v) + 1e-12) for v in X[:n // 2 + 1]]
+
+
+def metrics(ref, now):
+    err = [a - b for a, b in zip(now, ref)]
+    max_abs = max(abs(e) for e in err)
+    e_rms = math.sqrt(sum(e * e for e in err) / len(err))
+    r_rms = math.sqrt(sum(r * r for r in ref) / len(ref))
+    rms_db = 20.0 * math.log10(max(e_rms, 1e-12) / max(r_rms, 1e-12))
+    sr, sn = spectrum_db(ref), spectrum_db(now)
+    floor = max(sr) - 90.0
+    d = [(a - b) ** 2 for a, b in zip(sn, sr) if a > floor or b > floor]
+    spec = math.sqrt(sum(d) / len(d)) if d else 0.0
+    return max_abs, rms_db, spec
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("capture")
+    ap.add_argument("--reference", default=REFERENCE, help="directory of .f32 references")
+    ap.add_argument("--update", action="store_true", help="store the capture as references")
+    ap.add_argument("--only", help="comma separated scenarios")
+    ap.add_argument("--max", type=float, help="max abs error for every scenario")
+    ap.add_argument("--rms", type=float, help="RMS error in dB for every scenario")
+    ap.add_argument("--spec", type=float, help="spectral distance in dB for every scenario")
+    args = ap.parse_args()
+
+    try:
+        run = load(args.capture)
+    except (OSError, ValueError, KeyError, TypeError) as e:
+        print("golden: %s: %s" % (args.capture, e), file=sys.stderr)
+        return 2
+    if args.only:
+        run = {k: v for k, v in run.items() if k in args.only.split(",")}
+
+    if args.update:
+        os.makedirs(args.reference, exist_ok=True)
+        for name, samples in run.items():
+            with open(os.path.join(args.reference, name + ".f32"), "wb") as f:
+                out = array.array("f", samples)
+                if sys.byteorder != "little":
+                    out.byteswap()
+                out.tofile(f)
+        print("golden: %d references written to %s" % (len(run), args.reference))
+        return 0
+
+    failed = 0
+    print("%-16s %10s %8s %8s" % ("scenario", "max", "rms dB", "spec dB"))
+    for name, now in run.items():
+        path = os.path.join(args.reference, name + ".f32")
+        if not os.path.exists(path):
+            print("%-16s  no reference" % name)
+            failed += 1
+            continue
+        ref = array.array("f")
+        with open(path, "rb") as f:
+            ref.frombytes(f.read())
+        if sys.byteorder != "little":
+            ref.byteswap()
+        if len(ref) != len(now):
+            print("%-16s  length %d, reference %d" % (name, len(now), len(ref)))
+            failed += 1
+            continue
+        tol = list(TOLERANCE.get(name, DEFAULT))
+        for i, o in enumerate((args.max, args.rms, args.spec)):
+            if o is not None:
+                tol[i] = o
+        m = metrics(ref, now)
+        bad = m[0] > tol[0] or m[1] > tol[1] or m[2] > tol[2]
+        failed += bad
+        print("%-16s %10.3g %8.1f %8.2f%s" % (name, m[0], m[1], m[2], "  FAIL" if bad else ""))
+    print("%d of %d scenarios failed" % (failed, len(run)))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
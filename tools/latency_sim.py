@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Simulate control-to-sound latency for producer pool sizes.
+
+    latency_sim.py                              # sweep, table sorted by CPU
+    latency_sim.py --csv sweep.csv --load 0.45
+    latency_sim.py --counts 3 --sizes 1156      # one configuration
+
+Models the grib pipeline (see latency.h):
+  - the main loop renders one buffer of samples per pass into one of RENDER_BLOCKS
+    blocks, and waits for a free block before it scans the knobs; a render takes
+    load * size / rate (plus jitter)
+  - i2s_callback_func copies every rendered block into a producer buffer once, when
+    a buffer is free: block m is copied as buffer m - depth is taken
+  - a buffer filled at IRQ k is taken count - in_flight IRQs later; with chained DMA
+    two buffers are in flight and the taken one plays one period after the take
+Block m is rendered once block m - RENDER_BLOCKS has been copied, so a knob change
+is first heard in the block whose render starts at the first free block after it.
+Changes land at random times, so the result is a distribution over the phase
+between the change and the buffer clock.
+
+CPU is the audio overhead outside the render: a fixed cost per IRQ plus a cost per
+frame (conversion, master bus); small buffers pay the fixed cost more often. The
+defaults are estimates for clk_sys = 96 MHz; measure with grib_bench or a trace
+and pass --irq-us / --frame-us for real numbers.
+"""
+import argparse
+import math
+import random
+import sys
+
+
+def simulate(count, size, args, rng):
+    in_flight = 2 if args.dma == "chained" else 1
+    depth = count - in_flight
+    period = size / args.rate
+    render = args.load * period
+    phase = rng.random() * period
+    dma, audible = [], []
+    for _ in range(args.changes):
+        t = rng.random() * args.seconds
+        # The loop waits for the copy at IRQ j, scans, renders; late if the render overruns
+        j = math.ceil((t - phase) / period)
+        done = args.scan_us * 1e-6 + render * (1.0 + rng.uniform(-args.jitter, args.jitter))
+        late = max(0, math.ceil(done / period) - args.blocks)
+        take = phase + (j + args.blocks + late + depth) * period
+        dma.append(take - t)
+        audible.append(take - t + (period if args.dma == "chained" else 0.0))
+    cpu = (args.rate / size * args.irq_us + args.rate * args.frame_us) * 1e-6
+    return period, cpu, sorted(dma), sorted(audible)
+
+
+def pct(values, p):
+    return values[min(len(values) - 1, int(p * len(values)))] * 1000.0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--counts", default="3,4,5,6", help="buffer_count values (audio_new_producer_pool)")
+    ap.add_argument("--sizes", default="128,256,512,1156,2048", help="buffer_sample_count values")
+    ap.add_argument("--rate", type=float, default=44100.0)
+    ap.add_argument("--blocks", type=int, default=2, help="renders ahead of the buffers (RENDER_BLOCKS)")
+    ap.add_argument("--load", type=float, default=0.3, help="render time / real time")
+    ap.add_argument("--jitter", type=float, default=0.1, help="render time jitter, fraction of the render")
+    ap.add_argument("--scan-us", type=float, default=40.0, help="knob scan and loop overhead")
+    ap.add_argument("--irq-us", type=float, default=15.0, help="fixed cost per DMA IRQ")
+    ap.add_argument("--frame-us", type=float, default=0.35, help="cost per stereo frame in the IRQ")
+    ap.add_argument("--dma", choices=("chained", "single"), default="chained")
+    ap.add_argument("--changes", type=int, default=4000)
+    ap.add_argument("--seconds", type=float, default=60.0)
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--csv", help="write the sweep as CSV")
+    args = ap.parse_args()
+
+    rng = random.Random(args.seed)
+    rows = []
+    for count in (int(c) for c in args.counts.split(",")):
+        if count - (2 if args.dma == "chained" else 1) < 1:
+            print("count %d: no buffer left to prepare with %s DMA, skipped" % (count, args.dma), file=sys.stderr)
+            continue
+        for size in (int(s) for s in args.sizes.split(",")):
+            period, cpu, dma, audible = simulate(count, size, args, rng)
+            rows.append((count, size, period * 1000.0, cpu * 100.0,
+                         pct(dma, 0.0), pct(dma, 0.5), pct(dma, 0.95), pct(dma, 1.0),
+                         pct(audible, 0.5), pct(audible, 0.95)))
+    rows.sort(key=lambda r: (r[3], r[6]))
+
+    head = ("count", "size", "period_ms", "cpu_pct", "dma_min_ms", "dma_p50_ms", "dma_p95_ms", "dma_max_ms",
+            "audible_p50_ms", "audible_p95_ms")
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write(",".join(head) + "\n")
+            for r in rows:
+                f.write("%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n" % r)
+    print("%5s %5s %8s %6s   %s" % ("count", "size", "period", "cpu", "to DMA min / p50 / p95 / max, heard p95 (ms)"))
+    for r in rows:
+        print("%5d %5d %6.2fms %5.2f%%   %6.1f %6.1f %6.1f %6.1f   %6.1f" % (r[:8] + (r[9],)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry stream of grib (telemetry/telemetry.h).
+
+    telemetry.py /dev/ttyACM0              # live, needs pyserial
+    telemetry.py capture.bin               # file written by telemetry_file_write
+    telemetry.py capture.bin --csv out.csv
+
+Frames are 'G' 'R' <16 byte record> <sum of record bytes mod 256>; anything else
+on the port (stdio text) is skipped. Text output shows one record per line;
+CSV has the columns time_us,seq,type,tag,a,b,c,d. Latency records are summed up
+as percentiles at the end (Ctrl-C on a live port).
+"""
+import argparse
+import csv
+import os
+import struct
+import sys
+
+SYNC = b"GR"
+RECORD = struct.Struct("<IBBH8s")
+FRAME = len(SYNC) + RECORD.size + 1
+
+LOAD, UNDERRUN, PARAM, SCOPE, DROPPED, LATENCY, XIP, DISPLAY = 1, 2, 3, 4, 5, 6, 7, 8
+SOURCES = {0: "main", 1: "irq", 2: "core1"}
+PARAMS = {0: "freq", 1: "pw", 2: "cutoff", 3: "Q", 4: "amp"}
+
+
+def frames(stream):
+    """Yield the 16 byte record of every valid frame in a byte stream."""
+    buf = b""
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                buf = buf[-1:]
+                break
+            if len(buf) - i < FRAME:
+                buf = buf[i:]
+                break
+            body = buf[i + 2:i + 2 + RECORD.size]
+            if sum(body) & 0xFF == buf[i + FRAME - 1]:
+                yield body
+                buf = buf[i + FRAME:]
+            else:
+                buf = buf[i + 1:]
+
+
+def decode(body):
+    time_us, kind, tag, seq, data = RECORD.unpack(body)
+    if kind == LOAD:
+        values = struct.unpack("<f", data[:4])
+        name, text = "load", "%.1f %%" % (values[0] * 100.0)
+    elif kind == UNDERRUN:
+        values = struct.unpack("<ii", data)
+        name, text = "underrun", "%d total, last %d us" % values
+    elif kind == PARAM:
+        values = struct.unpack("<f", data[:4])
+        name, text = "param", "%s = %g" % (PARAMS.get(tag, str(tag)), values[0])
+    elif kind == SCOPE:
+        values = struct.unpack("<4h", data)
+        name, text = "scope", "ch%d %6d %6d %6d %6d" % ((tag,) + values)
+    elif kind == DROPPED:
+        values = struct.unpack("<ii", data)[:1]
+        name, text = "dropped", "%d records on %s" % (values[0], SOURCES.get(tag, str(tag)))
+    elif kind == LATENCY:
+        values = struct.unpack("<ii", data)
+        name, text = "latency", "%.2f ms, buffer copy after %.2f ms" % (values[1] / 1000.0, values[0] / 1000.0)
+    elif kind == XIP:
+        values = struct.unpack("<II", data)
+        hits = values[0] - values[1]
+        name, text = "xip", "%d accesses, %d misses (%.1f %% hit)" % (values[0], values[1],
+                                                                      100.0 * hits / values[0] if values[0] else 100.0)
+    elif kind == DISPLAY:
+        values = struct.unpack("<ii", data)
+        name, text = "display", "redraw %d us, %d passes skipped" % values
+    else:
+        values = struct.unpack("<ii", data)
+        name, text = "type%d" % kind, "%08x %08x" % (values[0] & 0xFFFFFFFF, values[1] & 0xFFFFFFFF)
+    return time_us, seq, name, tag, values, text
+
+
+def open_input(path, baud):
+    if os.path.isfile(path):
+        return open(path, "rb")
+    try:
+        import serial
+    except ImportError:
+        sys.exit("telemetry: %s is not a file and pyserial is not installed" % path)
+    port = serial.Serial(path, baud, timeout=1.0)
+
+    class Port:
+        def read(self, n):
+            # keep waiting on a live port, an empty read is only a timeout
+            while True:
+                data = port.read(n)
+                if data:
+                    return data
+    return Port()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("input", help="capture file or serial port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--csv", help="write records as CSV to this file instead of printing")
+    ap.add_argument("--type", help="comma separated record types to keep, e.g. load,underrun")
+    args = ap.parse_args()
+
+    keep = set(args.type.split(",")) if args.type else None
+    writer = None
+    if args.csv:
+        out = open(args.csv, "w", newline="")
+        writer = csv.writer(out)
+        writer.writerow(["time_us", "seq", "type", "tag", "a", "b", "c", "d"])
+    count = 0
+    latencies = []
+    try:
+        for body in frames(open_input(args.input, args.baud)):
+            time_us, seq, name, tag, values, text = decode(body)
+            if keep and name not in keep:
+                continue
+            count += 1
+            if name == "latency":
+                latencies.append(values[1])
+            if writer:
+                writer.writerow([time_us, seq, name, tag] + list(values) + [""] * (4 - len(values)))
+            else:
+                print("%10d %5d %-8s %s" % (time_us, seq, name, text))
+    except KeyboardInterrupt:
+        pass
+    if writer:
+        out.close()
+        print("telemetry: %d records written to %s" % (count, args.csv))
+    if latencies:
+        latencies.sort()
+        pick = lambda p: latencies[min(len(latencies) - 1, int(p * len(latencies)))] / 1000.0
+        print("latency: %d probes, min %.2f ms, p50 %.2f ms, p95 %.2f ms, max %.2f ms" % (
+            len(latencies), pick(0.0), pick(0.5), pick(0.95), pick(1.0)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
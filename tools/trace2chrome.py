@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Convert a grib trace dump (trace/include/trace.h) to Chrome trace JSON.
+
+    trace2chrome.py console.log trace.json
+
+The input is a console capture containing TRACE-BEGIN ... TRACE-END (the last
+dump in the file is used); open the output in chrome://tracing or
+ui.perfetto.dev. Each ring becomes a thread: core 0 / core 1 on the board,
+threads on the host. Timestamps wrap every 2^32 us and are unwrapped per ring.
+"""
+import argparse
+import json
+import sys
+
+PHASE = {"B": "B", "E": "E", "I": "i", "C": "C"}
+
+
+def load(path):
+    dumps, current = [], None
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if line == "TRACE-BEGIN":
+                current = []
+            elif line == "TRACE-END":
+                if current is not None:
+                    dumps.append(current)
+                current = None
+            elif current is not None and line:
+                ring, time_us, kind, value, name = line.split(" ", 4)
+                current.append((int(ring), int(time_us), kind, int(value), name))
+    if not dumps:
+        raise ValueError("no TRACE-BEGIN ... TRACE-END block")
+    return dumps[-1]
+
+
+def convert(events, host):
+    out, last, offset = [], {}, {}
+    for ring, time_us, kind, value, name in events:
+        if ring in last and time_us < last[ring]:
+            offset[ring] = offset.get(ring, 0) + (1 << 32)
+        last[ring] = time_us
+        ts = time_us + offset.get(ring, 0)
+        e = {"name": name, "ph": PHASE[kind], "ts": ts, "pid": 0, "tid": ring}
+        if kind == "C":
+            e["args"] = {"value": value}
+        elif kind == "I":
+            e["s"] = "t"
+        out.append(e)
+    out.sort(key=lambda e: e["ts"])
+    label = "thread %d" if host else "core %d"
+    for ring in sorted(last):
+        out.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": ring, "args": {"name": label % ring}})
+    out.append({"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "grib"}})
+    return {"traceEvents": out, "displayTimeUnit": "ms"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("dump")
+    ap.add_argument("output")
+    ap.add_argument("--host", action="store_true", help="label rings as threads instead of cores")
+    args = ap.parse_args()
+    try:
+        events = load(args.dump)
+    except (OSError, ValueError) as e:
+        print("trace2chrome: %s: %s" % (args.dump, e), file=sys.stderr)
+        return 2
+    with open(args.output, "w") as f:
+        json.dump(convert(events, args.host), f, indent=0)
+    print("trace2chrome: %d events written to %s" % (len(events), args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
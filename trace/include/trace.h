@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdint.h>
+
+#include "pico.h"
+
+/** \file trace.h
+ *  \defgroup grib_trace grib_trace
+ *  Timestamped trace points on both cores, dumped as text on request
+ *
+ *     TRACE_BEGIN("render");
+ *     voice_render(...);
+ *     TRACE_END("render");
+ *     TRACE_COUNTER("load", percent);
+ *
+ * With GRIB_TRACE 0 (the default) the macros expand to nothing and the arguments are not
+ * evaluated. With GRIB_TRACE 1 every event is a 32-bit microsecond timestamp, a kind, a
+ * name and a value, written to a ring per core. Interrupts are masked for the few
+ * cycles of the store, so trace points may sit in IRQ handlers. The rings overwrite
+ * their oldest events: they always hold the latest TRACE_LENGTH events per core.
+ *
+ * Names must be string literals (or otherwise outlive the dump); only the pointer is
+ * stored.
+ *
+ * Host builds keep a ring per thread (up to TRACE_RINGS threads) instead of per core,
+ * so the same trace points show how host threads interleave.
+ *
+ * trace_dump prints the rings between TRACE-BEGIN and TRACE-END lines, one event per
+ * line as "<core> <time_us> <B|E|I|C> <value> <name>"; tools/trace2chrome.py turns
+ * that into Chrome trace JSON for chrome://tracing or ui.perfetto.dev.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Trace points compiled in
+#ifndef GRIB_TRACE
+#define GRIB_TRACE 0
+#endif
+
+// Events per ring, power of two
+#ifndef TRACE_LENGTH
+#define TRACE_LENGTH 512
+#endif
+
+// Rings: cores on the device, threads on the host
+#ifndef TRACE_RINGS
+#if PICO_ON_DEVICE
+#define TRACE_RINGS 2
+#else
+#define TRACE_RINGS 8
+#endif
+#endif
+
+typedef enum trace_kind {
+    TRACE_KIND_BEGIN = 'B',
+    TRACE_KIND_END = 'E',
+    TRACE_KIND_INSTANT = 'I',
+    TRACE_KIND_COUNTER = 'C',
+} trace_kind_t;
+
+/** \brief Record one event on the ring of the calling core (thread on the host)
+ * \ingroup grib_trace
+ */
+void trace_event(trace_kind_t kind, const char *name, int32_t value);
+
+/** \brief Print all rings, oldest event first per ring; recording pauses meanwhile
+ * \ingroup grib_trace
+ */
+void trace_dump(void);
+
+/** \brief Drop all recorded events
+ * \ingroup grib_trace
+ */
+void trace_clear(void);
+
+#if GRIB_TRACE
+#define TRACE_BEGIN(name)          trace_event(TRACE_KIND_BEGIN, name, 0)
+#define TRACE_END(name)            trace_event(TRACE_KIND_END, name, 0)
+#define TRACE_INSTANT(name)        trace_event(TRACE_KIND_INSTANT, name, 0)
+#define TRACE_COUNTER(name, value) trace_event(TRACE_KIND_COUNTER, name, (int32_t) (value))
+#else
+#define TRACE_BEGIN(name)          ((void) 0)
+#define TRACE_END(name)            ((void) 0)
+#define TRACE_INSTANT(name)        ((void) 0)
+#define TRACE_COUNTER(name, value) ((void) 0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_TRACE_H
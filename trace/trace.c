@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ * Copyright (c) 2022 unmanned
+ */
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "trace.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/sync.h"
+#endif
+
+#if GRIB_TRACE
+
+static_assert(!(TRACE_LENGTH & (TRACE_LENGTH - 1)), "TRACE_LENGTH must be a power of two");
+
+typedef struct trace_entry {
+    uint32_t time_us;
+    int32_t value;
+    const char *name;
+    uint8_t kind;
+} trace_entry_t;
+
+typedef struct trace_ring {
+    trace_entry_t events[TRACE_LENGTH];
+    uint32_t head;
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_RINGS];
+static volatile bool trace_paused;
+
+#if PICO_ON_DEVICE
+static inline trace_ring_t *trace_ring(void) {
+    return &rings[get_core_num()];
+}
+#else
+static _Thread_local int thread_index = -1;
+static int thread_count;
+
+// threads beyond TRACE_RINGS are not traced
+static trace_ring_t *trace_ring(void) {
+    if (thread_index < 0) {
+        thread_index = __atomic_fetch_add(&thread_count, 1, __ATOMIC_RELAXED);
+    }
+    return thread_index < TRACE_RINGS ? &rings[thread_index] : NULL;
+}
+#endif
+
+// called from the DMA IRQ, so it runs from RAM like the handler
+void __not_in_flash_func(trace_event)(trace_kind_t kind, const char *name, int32_t value) {
+    if (trace_paused) return;
+    trace_ring_t *ring = trace_ring();
+#if PICO_ON_DEVICE
+    // an IRQ on this core may trace too
+    uint32_t save = save_and_disable_interrupts();
+#else
+    if (!ring) return;
+#endif
+    trace_entry_t *e = &ring->events[ring->head++ & (TRACE_LENGTH - 1)];
+    e->time_us = time_us_32();
+    e->value = value;
+    e->name = name;
+    e->kind = (uint8_t) kind;
+#if PICO_ON_DEVICE
+    restore_interrupts(save);
+#endif
+}
+
+void trace_dump(void) {
+    trace_paused = true;
+    printf("TRACE-BEGIN\n");
+    for (uint r = 0; r < TRACE_RINGS; r++) {
+        trace_ring_t *ring = &rings[r];
+        uint32_t head = ring->head;
+        uint32_t count = head < TRACE_LENGTH ? head : TRACE_LENGTH;
+        for (uint32_t i = head - count; i != head; i++) {
+            const trace_entry_t *e = &ring->events[i & (TRACE_LENGTH - 1)];
+            printf("%u %lu %c %ld %s\n", r, (unsigned long) e->time_us, e->kind, (long) e->value, e->name);
+        }
+    }
+    printf("TRACE-END\n");
+    trace_paused = false;
+}
+
+void trace_clear(void) {
+    trace_paused = true;
+    for (uint r = 0; r < TRACE_RINGS; r++) {
+        rings[r].head = 0;
+    }
+    trace_paused = false;
+}
+
+#else
+
+void trace_event(trace_kind_t kind, const char *name, int32_t value) {
+    (void) kind;
+    (void) name;
+    (void) value;
+}
+
+void trace_dump(void) {
+    printf("TRACE-BEGIN\nTRACE-END\n");
+}
+
+void trace_clear(void) {
+}
+
+#endif // GRIB_TRACE
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+#include "voice.h"
+#include "cell/utility.h"
+#include "cell/oscillator.h"
+#include "cell/chain.h"
+#include "cell/graph.h"
+#include "cell/tables.h"
+#include "cell/envelope.h"
+#include "cell/guard.h"
+
+#define VOICE_FORM oSquare // form[3]
+
+static oscillator osc;
+static ltfskf     lpf;
+static limiter    lim;
+static dcblock    dc;
+static adsr       env;        // Amp envelope, gated by voice_render_events
+static graph      patch_graph;
+static bool       patch_loaded;
+
+using voice_chain = cell::chain<
+    cell::source<VOICE_FORM>,
+    cell::gain,
+    cell::ltfskf_stage,
+    cell::limiter_stage,
+    cell::dcblock_stage,
+    cell::gain>;
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+void voice_init(void)
+{
+    oscillator_init(&osc);
+    ltfskf_clr(&lpf);
+    limiter_init(&lim, 0.5f, 3.0f, .5f);
+    dcblock_clr(&dc);
+    adsr_init(&env);
+    adsr_set(&env, 5.0f, 0.0f, 150.0f, 0.6f, 120.0f);
+    graph_init(&patch_graph);
+    patch_loaded = false;
+}
+
+static float voice_freq(const voice_params* p)
+{
+    return p->note == 0.0f ? p->freq : p->freq * table_exp2f(p->note * (1.0f / 12.0f));
+}
+
+static void voice_update(const voice_params* p)
+{
+    osc.eax = PI;
+    osc.amplitude = 1.0f;
+    osc.pwm = (p->pw - 0.5f) * TAO;
+    set_delta(&osc, voice_freq(p));
+    ltfskf_init(&lpf, p->cutoff, p->Q);
+}
+
+static void voice_render_patch(const voice_params* p, float* out, unsigned n)
+{
+    float ctl[PATCH_CTLS];
+    ctl[PATCH_CTL_FREQ]   = voice_freq(p);
+    ctl[PATCH_CTL_PW]     = p->pw;
+    ctl[PATCH_CTL_CUTOFF] = p->cutoff;
+    ctl[PATCH_CTL_Q]      = p->Q;
+    ctl[PATCH_CTL_AMP]    = p->amp;
+    graph_process(&patch_graph, ctl, out, n);
+}
+
+void CELL_HOT(voice_render)(const voice_params* p, float* out, unsigned n)
+{
+    if (patch_loaded)
+    {
+        voice_render_patch(p, out, n);
+        return;
+    }
+    voice_update(p);
+    voice_chain ch(
+        cell::source<VOICE_FORM>(&osc),
+        cell::gain(0.5f),
+        cell::ltfskf_stage(&lpf),
+        cell::limiter_stage(&lim),
+        cell::dcblock_stage(&dc),
+        cell::gain(p->amp));
+    ch.render(out, n);
+    // Flush the decaying state, silence the block if the filter blew up (cell/guard.h)
+    bool reset = guard_ltfskf(&lpf);
+    reset |= guard_limiter(&lim);
+    reset |= guard_dcblock(&dc);
+    if (reset) memset(out, 0, n * sizeof(float));
+}
+
+static void voice_event(voice_params* p, const sched_event* e)
+{
+    if (e->type != SCHED_PARAM && e->target != VOICE_TRACK) return;
+    switch (e->type)
+    {
+        case SCHED_GATE:
+            // Every gate on starts a note; ties are steps without a gate event
+            p->gate = e->value;
+            if (e->value != 0.0f) adsr_trigger(&env);
+            else                  adsr_gate(&env, false);
+            break;
+        case SCHED_NOTE: p->note = e->value; break;
+        case SCHED_PARAM:
+            switch (e->target)
+            {
+                case PATCH_CTL_FREQ:   p->freq   = e->value; break;
+                case PATCH_CTL_PW:     p->pw     = e->value; break;
+                case PATCH_CTL_CUTOFF: p->cutoff = e->value; break;
+                case PATCH_CTL_Q:      p->Q      = e->value; break;
+                case PATCH_CTL_AMP:    p->amp    = e->value; break;
+                default: break;
+            }
+            break;
+        default: break;
+    }
+}
+
+void CELL_HOT(voice_render_events)(voice_params* p, scheduler* s, float* out, unsigned n)
+{
+    while (n)
+    {
+        sched_event e;
+        while (sched_pop(s, &e)) voice_event(p, &e);
+        unsigned m = sched_span(s, n);
+        voice_render(p, out, m);
+        adsr_apply(&env, out, m);
+        sched_advance(s, m);
+        out += m;
+        n   -= m;
+    }
+}
+
+void voice_render_reference(const voice_params* p, float* out, unsigned n)
+{
+    voice_update(p);
+    for (unsigned i = 0; i < n; i++)
+    {
+        VOICE_FORM(&osc);
+        float x = osc.out*0.5f;
+        x = ltfskf_process(&lpf, x);
+        x = limit(&lim, x);
+        x = dcblock_process(&dc, x) * p->amp;
+        out[i] = x;
+    }
+}
+
+int voice_load_patch(const patch* p)
+{
+    int r = graph_load(&patch_graph, p);
+    if (r == GRAPH_OK) patch_loaded = true;
+    return r;
+}
+
+void voice_unload_patch(void)
+{
+    patch_loaded = false;
+    graph_clr(&patch_graph);
+}
@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////////
+// Voice: osc -> filter -> limiter -> DC block -> amp, rendered as one fused block
+////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include "cell/patch.h"
+#include "cell/scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VOICE_TRACK 0  // Target of the SCHED_GATE / SCHED_NOTE events the voice plays
+
+typedef struct
+{
+    float freq;   // Hz
+    float pw;     // 0 < 1
+    float cutoff; // Hz
+    float Q;
+    float amp;
+    float note;   // Semitones added to freq, set by SCHED_NOTE
+    float gate;   // Amp envelope gate, set by SCHED_GATE
+
+} voice_params;
+
+void voice_init(void);
+
+// Fused chain (cell/chain.h); state stays in locals for the whole block.
+// Output is float, full scale +-1 (audio_f32_to_s32_stereo converts it for the DAC)
+void voice_render(const voice_params* p, float* out, unsigned n);
+
+// voice_render split at the events due in the next n samples of s, through the amp
+// envelope (cell/envelope.h). Every event updates p on its sample (SCHED_PARAM: the
+// patch_ctl field); a gate on starts the envelope, a gate off releases it. Gates and
+// notes for other targets (pattern tracks, cell/pattern.h) are ignored.
+// Advances s->now by n.
+void voice_render_events(voice_params* p, scheduler* s, float* out, unsigned n);
+
+// Same chain through the per-sample C API, kept as reference
+void voice_render_reference(const voice_params* p, float* out, unsigned n);
+
+// Replace the fixed chain by a patch graph (cell/graph.h); returns GRAPH_OK or
+// a negative GRAPH_E* code, in which case the previous patch keeps running
+int  voice_load_patch(const patch* p);
+void voice_unload_patch(void);
+
+#ifdef __cplusplus
+}
+#endif
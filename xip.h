@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////////
+// XIP cache counters
+////////////////////////////////////////////////////////////////////////////////////
+// The XIP_CTRL counters see every cached flash access from both cores and the DMA,
+// so a window around a render also counts whatever core 1 and the IRQs fetched.
+// Host builds have no XIP and read zeros.
+////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stdint.h>
+#include "pico.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/structs/xip_ctrl.h"
+#endif
+
+typedef struct
+{
+    uint32_t accesses;  // Cacheable flash reads
+    uint32_t misses;    // Of those, went to QSPI
+
+} xip_counters;
+
+static inline void xip_counters_clear(void)
+{
+#if PICO_ON_DEVICE
+    xip_ctrl_hw->ctr_hit = 0;
+    xip_ctrl_hw->ctr_acc = 0;
+#endif
+}
+
+static inline xip_counters xip_counters_read(void)
+{
+    xip_counters c = { 0, 0 };
+#if PICO_ON_DEVICE
+    uint32_t hit = xip_ctrl_hw->ctr_hit;
+    c.accesses = xip_ctrl_hw->ctr_acc;
+    c.misses = c.accesses - hit;
+#endif
+    return c;
+}
+
+// Empty the cache; the read stalls until the flush is done
+static inline void xip_cache_flush(void)
+{
+#if PICO_ON_DEVICE
+    xip_ctrl_hw->flush = 1;
+    (void)xip_ctrl_hw->flush;
+#endif
+}